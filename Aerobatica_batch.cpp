@@ -0,0 +1,281 @@
+/******************************************************************************
+*        Title: Aerobatica
+* Date Started: April 10th, 2009
+*    Developer: Liam Hagerty
+*       Module: Batch Environment Code Module
+*  Description: This module contains the routines that create, reset and
+*                 step a batch of worlds and fill in what each bot observes
+*      Version: 1.0
+******************************************************************************/
+#pragma region Includes
+#include <stdlib.h>
+#include <string.h>
+#include "Aerobatica_batch.h"    //Batch Environment Definitions Header
+#include "Aerobatica_profiler.h" //Phase timings
+#pragma endregion
+
+#pragma region Function Prototypes
+static void Step_Worlds_Job(void*, int, int);
+static void Step_World(BATCHENV*, int);
+static void Observe(BATCHENV*, int);
+static int Keep_Nearest(long long*, int (*)[2], int, int, int);
+static unsigned long Round_Seed(const BATCHENV*, int);
+#pragma endregion
+
+bool Batch_Create(BATCHENV* batch, int count, JOBSYSTEM* jobs)
+{
+	/**************************************************************************
+	*  PreCondition: count is positive, jobs is running and owned by the
+	*                  thread that will step the batch, or NULL
+	* PostCondition: The batch's worlds and result arrays will be allocated
+	*                  and reset from seed 0, returns false (with nothing
+	*                  left allocated) if there isn't the memory
+	*   Description: Sets up a batch of count worlds
+	*     Algorithm: Allocate the worlds in one block and each result array
+	*                Reset() the batch
+	**************************************************************************/
+	memset(batch, 0, sizeof(BATCHENV));
+	batch->count = count;
+	batch->jobs = jobs;
+	batch->worlds = (SIMULATION*)malloc(count * sizeof(SIMULATION));
+	batch->observations = (float*)malloc(count * BATCH_OBSERVATION_SIZE * sizeof(float));
+	batch->rewards = (float*)malloc(count * sizeof(float));
+	batch->dones = (unsigned char*)malloc(count);
+	batch->rounds = (unsigned long*)malloc(count * sizeof(unsigned long));
+
+	if(batch->worlds == NULL || batch->observations == NULL || batch->rewards == NULL ||
+		batch->dones == NULL || batch->rounds == NULL)
+	{
+		Batch_Destroy(batch);
+		return false;
+	}
+
+	Batch_Reset(batch, 0);
+	return true;
+}
+
+void Batch_Destroy(BATCHENV* batch)
+{
+	/**************************************************************************
+	*  PreCondition: Batch_Create has run on the batch
+	* PostCondition: Everything the batch allocated will be freed
+	*   Description: Tears a batch down
+	*     Algorithm: Free the worlds and the result arrays
+	**************************************************************************/
+	free(batch->worlds);
+	free(batch->observations);
+	free(batch->rewards);
+	free(batch->dones);
+	free(batch->rounds);
+	memset(batch, 0, sizeof(BATCHENV));
+}
+
+void Batch_Reset(BATCHENV* batch, unsigned long seed)
+{
+	/**************************************************************************
+	*  PreCondition: Batch_Create has run on the batch
+	* PostCondition: Every world will be at the start of a fresh round and
+	*                  its first observation filled in
+	*   Description: Starts a batch over, the same seed always gives the
+	*                  same rounds
+	*     Algorithm: For each world,
+	*                  Clear its round count and results
+	*                  Start it from its Round_Seed()
+	*                  Observe() it
+	**************************************************************************/
+	int world;
+
+	batch->seed = seed;
+	for(world = 0; world < batch->count; world++)
+	{
+		batch->rounds[world] = 0;
+		batch->rewards[world] = 0.0f;
+		batch->dones[world] = 0;
+		Sim_Init(&batch->worlds[world], Round_Seed(batch, world));
+		Observe(batch, world);
+	}
+}
+
+void Batch_Step(BATCHENV* batch, const SIM_INPUT* actions)
+{
+	/**************************************************************************
+	*  PreCondition: Batch_Create has run on the batch, actions holds a
+	*                  control byte per world
+	* PostCondition: Every world will be a tick further along, with its
+	*                  observation, reward and done flag filled in
+	*   Description: Steps the whole batch. Each world is stepped by one
+	*                  thread alone, so the result is the same however many
+	*                  there are
+	*     Algorithm: Without a job system, step each world in turn
+	*                Otherwise cut the worlds into chunks as jobs, run them
+	*                  and wait for them all
+	**************************************************************************/
+	PROFILE_SCOPE("Batch_Step");
+	JOB* step;
+
+	batch->actions = actions;
+	if(batch->jobs == NULL)
+	{
+		Step_Worlds_Job(batch, 0, batch->count);
+		return;
+	}
+
+	step = Job_Create(batch->jobs, Step_Worlds_Job, batch, 0, batch->count, BATCH_WORLD_CHUNK);
+	Job_Submit(batch->jobs, step);
+	Job_Wait(batch->jobs, step);
+	Jobs_Reset(batch->jobs);
+}
+
+static void Step_Worlds_Job(void* data, int begin, int end)
+{
+	/**************************************************************************
+	*  PreCondition: Queued by Batch_Step, data is the batch
+	* PostCondition: Worlds begin to end - 1 will have been stepped
+	*   Description: Job body for stepping a run of worlds
+	*     Algorithm: Step_World() each of them
+	**************************************************************************/
+	BATCHENV* batch = (BATCHENV*)data;
+	int world;
+
+	for(world = begin; world < end; world++)
+		Step_World(batch, world);
+}
+
+static void Step_World(BATCHENV* batch, int index)
+{
+	/**************************************************************************
+	*  PreCondition: batch->actions has been set for this step
+	* PostCondition: The world will be a tick further along (or restarted if
+	*                  its round ended) and its results filled in
+	*   Description: One world's share of a batch step
+	*     Algorithm: Tick it on this thread with its action
+	*                Reward each plane it shot down, and the round's end
+	*                If the round ended, count it and start the next one
+	*                Observe() it
+	**************************************************************************/
+	SIMULATION* world = &batch->worlds[index];
+	unsigned long kills = world->kills;
+	float reward;
+
+	//(the job system belongs to the thread stepping the batch)
+	Sim_Tick_Jobs(world, batch->actions[index], NULL);
+
+	reward = (float)(world->kills - kills) * BATCH_REWARD_KILL;
+	if(world->status == SIM_VICTORY)
+		reward += BATCH_REWARD_VICTORY;
+	else if(world->status == SIM_DEFEAT)
+		reward += BATCH_REWARD_DEFEAT;
+	batch->rewards[index] = reward;
+	batch->dones[index] = world->status != SIM_PLAYING;
+
+	if(batch->dones[index])
+	{
+		batch->rounds[index]++;
+		Sim_Init(world, Round_Seed(batch, index));
+	}
+
+	Observe(batch, index);
+}
+
+static void Observe(BATCHENV* batch, int index)
+{
+	/**************************************************************************
+	*  PreCondition: The world has been initialized
+	* PostCondition: The world's row of observations will be filled in
+	*   Description: What a bot sees, every value scaled to about -1 to 1 by
+	*                  the size of the playfield
+	*     Algorithm: Write where the player is and how long until it can fire
+	*                Keep the BATCH_NEAREST enemy planes in play closest to
+	*                  the player, then the BATCH_NEAREST hazardous shots
+	*                Write each one's offset from the player, nearest first,
+	*                  and zeroes for any that aren't there
+	**************************************************************************/
+	const SIMULATION* world = &batch->worlds[index];
+	const ENTITYSTORE* store = &world->entities;
+	const PROJECTILEPOOL* pool = &world->projectiles;
+	float* row = batch->observations + (size_t)index * BATCH_OBSERVATION_SIZE;
+	long long distances[2][BATCH_NEAREST];
+	int offsets[2][BATCH_NEAREST][2];
+	uint64_t enemies[ENTITY_FLAG_WORDS];
+	int found[2] = { 0, 0 }, playerX, playerY, entity, slot, kind, contact;
+
+	//the player
+	Player_Middle(world, &playerX, &playerY);
+	row[0] = (float)playerX / PLAYFIELD_WIDTH;
+	row[1] = (float)playerY / PLAYFIELD_HEIGHT;
+	row[2] = (float)world->fireCooldown / PLAYER_FIRE_COOLDOWN;
+	row += BATCH_PLAYER_VALUES;
+
+	//the closest planes
+	Entity_In_Play(store, TYPE_ENEMY, enemies);
+	for(entity = 0; entity < store->count; entity++)
+		if(Entity_Flag(enemies, entity))
+			found[0] = Keep_Nearest(distances[0], offsets[0], found[0],
+				store->xCoordinate[entity] + store->width[entity] / 2 - playerX,
+				store->yCoordinate[entity] + store->height[entity] / 2 - playerY);
+
+	//and shots
+	for(slot = 0; slot < pool->count; slot++)
+		if(entityTypeFlags[pool->type[slot]] & TYPE_HAZARD)
+			found[1] = Keep_Nearest(distances[1], offsets[1], found[1],
+				pool->xCoordinate[slot] + pool->width[slot] / 2 - playerX,
+				pool->yCoordinate[slot] + pool->height[slot] / 2 - playerY);
+
+	//where they are from the player
+	for(kind = 0; kind < 2; kind++)
+		for(contact = 0; contact < BATCH_NEAREST; contact++, row += BATCH_CONTACT_VALUES)
+		{
+			bool present = contact < found[kind];
+
+			row[0] = present ? (float)offsets[kind][contact][0] / PLAYFIELD_WIDTH : 0.0f;
+			row[1] = present ? (float)offsets[kind][contact][1] / PLAYFIELD_HEIGHT : 0.0f;
+			row[2] = present ? 1.0f : 0.0f;
+		}
+}
+
+static int Keep_Nearest(long long* distances, int (*offsets)[2], int found, int x, int y)
+{
+	/**************************************************************************
+	*  PreCondition: distances and offsets hold found entries, closest first
+	* PostCondition: The offset will be among them if it is one of the
+	*                  BATCH_NEAREST closest so far, the farthest dropped if
+	*                  there wasn't room. The new number of entries is
+	*                  returned
+	*   Description: Insertion step of a short sorted list. Contacts come in
+	*                  row order, so a tie keeps the lower row first
+	*     Algorithm: Start from the end of the list, or the last place if it
+	*                  is full and the contact is no closer than it
+	*                Shift farther entries down until its place is found
+	**************************************************************************/
+	long long distance = (long long)x * x + (long long)y * y;
+	int place = found < BATCH_NEAREST ? found : BATCH_NEAREST - 1;
+
+	if(found == BATCH_NEAREST && distance >= distances[place])
+		return found;
+
+	for(; place > 0 && distances[place - 1] > distance; place--)
+	{
+		distances[place] = distances[place - 1];
+		offsets[place][0] = offsets[place - 1][0];
+		offsets[place][1] = offsets[place - 1][1];
+	}
+	distances[place] = distance;
+	offsets[place][0] = x;
+	offsets[place][1] = y;
+
+	return found < BATCH_NEAREST ? found + 1 : found;
+}
+
+static unsigned long Round_Seed(const BATCHENV* batch, int index)
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: The seed of the world's next round will be returned
+	*   Description: Gives every round of every world its own seed, which
+	*                  depends only on the batch's seed, so rounds don't
+	*                  depend on how the worlds were spread over threads
+	*     Algorithm: Number the rounds world by world within each pass of
+	*                  the batch and add that to the batch's seed
+	**************************************************************************/
+	return batch->seed + batch->rounds[index] * (unsigned long)batch->count + (unsigned long)index;
+}
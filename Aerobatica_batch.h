@@ -0,0 +1,63 @@
+/******************************************************************************
+*        Title: Aerobatica
+* Date Started: April 10th, 2009
+*    Developer: Liam Hagerty
+*       Module: Batch Environment Header
+*  Description: This module contains the batched environment bots are
+*                 trained against. It owns many independent worlds in one
+*                 block, steps every one of them a tick with a single call
+*                 (runs of worlds spread across the job system, each world
+*                 using the batched kernels within it) and hands back what
+*                 each bot sees and earned in flat arrays.
+*
+*                 A world whose round ends is restarted straight away from
+*                 a seed worked out from its number and how many rounds it
+*                 has finished, so a batch plays out the same on any number
+*                 of threads
+*      Version: 1.0
+******************************************************************************/
+#ifndef _BATCH_H
+#define _BATCH_H 1
+
+#pragma region Include Files
+#include "Aerobatica_simulation.h" //The worlds
+#include "Aerobatica_jobs.h"       //Work-stealing job system
+#pragma endregion
+
+#pragma region Constants
+#define BATCH_NEAREST 8          //Closest planes, and closest shots, each observation lists
+#define BATCH_CONTACT_VALUES 3   //Offset across and down from the player, and 1 if present
+#define BATCH_PLAYER_VALUES 3    //Player's middle across and down, and fire cooldown
+#define BATCH_OBSERVATION_SIZE (BATCH_PLAYER_VALUES + 2 * BATCH_NEAREST * BATCH_CONTACT_VALUES)
+#define BATCH_WORLD_CHUNK 4      //Worlds stepped by each job
+
+//Rewards for a step
+#define BATCH_REWARD_KILL 1.0f
+#define BATCH_REWARD_VICTORY 10.0f
+#define BATCH_REWARD_DEFEAT -10.0f
+#pragma endregion
+
+//Batch Environment Structure
+typedef struct
+{
+	int count;                //Worlds in the batch
+	SIMULATION* worlds;       //All of them in one block
+	const SIM_INPUT* actions; //Controls for the step being taken
+
+	//Results of the last step, one row or entry per world
+	float* observations;      //count rows of BATCH_OBSERVATION_SIZE values
+	float* rewards;
+	unsigned char* dones;     //1 if its round ended (the world has already restarted)
+	unsigned long* rounds;    //Rounds each world has finished
+
+	unsigned long seed;       //Seed the batch was last reset with
+	JOBSYSTEM* jobs;          //Spreads the worlds over threads, NULL to step them in turn
+} BATCHENV;
+
+#pragma region Function Prototypes
+bool Batch_Create(BATCHENV*, int, JOBSYSTEM*);
+void Batch_Destroy(BATCHENV*);
+void Batch_Reset(BATCHENV*, unsigned long);
+void Batch_Step(BATCHENV*, const SIM_INPUT*);
+#pragma endregion
+#endif
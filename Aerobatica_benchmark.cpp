@@ -0,0 +1,683 @@
+/******************************************************************************
+*        Title: Aerobatica
+* Date Started: April 10th, 2009
+*    Developer: Liam Hagerty
+*       Module: Collision Benchmark
+*  Description: This module times the batched one-versus-many kernel
+*                 against a plain loop, a full world's tick as the job
+*                 system gains workers, seeker guidance as the number of
+*                 homing missiles grows, the per-pixel mask test against the
+*                 plain box test, batched environment steps as the job
+*                 system gains workers, saving and restoring world snapshots
+*                 against copying the whole world, mixing a block of sound
+*                 with every voice busy, and stepping and recording a
+*                 frame's particles
+*        Usage: Aerobatica_benchmark
+*      Version: 1.0
+******************************************************************************/
+#pragma region Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "Aerobatica_simulation.h" //Playfield size
+#include "Aerobatica_batch.h"      //Batched environments
+#include "Aerobatica_collision.h"  //Box and mask tests
+#include "Aerobatica_simd.h"       //Batched box tests
+#include "Aerobatica_timer.h"      //Wall-clock time for threaded runs
+#include "Aerobatica_mixer.h"      //Sound effects
+#include "Aerobatica_particles.h"  //Explosions and exhaust
+#pragma endregion
+
+#pragma region Constants
+#define BENCH_KERNEL_BOXES 100000 //Boxes the kernel is tested against
+#define BENCH_MIN_SIZE 2       //Smallest box edge
+#define BENCH_MAX_SIZE 10      //Largest box edge
+#define BENCH_TICKS 200        //Ticks timed per job system size
+#define BENCH_MASK_PAIRS 100000 //Box pairs put through the mask test
+#define BENCH_MASK_WORDS 4096   //Room for the two test masks
+#define BENCH_BATCH_WORLDS 256  //Worlds in the environment batch
+#define BENCH_BATCH_STEPS 2000  //Batch steps timed per job system size
+#define BENCH_SNAPSHOTS 2000    //Saves and restores timed per world
+#define BENCH_ROUND_TICKS 300   //Ticks played into the ordinary round first
+#define BENCH_MIX_BLOCKS 20000  //Sound blocks mixed
+#define BENCH_PARTICLE_FRAMES 200     //Particle frames timed per population
+#define BENCH_PARTICLE_SECONDS 0.001f //Length of each, short so few particles die
+#pragma endregion
+
+#pragma region Function Prototypes
+int Benchmark_Kernel(const int*, const int*, const int*, const int*, int);
+int Benchmark_Jobs();
+void Benchmark_Seekers();
+void Benchmark_Masks();
+void Fill_Ellipse(COLLISIONMASK*, uint64_t*, int, int);
+int Benchmark_Batch();
+int Benchmark_Snapshots();
+void Benchmark_Mixer();
+void Benchmark_Particles();
+void Fill_World(SIMULATION*);
+void Top_Up_Shots(SIMULATION*);
+double Seconds_Since(clock_t);
+#pragma endregion
+
+int main()
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: The time of each part will be reported
+	*   Description: Benchmark entry point
+	*     Algorithm: Scatter small boxes over the playfield
+	*                Time the batched kernel, the job system, the seekers,
+	*                  the masks, the environment batch, the snapshots, the
+	*                  sound mixer and the particles
+	**************************************************************************/
+	int *xCoordinate, *yCoordinate, *width, *height;
+	int box;
+
+	//allocate the boxes
+	xCoordinate = (int*)malloc(BENCH_KERNEL_BOXES * sizeof(int));
+	yCoordinate = (int*)malloc(BENCH_KERNEL_BOXES * sizeof(int));
+	width = (int*)malloc(BENCH_KERNEL_BOXES * sizeof(int));
+	height = (int*)malloc(BENCH_KERNEL_BOXES * sizeof(int));
+
+	if(!xCoordinate || !yCoordinate || !width || !height)
+	{
+		printf("Out of memory\n");
+		return 1;
+	}
+
+	//Scatter the boxes
+	srand(2009);
+	for(box = 0; box < BENCH_KERNEL_BOXES; box++)
+	{
+		width[box] = BENCH_MIN_SIZE + rand() % (BENCH_MAX_SIZE - BENCH_MIN_SIZE + 1);
+		height[box] = BENCH_MIN_SIZE + rand() % (BENCH_MAX_SIZE - BENCH_MIN_SIZE + 1);
+		xCoordinate[box] = rand() % (PLAYFIELD_WIDTH - width[box]);
+		yCoordinate[box] = rand() % (PLAYFIELD_HEIGHT - height[box]);
+	}
+
+	//time the batched kernel
+	if(!Benchmark_Kernel(xCoordinate, yCoordinate, width, height, BENCH_KERNEL_BOXES))
+		return 1;
+
+	//time a full world's tick on more and more workers
+	if(!Benchmark_Jobs())
+		return 1;
+
+	//time the guidance pass with more and more seekers
+	Benchmark_Seekers();
+
+	//time the per-pixel narrow phase
+	Benchmark_Masks();
+
+	//time stepping many worlds at once
+	if(!Benchmark_Batch())
+		return 1;
+
+	//time saving and restoring worlds for rollback
+	if(!Benchmark_Snapshots())
+		return 1;
+
+	//time mixing sound
+	Benchmark_Mixer();
+
+	//time the effects
+	Benchmark_Particles();
+
+	//clean up
+	free(xCoordinate);
+	free(yCoordinate);
+	free(width);
+	free(height);
+
+	return 0;
+}
+
+int Benchmark_Kernel(const int* xCoordinate, const int* yCoordinate,
+					 const int* width, const int* height, int count)
+{
+	/**************************************************************************
+	*  PreCondition: The boxes have been scattered
+	* PostCondition: The kernel's time per box will be reported, returns 0 if
+	*                  its mask disagrees with the plain box test
+	*   Description: One-versus-many kernel benchmark
+	*     Algorithm: Time a player-sized box against every box with the kernel
+	*                Time the same test as a plain loop
+	*                Compare the two masks bit for bit
+	**************************************************************************/
+	const int repetitions = 200;
+	uint64_t* kernelHits = (uint64_t*)malloc(HIT_WORDS(count) * sizeof(uint64_t));
+	uint64_t* loopHits = (uint64_t*)malloc(HIT_WORDS(count) * sizeof(uint64_t));
+	double kernelTime, loopTime;
+	clock_t started;
+	int run, box, agree = 1;
+
+	if(!kernelHits || !loopHits)
+		return 0;
+
+	//Time the kernel
+	started = clock();
+	for(run = 0; run < repetitions; run++)
+		Collision_One_Vs_Many(100 + run, 350, 126, 47, xCoordinate, yCoordinate, width, height,
+			count, kernelHits);
+	kernelTime = Seconds_Since(started) / repetitions;
+
+	//Time the plain loop
+	started = clock();
+	for(run = 0; run < repetitions; run++)
+	{
+		memset(loopHits, 0, HIT_WORDS(count) * sizeof(uint64_t));
+		for(box = 0; box < count; box++)
+			loopHits[box >> 6] |= (uint64_t)AABB_Overlap(100 + run, 350, 126, 47, xCoordinate[box],
+				yCoordinate[box], width[box], height[box]) << (box & 63);
+	}
+	loopTime = Seconds_Since(started) / repetitions;
+
+	//the masks must match
+	for(box = 0; box < HIT_WORDS(count); box++)
+		if(kernelHits[box] != loopHits[box])
+			agree = 0;
+
+	printf("\none-vs-%d kernel (%s): %.1f us, plain loop: %.1f us\n", count,
+		Collision_Kernel_Name(), kernelTime * 1e6, loopTime * 1e6);
+	if(!agree)
+		printf("Mismatch between the kernel and the plain loop\n");
+
+	free(kernelHits);
+	free(loopHits);
+	return agree;
+}
+
+int Benchmark_Jobs()
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: The time per tick of a full world will be reported with
+	*                  no job system and with 1, 2, 4, ... workers, returns 0
+	*                  if any run ends in a different world
+	*   Description: Job system scaling benchmark
+	*     Algorithm: Fill a world to capacity
+	*                For no job system, then each worker count,
+	*                  Start from a copy of the full world
+	*                  Time BENCH_TICKS ticks, topping the shots back up
+	*                  Hash the world and compare it with the serial run
+	**************************************************************************/
+	static SIMULATION full, world; //too large for the stack
+	static JOBSYSTEM jobs;
+	int workers, maximum = Jobs_Default_Workers(), tick, agree = 1;
+	unsigned long serialHash = 0, hash;
+	double serialTime = 0, time;
+	long long started;
+
+	Fill_World(&full);
+	printf("\n%d planes, %d shots, %d ticks\n", full.entities.count, full.projectiles.count, BENCH_TICKS);
+	printf("%8s %12s %10s %10s\n", "workers", "tick us", "speedup", "hash");
+
+	//-1 runs without a job system
+	for(workers = -1; workers <= maximum; workers = workers < 1 ? workers + 1 : workers * 2)
+	{
+		if(workers >= 0)
+		{
+			Jobs_Init(&jobs, workers);
+			Sim_Use_Jobs(&jobs);
+		}
+
+		memcpy(&world, &full, sizeof(SIMULATION));
+		started = Timer_Microseconds();
+		for(tick = 0; tick < BENCH_TICKS; tick++)
+		{
+			Sim_Tick(&world, 0);
+
+			//keep the round going so every tick does the full amount of work
+			world.status = SIM_PLAYING;
+			Top_Up_Shots(&world);
+		}
+		time = (double)(Timer_Microseconds() - started) / BENCH_TICKS;
+		hash = Sim_Hash(&world);
+
+		if(workers >= 0)
+		{
+			Sim_Use_Jobs(NULL);
+			Jobs_Shutdown(&jobs);
+		}
+		else
+		{
+			serialTime = time;
+			serialHash = hash;
+		}
+
+		if(workers < 0)
+			printf("%8s ", "none");
+		else
+			printf("%8d ", workers);
+		printf("%12.1f %9.2fx %10lx\n", time, serialTime / time, hash);
+
+		//splitting the tick must not change its outcome
+		if(hash != serialHash)
+			agree = 0;
+	}
+
+	if(!agree)
+		printf("Mismatch between the serial and the parallel ticks\n");
+
+	return agree;
+}
+
+void Benchmark_Seekers()
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: The time to steer and move 100 up to a full pool of
+	*                  homing missiles will be reported, with its share of a
+	*                  tick
+	*   Description: Seeker guidance benchmark
+	*     Algorithm: For each number of seekers,
+	*                  Start a round and scatter that many homing missiles
+	*                  Time BENCH_TICKS rounds of steering and moving them
+	*                    (fuel lasts the whole run)
+	**************************************************************************/
+	static const int sizes[] = { 100, 250, 500, PROJECTILE_CAPACITY };
+	static SIMULATION world; //too large for the stack
+	int targetX, targetY, tick;
+	unsigned sizeIndex;
+	double time;
+	long long started;
+
+	printf("\n%8s %12s %10s\n", "seekers", "steer us", "of tick");
+
+	for(sizeIndex = 0; sizeIndex < sizeof(sizes) / sizeof(sizes[0]); sizeIndex++)
+	{
+		Sim_Init(&world, 2009);
+		while(world.projectiles.count < sizes[sizeIndex])
+			Fire_Projectile(&world, ENTITY_HOMING_MISSILE, (int)(Sim_Random(&world) % PLAYFIELD_WIDTH),
+				(int)(Sim_Random(&world) % PLAYFIELD_HEIGHT), Sim_Random(&world) % 2 != 0);
+		Player_Middle(&world, &targetX, &targetY);
+
+		started = Timer_Microseconds();
+		for(tick = 0; tick < BENCH_TICKS; tick++)
+		{
+			Pool_Steer(&world.projectiles, targetX, targetY, 0, world.projectiles.count);
+			Pool_Move(&world.projectiles, 0, world.projectiles.count);
+		}
+		time = (double)(Timer_Microseconds() - started) / BENCH_TICKS;
+
+		printf("%8d %12.2f %9.3f%%\n", world.projectiles.count, time, time * 100.0 / SIM_TICK_US);
+	}
+}
+
+void Benchmark_Masks()
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: The time per pair of the box test alone and of the box
+	*                  test followed by the mask test will be reported, with
+	*                  how many box hits the masks kept
+	*   Description: Per-pixel narrow phase benchmark, a bullet against a
+	*                  helicopter, both cut to ellipses the size of their
+	*                  frames
+	*     Algorithm: Place the helicopter at random near the bullet for every
+	*                  pair
+	*                Time the box test over all the pairs
+	*                Time the box test then, for box hits, the mask test
+	**************************************************************************/
+	static uint64_t words[BENCH_MASK_WORDS];
+	static int xCoordinate[BENCH_MASK_PAIRS], yCoordinate[BENCH_MASK_PAIRS];
+	COLLISIONMASK bullet, helicopter;
+	int pair, boxHits = 0, maskHits = 0, run, runs = 20;
+	double boxTime, maskTime;
+	long long started;
+	SIMULATION seed;
+
+	Fill_Ellipse(&bullet, words, 361, 36);
+	Fill_Ellipse(&helicopter, words + 2 * bullet.rowWords * bullet.height, 141, 42);
+
+	//scatter the helicopters over and around the bullet
+	Sim_Init(&seed, 2009);
+	for(pair = 0; pair < BENCH_MASK_PAIRS; pair++)
+	{
+		xCoordinate[pair] = (int)(Sim_Random(&seed) % 560) - 160;
+		yCoordinate[pair] = (int)(Sim_Random(&seed) % 100) - 50;
+	}
+
+	started = Timer_Microseconds();
+	for(run = 0; run < runs; run++)
+		for(pair = 0, boxHits = 0; pair < BENCH_MASK_PAIRS; pair++)
+			boxHits += AABB_Overlap(0, 0, 361, 36, xCoordinate[pair], yCoordinate[pair], 141, 42);
+	boxTime = (double)(Timer_Microseconds() - started) * 1000.0 / runs / BENCH_MASK_PAIRS;
+
+	started = Timer_Microseconds();
+	for(run = 0; run < runs; run++)
+		for(pair = 0, maskHits = 0; pair < BENCH_MASK_PAIRS; pair++)
+			maskHits += AABB_Overlap(0, 0, 361, 36, xCoordinate[pair], yCoordinate[pair], 141, 42) &&
+				Mask_Overlap(0, 0, 361, 36, &bullet, xCoordinate[pair], yCoordinate[pair], 141, 42,
+					&helicopter);
+	maskTime = (double)(Timer_Microseconds() - started) * 1000.0 / runs / BENCH_MASK_PAIRS;
+
+	printf("\nmasks: box test %.1f ns a pair, box then mask %.1f ns, %d of %d box hits kept\n",
+		boxTime, maskTime, maskHits, boxHits);
+}
+
+void Fill_Ellipse(COLLISIONMASK* mask, uint64_t* words, int width, int height)
+{
+	/**************************************************************************
+	*  PreCondition: words has room for the mask's rows
+	* PostCondition: mask will be an ellipse filling a width by height box
+	*   Description: Stands in for a frame cut from the sprite sheet
+	*     Algorithm: Set the bit of every pixel whose centre is inside the
+	*                  ellipse, using integers only
+	**************************************************************************/
+	long long x, y, a = width, b = height;
+
+	mask->rows = words;
+	mask->width = width;
+	mask->height = height;
+	mask->rowWords = (width + 63) / 64;
+	memset(words, 0, mask->rowWords * height * sizeof(uint64_t));
+
+	//(2x - a)^2 b^2 + (2y - b)^2 a^2 <= a^2 b^2, from pixel centres
+	for(y = 0; y < height; y++)
+		for(x = 0; x < width; x++)
+			if((2 * x + 1 - a) * (2 * x + 1 - a) * b * b + (2 * y + 1 - b) * (2 * y + 1 - b) * a * a <=
+				a * a * b * b)
+				words[y * mask->rowWords + x / 64] |= 1ULL << (x % 64);
+}
+
+int Benchmark_Batch()
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: Environment steps per second of a batch of worlds will be
+	*                  reported with no job system and with 1, 2, 4, ...
+	*                  workers, returns 0 if any run ends differently
+	*   Description: Batched environment benchmark, bots pressing random
+	*                  controls
+	*     Algorithm: For no job system, then each worker count,
+	*                  Create and reset the batch
+	*                  Time BENCH_BATCH_STEPS steps, the controls drawn from
+	*                    a generator seeded the same every run
+	*                  Hash every world and the rewards, and compare with the
+	*                    serial run
+	**************************************************************************/
+	static SIM_INPUT actions[BENCH_BATCH_WORLDS];
+	static JOBSYSTEM jobs; //too large for the stack
+	BATCHENV batch;
+	int workers, maximum = Jobs_Default_Workers(), step, world, agree = 1;
+	unsigned long serialHash = 0, hash, random;
+	double serialRate = 0, rate, rewards;
+	long long started;
+
+	printf("\n%d worlds, %d steps\n", BENCH_BATCH_WORLDS, BENCH_BATCH_STEPS);
+	printf("%8s %14s %10s %10s %10s\n", "workers", "steps/second", "speedup", "rewards", "hash");
+
+	//-1 runs without a job system
+	for(workers = -1; workers <= maximum; workers = workers < 1 ? workers + 1 : workers * 2)
+	{
+		if(workers >= 0)
+			Jobs_Init(&jobs, workers);
+		if(!Batch_Create(&batch, BENCH_BATCH_WORLDS, workers >= 0 ? &jobs : NULL))
+		{
+			printf("Not enough memory for %d worlds\n", BENCH_BATCH_WORLDS);
+			return 0;
+		}
+		Batch_Reset(&batch, 2009);
+
+		random = 2009;
+		rewards = 0;
+		started = Timer_Microseconds();
+		for(step = 0; step < BENCH_BATCH_STEPS; step++)
+		{
+			for(world = 0; world < BENCH_BATCH_WORLDS; world++)
+			{
+				random = (random * 1103515245UL + 12345UL) & 0xFFFFFFFFUL;
+				actions[world] = (SIM_INPUT)((random >> 16) & 0x1F);
+			}
+			Batch_Step(&batch, actions);
+			for(world = 0; world < BENCH_BATCH_WORLDS; world++)
+				rewards += batch.rewards[world];
+		}
+		rate = (double)BENCH_BATCH_STEPS * BENCH_BATCH_WORLDS * 1e6 /
+			(double)(Timer_Microseconds() - started);
+
+		hash = 0;
+		for(world = 0; world < BENCH_BATCH_WORLDS; world++)
+			hash = hash * 31 + Sim_Hash(&batch.worlds[world]) + batch.rounds[world];
+		hash &= 0xFFFFFFFFUL;
+
+		Batch_Destroy(&batch);
+		if(workers >= 0)
+			Jobs_Shutdown(&jobs);
+		else
+		{
+			serialRate = rate;
+			serialHash = hash;
+		}
+
+		if(workers < 0)
+			printf("%8s ", "none");
+		else
+			printf("%8d ", workers);
+		printf("%14.0f %9.2fx %10.0f %10lx\n", rate, rate / serialRate, rewards, hash);
+
+		//spreading the worlds must not change how they play out
+		if(hash != serialHash)
+			agree = 0;
+	}
+
+	if(!agree)
+		printf("Mismatch between the serial and the parallel batches\n");
+
+	return agree;
+}
+
+int Benchmark_Snapshots()
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: The size of a snapshot and the time to save and restore
+	*                  it will be reported for an ordinary round and a full
+	*                  world, next to copying the whole world, returns 0 if a
+	*                  restored world differs from the saved one
+	*   Description: Rollback snapshot benchmark
+	*     Algorithm: For a round a few seconds in, then a full world,
+	*                  Time BENCH_SNAPSHOTS saves, restores and whole-world
+	*                    copies
+	*                  Compare the restored world's hash with the original's
+	**************************************************************************/
+	static SIMULATION original, restored, copy; //too large for the stack
+	static SIMSNAPSHOT snapshot;
+	SIMULATION* volatile destination = &copy; //so the copies aren't optimized away
+	int world, repetition, agree = 1;
+	double saveTime, restoreTime, copyTime;
+	unsigned long random = 2009;
+	long long started;
+
+	printf("\n%12s %10s %10s %10s %10s\n", "world", "bytes", "save us", "restore us", "copy us");
+
+	for(world = 0; world < 2; world++)
+	{
+		//an ordinary round, or as much as a world holds
+		if(world == 0)
+		{
+			Sim_Init(&original, 2009);
+			for(repetition = 0; repetition < BENCH_ROUND_TICKS; repetition++)
+			{
+				random = (random * 1103515245UL + 12345UL) & 0xFFFFFFFFUL;
+				Sim_Tick(&original, (SIM_INPUT)((random >> 16) & 0x1F));
+			}
+		}
+		else
+			Fill_World(&original);
+
+		started = Timer_Microseconds();
+		for(repetition = 0; repetition < BENCH_SNAPSHOTS; repetition++)
+			Sim_Save(&original, &snapshot);
+		saveTime = (double)(Timer_Microseconds() - started) / BENCH_SNAPSHOTS;
+
+		started = Timer_Microseconds();
+		for(repetition = 0; repetition < BENCH_SNAPSHOTS; repetition++)
+			Sim_Restore(&restored, &snapshot);
+		restoreTime = (double)(Timer_Microseconds() - started) / BENCH_SNAPSHOTS;
+
+		started = Timer_Microseconds();
+		for(repetition = 0; repetition < BENCH_SNAPSHOTS; repetition++)
+			memcpy(destination, &original, sizeof(SIMULATION));
+		copyTime = (double)(Timer_Microseconds() - started) / BENCH_SNAPSHOTS;
+
+		printf("%12s %10lu %10.2f %10.2f %10.2f\n", world == 0 ? "round" : "full",
+			(unsigned long)snapshot.size, saveTime, restoreTime, copyTime);
+
+		//a restored world must be the one saved
+		if(Sim_Hash(&restored) != Sim_Hash(&original))
+			agree = 0;
+	}
+
+	if(!agree)
+		printf("Mismatch between a saved and a restored world\n");
+
+	return agree;
+}
+
+void Benchmark_Mixer()
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: The time to mix a block with every voice busy will be
+	*                  reported, as a share of the time the block plays for
+	*   Description: Sound mixer benchmark
+	*     Algorithm: Make the effects
+	*                Time BENCH_MIX_BLOCKS blocks, queueing a voice's worth
+	*                  of explosions before each so every voice is playing
+	*                  and each block steals them all back
+	**************************************************************************/
+	static MIXER mixer; //too large for the stack
+	int block, voice;
+	double blockTime;
+	long long started;
+
+	if(!Mixer_Init(&mixer))
+		return;
+
+	started = Timer_Microseconds();
+	for(block = 0; block < BENCH_MIX_BLOCKS; block++)
+	{
+		for(voice = 0; voice < MIXER_VOICES; voice++)
+			Mixer_Play(&mixer, SOUND_EXPLOSION, MIXER_UNITY, voice * 32 - MIXER_UNITY);
+		Mixer_Mix(&mixer);
+	}
+	blockTime = (double)(Timer_Microseconds() - started) / BENCH_MIX_BLOCKS;
+
+	printf("\n%12s %10s %10s %10s\n", "voices", "block us", "% of play", "stolen");
+	printf("%12d %10.2f %10.3f %10lu\n", MIXER_VOICES, blockTime,
+		blockTime * 100.0 * MIXER_RATE / (MIXER_BLOCK_FRAMES * 1000000.0), mixer.stolen);
+
+	Mixer_Release(&mixer);
+}
+
+void Benchmark_Particles()
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: The time to update a frame's particles and record them
+	*                  for drawing will be reported for each population
+	*   Description: Particle system benchmark
+	*     Algorithm: For each population,
+	*                  Queue and update blasts until that many particles are
+	*                    alive, scattered over the playfield
+	*                  Time BENCH_PARTICLE_FRAMES short frames of updating and
+	*                    recording
+	*                  Report microseconds per frame and the particles still
+	*                    drawn at the end
+	**************************************************************************/
+	static const int populations[] = { 1000, 10000, 100000, 120000 };
+	static PARTICLESYSTEM system; //too large for the stack
+	static PARTICLEBATCH batch;
+	unsigned long random = 2009;
+	int population, frame;
+	long long started;
+
+	printf("\n%12s %10s %10s %10s\n", "particles", "kernels", "frame us", "drawn");
+
+	for(population = 0; population < (int)(sizeof(populations) / sizeof(populations[0])); population++)
+	{
+		Particles_Init(&system, 2009);
+		while((int)system.count < populations[population])
+		{
+			random = (random * 1103515245UL + 12345UL) & 0xFFFFFFFFUL;
+			Particles_Burst(&system, 100 + (int)((random >> 8) % (PLAYFIELD_WIDTH - 200)),
+				100 + (int)((random >> 20) % (PLAYFIELD_HEIGHT - 200)));
+			Particles_Update(&system, 0.0f);
+		}
+
+		started = Timer_Microseconds();
+		for(frame = 0; frame < BENCH_PARTICLE_FRAMES; frame++)
+		{
+			Particles_Update(&system, BENCH_PARTICLE_SECONDS);
+			Particles_Emit(&system, &batch);
+		}
+
+		printf("%12d %10s %10.2f %10d\n", populations[population], Collision_Kernel_Name(),
+			(double)(Timer_Microseconds() - started) / BENCH_PARTICLE_FRAMES, batch.count);
+	}
+}
+
+void Fill_World(SIMULATION* world)
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: The world will hold as many planes and shots as it can
+	*   Description: Builds the benchmark world
+	*     Algorithm: Start a normal round
+	*                Scatter helicopters until the store is full, all of them
+	*                  attacking at once
+	*                Fill the projectile pool
+	**************************************************************************/
+	ENTITYSTORE* store = &world->entities;
+	SPRITE helicopter = { 0, 0, FIXED_PIXELS(5), FIXED_PIXELS(5), 0, 0, 144, 41, true, false, true,
+		BEHAVIOR_DIAGONAL_BOUNCE };
+	int plane;
+
+	Sim_Init(world, 2009);
+
+	while(store->count < ENTITY_CAPACITY)
+	{
+		helicopter.xCoordinate = (int)(Sim_Random(world) % (PLAYFIELD_WIDTH - helicopter.width));
+		helicopter.yCoordinate = (int)(Sim_Random(world) % (PLAYFIELD_HEIGHT - helicopter.height));
+		helicopter.xSpeed = Sim_Random(world) % 2 ? FIXED_PIXELS(5) : FIXED_PIXELS(-5);
+		helicopter.faceRight = helicopter.xSpeed > 0;
+		plane = Entity_Create(store, ENTITY_HELICOPTER, &helicopter);
+		Entity_Set_Flag(store->active, plane, true);
+	}
+
+	Top_Up_Shots(world);
+}
+
+void Top_Up_Shots(SIMULATION* world)
+{
+	/**************************************************************************
+	*  PreCondition: Sim_Init has run on the world
+	* PostCondition: The projectile pool will be full
+	*   Description: Replaces the shots that left the playfield or hit
+	*     Algorithm: Fire player bullets from random points until the pool
+	*                  is full, drawing on the world's own generator so every
+	*                  run fires the same shots
+	**************************************************************************/
+	int x, y;
+
+	while(world->projectiles.count < PROJECTILE_CAPACITY)
+	{
+		x = (int)(Sim_Random(world) % PLAYFIELD_WIDTH);
+		y = (int)(Sim_Random(world) % PLAYFIELD_HEIGHT);
+		Fire_Projectile(world, ENTITY_PLAYER_BULLET, x, y, true);
+	}
+}
+
+double Seconds_Since(clock_t started)
+{
+	/**************************************************************************
+	*  PreCondition: started came from clock()
+	* PostCondition: The processor time since then will be returned in seconds
+	*   Description: Benchmark timer
+	*     Algorithm: Difference the clock and scale it
+	**************************************************************************/
+	return (double)(clock() - started) / CLOCKS_PER_SEC;
+}
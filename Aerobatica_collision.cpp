@@ -0,0 +1,235 @@
+/******************************************************************************
+*        Title: Aerobatica
+* Date Started: April 10th, 2009
+*    Developer: Liam Hagerty
+*       Module: Collision Code Module
+*  Description: This module contains the swept and per-pixel tests that
+*                 narrow the boxes a batched box test found down to the
+*                 ones that really touch
+*      Version: 1.0
+******************************************************************************/
+#pragma region Includes
+#include <stdint.h>
+#include <string.h>
+#include "Aerobatica_collision.h" //Collision Definitions Header
+#pragma endregion
+
+#pragma region Function Prototypes
+static bool Sweep_Axis(FIXED, int, FIXED, int, int, int64_t*, int64_t*);
+static uint64_t Mask_Bits(const COLLISIONMASK*, int, int);
+#pragma endregion
+
+bool AABB_Sweep(FIXED x1, FIXED y1, int width1, int height1, FIXED xMove, FIXED yMove,
+				int x2, int y2, int width2, int height2, FIXED* impact)
+{
+	/**************************************************************************
+	*  PreCondition: Box 1 ended the tick at x1, y1 (in fixed point, with its
+	*                  subpixels) after moving xMove, yMove in a straight
+	*                  line, box 2 stood still
+	* PostCondition: Returns whether the boxes overlapped at any point in the
+	*                  tick, and if so impact will hold the fraction of the
+	*                  tick (0 to FIXED_ONE) at which they first did
+	*   Description: Continuous version of AABB_Overlap(), so a box moving
+	*                  further in a tick than the other is wide can't pass
+	*                  through it. It finds every hit AABB_Overlap() finds at
+	*                  the end of the tick
+	*     Algorithm: Find when the boxes start and stop overlapping on each
+	*                  axis, in fixed-point fractions of the tick
+	*                They touch if the later start comes before the earlier
+	*                  stop, within the tick
+	**************************************************************************/
+	int64_t enter, leave, yEnter, yLeave;
+
+	if(!Sweep_Axis(x1, width1, xMove, x2, width2, &enter, &leave) ||
+		!Sweep_Axis(y1, height1, yMove, y2, height2, &yEnter, &yLeave))
+		return false;
+	if(yEnter > enter)
+		enter = yEnter;
+	if(yLeave < leave)
+		leave = yLeave;
+	if(enter < 0)
+		enter = 0;
+	if(leave > FIXED_ONE)
+		leave = FIXED_ONE;
+
+	//boxes that only share an edge don't overlap
+	if(enter >= leave)
+		return false;
+	*impact = (FIXED)enter;
+
+	return true;
+}
+
+static bool Sweep_Axis(FIXED end1, int size1, FIXED move, int start2, int size2,
+					   int64_t* enter, int64_t* leave)
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: Returns false if the spans never overlap on this axis,
+	*                  otherwise enter and leave will hold when they start and
+	*                  stop overlapping, in 1/65536ths of the tick
+	*   Description: One axis of AABB_Sweep()
+	*     Algorithm: A span that didn't move sits on its whole pixel and
+	*                  overlaps for all or none of the tick
+	*                Otherwise divide the gaps to close by the move, rounding
+	*                  the start down and the stop up so a touch is never
+	*                  lost to rounding
+	**************************************************************************/
+	int64_t begin = (int64_t)end1 - move; //Where the span started
+	int64_t nearGap, farGap, speed = move;
+
+	if(move == 0)
+	{
+		*enter = INT64_MIN;
+		*leave = INT64_MAX;
+		return Fixed_Floor(end1) < start2 + size2 && start2 < Fixed_Floor(end1) + size1;
+	}
+
+	//distances to touching and to passing, in the direction of travel
+	if(move > 0)
+	{
+		nearGap = (int64_t)start2 * FIXED_ONE - (begin + (int64_t)size1 * FIXED_ONE);
+		farGap = (int64_t)(start2 + size2) * FIXED_ONE - begin;
+	}
+	else
+	{
+		nearGap = begin - (int64_t)(start2 + size2) * FIXED_ONE;
+		farGap = begin + (int64_t)size1 * FIXED_ONE - (int64_t)start2 * FIXED_ONE;
+		speed = -speed;
+	}
+
+	//round toward a longer overlap, never a shorter one
+	nearGap *= FIXED_ONE;
+	farGap *= FIXED_ONE;
+	*enter = nearGap >= 0 ? nearGap / speed : -((-nearGap + speed - 1) / speed);
+	*leave = farGap >= 0 ? (farGap + speed - 1) / speed : -(-farGap / speed);
+
+	return true;
+}
+
+bool Mask_Overlap(int x1, int y1, int width1, int height1, const COLLISIONMASK* mask1,
+				  int x2, int y2, int width2, int height2, const COLLISIONMASK* mask2)
+{
+	/**************************************************************************
+	*  PreCondition: Each mask is NULL, solid (no rows) or laid over the top
+	*                  left of its box
+	* PostCondition: Returns whether the boxes overlap on a pixel both of
+	*                  them are solid in
+	*   Description: Per-pixel narrow phase, which costs no more than the box
+	*                  test unless the boxes touch and both have masks
+	*     Algorithm: Find where the boxes overlap, no overlap is no hit
+	*                Two solid boxes that overlap hit
+	*                For each row they share,
+	*                  For each run of up to 64 pixels across the overlap,
+	*                    Shift each mask's bits into line and and them
+	*                    Any bit left is a hit
+	**************************************************************************/
+	int left = x1 > x2 ? x1 : x2, top = y1 > y2 ? y1 : y2;
+	int right = x1 + width1 < x2 + width2 ? x1 + width1 : x2 + width2;
+	int bottom = y1 + height1 < y2 + height2 ? y1 + height1 : y2 + height2;
+	int row, column;
+
+	if(left >= right || top >= bottom)
+		return false;
+	if((mask1 == NULL || mask1->rows == NULL) && (mask2 == NULL || mask2->rows == NULL))
+		return true;
+
+	for(row = top; row < bottom; row++)
+		for(column = left; column < right; column += 64)
+		{
+			uint64_t bits = Mask_Bits(mask1, row - y1, column - x1) &
+				Mask_Bits(mask2, row - y2, column - x2);
+
+			//drop the pixels past the overlap
+			if(right - column < 64)
+				bits &= (1ULL << (right - column)) - 1;
+			if(bits != 0)
+				return true;
+		}
+
+	return false;
+}
+
+bool Mask_Sweep(FIXED x1, FIXED y1, int width1, int height1, const COLLISIONMASK* mask1,
+				FIXED xMove, FIXED yMove, int x2, int y2, int width2, int height2,
+				const COLLISIONMASK* mask2, FIXED* impact)
+{
+	/**************************************************************************
+	*  PreCondition: As AABB_Sweep(), with each box's mask as Mask_Overlap()
+	* PostCondition: Returns whether the masks touched at any point in the
+	*                  tick, and if so impact will hold when they first did
+	*   Description: AABB_Sweep() cut down to the pixels of each sprite
+	*     Algorithm: Sweep the boxes, if they never touch neither do the masks
+	*                If both are solid the boxes' impact is the answer
+	*                Otherwise step from the boxes' impact to the end of the
+	*                  tick a pixel at a time along the longer axis,
+	*                  Place the moving box and test the masks there
+	*                  The first step they touch is the impact
+	**************************************************************************/
+	FIXED enter, startX = x1 - xMove, startY = y1 - yMove;
+	int64_t longest = xMove < 0 ? -(int64_t)xMove : xMove;
+	int64_t steps, step;
+
+	if(!AABB_Sweep(x1, y1, width1, height1, xMove, yMove, x2, y2, width2, height2, &enter))
+		return false;
+	if((mask1 == NULL || mask1->rows == NULL) && (mask2 == NULL || mask2->rows == NULL))
+	{
+		*impact = enter;
+		return true;
+	}
+
+	//a step for every pixel left to travel, and one for where it stops
+	if(yMove < 0 ? -(int64_t)yMove > longest : yMove > longest)
+		longest = yMove < 0 ? -(int64_t)yMove : yMove;
+	steps = (longest * (FIXED_ONE - enter) / FIXED_ONE + FIXED_FRACTION) / FIXED_ONE + 1;
+
+	for(step = 0; step <= steps; step++)
+	{
+		FIXED when = (FIXED)(enter + (FIXED_ONE - enter) * step / steps);
+
+		if(Mask_Overlap(Fixed_Floor((FIXED)(startX + (int64_t)xMove * when / FIXED_ONE)),
+			Fixed_Floor((FIXED)(startY + (int64_t)yMove * when / FIXED_ONE)), width1, height1,
+			mask1, x2, y2, width2, height2, mask2))
+		{
+			*impact = when;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static uint64_t Mask_Bits(const COLLISIONMASK* mask, int row, int column)
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: The mask's bits for pixels column to column + 63 of the
+	*                  row will be returned, lowest bit first
+	*   Description: Reads 64 pixels of a mask from any position, which may
+	*                  be partly or wholly outside it
+	*     Algorithm: A solid box is all ones
+	*                Outside the mask is all zeroes
+	*                Left of the mask, shift the row's first word up
+	*                Otherwise join the two words the run straddles
+	**************************************************************************/
+	const uint64_t* words;
+	int word, shift;
+	uint64_t bits;
+
+	if(mask == NULL || mask->rows == NULL)
+		return ~0ULL;
+	if(row < 0 || row >= mask->height || column >= mask->width || column <= -64)
+		return 0;
+	words = mask->rows + row * mask->rowWords;
+	if(column < 0)
+		return words[0] << -column;
+
+	//(bits past the width are stored as zero)
+	word = column >> 6;
+	shift = column & 63;
+	bits = words[word] >> shift;
+	if(shift != 0 && word + 1 < mask->rowWords)
+		bits |= words[word + 1] << (64 - shift);
+
+	return bits;
+}
@@ -0,0 +1,71 @@
+/******************************************************************************
+*        Title: Aerobatica
+* Date Started: April 10th, 2009
+*    Developer: Liam Hagerty
+*       Module: Collision Header
+*  Description: This module contains the branch-free box test and the
+*                 narrow phase behind it. The batched kernels find the boxes
+*                 one box touches straight out of the coordinate columns and
+*                 these tests narrow them down.
+*
+*                 Fast boxes are tested along the path they took over the
+*                 tick rather than only where they ended it. The box that
+*                 covers the whole path is box tested like any other, and
+*                 the swept test gives the fraction of the tick at which
+*                 the moving box first touched.
+*
+*                 Once two boxes touch, their 1-bit masks (one bit per pixel
+*                 of the frame, kept as rows of 64-bit words) can be anded
+*                 over the rows the boxes share, so the see-through parts of
+*                 a sprite don't count as hits
+*      Version: 1.0
+******************************************************************************/
+#ifndef _COLLISION_H
+#define _COLLISION_H 1
+
+#pragma region Include Files
+#include "Aerobatica_fixed.h" //Fixed-Point Kinematics Header
+#pragma endregion
+
+//1-bit mask of the pixels a sprite is solid in, bit n of a row's word w is
+//pixel 64 * w + n from its left edge. rows is NULL for a solid box
+typedef struct
+{
+	const uint64_t* rows;
+	int width, height; //Pixels outside the mask are see-through
+	int rowWords;      //64-bit words in each row
+} COLLISIONMASK;
+
+#pragma region Function Prototypes
+bool AABB_Sweep(FIXED, FIXED, int, int, FIXED, FIXED, int, int, int, int, FIXED*);
+bool Mask_Overlap(int, int, int, int, const COLLISIONMASK*,
+				  int, int, int, int, const COLLISIONMASK*);
+bool Mask_Sweep(FIXED, FIXED, int, int, const COLLISIONMASK*, FIXED, FIXED,
+				int, int, int, int, const COLLISIONMASK*, FIXED*);
+#pragma endregion
+
+#pragma region Narrow Phase
+inline int AABB_Overlap(int x1, int y1, int width1, int height1,
+						int x2, int y2, int width2, int height2)
+{
+	//each edge test is a plain comparison and they are combined with bitwise
+	//ands, so there is no short-circuit branching
+	return (x1 < x2 + width2) & (x2 < x1 + width1) & (y1 < y2 + height2) & (y2 < y1 + height1);
+}
+
+inline void AABB_Swept_Bounds(FIXED x, FIXED y, FIXED xMove, FIXED yMove,
+							  int* left, int* top, int* width, int* height)
+{
+	//grow a box that ended the tick at x, y (subpixels and all) back over
+	//where it started, so it covers every pixel of its path
+	FIXED startX = x - xMove, startY = y - yMove;
+	FIXED lowX = startX < x ? startX : x, highX = startX < x ? x : startX;
+	FIXED lowY = startY < y ? startY : y, highY = startY < y ? y : startY;
+
+	*left = Fixed_Floor(lowX);
+	*top = Fixed_Floor(lowY);
+	*width += Fixed_Floor(highX + FIXED_FRACTION) - *left;
+	*height += Fixed_Floor(highY + FIXED_FRACTION) - *top;
+}
+#pragma endregion
+#endif
@@ -0,0 +1,349 @@
+/******************************************************************************
+*        Title: Aerobatica
+* Date Started: April 10th, 2009
+*    Developer: Liam Hagerty
+*       Module: Entity Store Code Module
+*  Description: This module contains the linear update passes that run over
+*                 every entity in the store, whatever its type. Movement is
+*                 a template instantiated once per behavior, so each batch
+*                 runs a loop with its behavior compiled in
+*      Version: 1.0
+******************************************************************************/
+#pragma region Includes
+#include <stdlib.h>
+#include <string.h>
+#include "Aerobatica_entities.h" //Entity Store Definitions Header
+#pragma endregion
+
+//Movement of one behavior's batch over rows begin to end - 1
+typedef void (*BATCHMOVER)(ENTITYSTORE*, const ENTITYFIELD*, int, int);
+
+#pragma region Global Variables
+const unsigned char entityTypeFlags[ENTITY_TYPE_COUNT] =
+{
+	0,                             //Player Jet
+	TYPE_ENEMY | TYPE_HAZARD,      //Vulcan Jet
+	TYPE_ENEMY | TYPE_HAZARD,      //Missile Jet
+	TYPE_ENEMY | TYPE_HAZARD,      //Helicopter
+	TYPE_ENEMY,                    //Bomber
+	TYPE_PROJECTILE,               //Player Bullet
+	TYPE_PROJECTILE | TYPE_HAZARD, //Enemy Bullet
+	TYPE_PROJECTILE | TYPE_HAZARD, //Missile
+	TYPE_PROJECTILE | TYPE_HAZARD | TYPE_SEEKER //Homing Missile
+};
+
+//Movement bits of each behavior, known when the batch loops are compiled
+static constexpr unsigned char behaviorMoves[BEHAVIOR_COUNT] =
+{
+	0,                   //None
+	BOUNCE_Y,            //Vertical Bounce
+	BOUNCE_X,            //Horizontal Bounce
+	BOUNCE_X | BOUNCE_Y, //Diagonal Bounce
+	BOUNCE_Y,            //Patrol
+	HOME_IN              //Homing
+};
+#pragma endregion
+
+#pragma region Function Prototypes
+template<unsigned char MOVES>
+static void Move_Batch(ENTITYSTORE*, const ENTITYFIELD*, int, int);
+static void Open_Row(ENTITYSTORE*, int);
+#pragma endregion
+
+#pragma region Global Variables
+//Each behavior's batch loop
+static const BATCHMOVER batchMovers[BEHAVIOR_COUNT] =
+{
+	Move_Batch<behaviorMoves[BEHAVIOR_NONE]>,
+	Move_Batch<behaviorMoves[BEHAVIOR_VERTICAL_BOUNCE]>,
+	Move_Batch<behaviorMoves[BEHAVIOR_HORIZONTAL_BOUNCE]>,
+	Move_Batch<behaviorMoves[BEHAVIOR_DIAGONAL_BOUNCE]>,
+	Move_Batch<behaviorMoves[BEHAVIOR_PATROL]>,
+	Move_Batch<behaviorMoves[BEHAVIOR_HOMING]>
+};
+#pragma endregion
+
+void Entity_Clear(ENTITYSTORE* store)
+{
+	/**************************************************************************
+	*  PreCondition: The store has been allocated
+	* PostCondition: The store will hold no entities
+	*   Description: Empties the store
+	*     Algorithm: Reset the count, the serials and the batches
+	*                Clear every flag word
+	**************************************************************************/
+	store->count = 0;
+	store->nextSerial = 0;
+	memset(store->batchEnd, 0, sizeof(store->batchEnd));
+	memset(store->faceRight, 0, sizeof(store->faceRight));
+	memset(store->destroyed, 0, sizeof(store->destroyed));
+	memset(store->onscreen, 0, sizeof(store->onscreen));
+	memset(store->active, 0, sizeof(store->active));
+}
+
+int Entity_Create(ENTITYSTORE* store, ENTITY_TYPE type, const SPRITE* properties)
+{
+	/**************************************************************************
+	*  PreCondition: The store has been cleared at least once
+	* PostCondition: A new entity will be added with the given properties,
+	*                  rows after its batch move up one
+	*   Description: Adds an entity to the end of its behavior's batch
+	*     Algorithm: Make sure there is room
+	*                Open a Row() at the end of its batch, and move the
+	*                  later batches' ends up past it
+	*                Copy each property into its column
+	*                Return the new entity's index
+	**************************************************************************/
+	unsigned char behavior = properties->behavior < BEHAVIOR_COUNT ? properties->behavior : (unsigned char)BEHAVIOR_NONE;
+	int index, later;
+
+	//make sure the store isn't full
+	if(store->count >= ENTITY_CAPACITY)
+		return NO_ENTITY;
+
+	//make room at the end of its batch
+	index = store->batchEnd[behavior];
+	Open_Row(store, index);
+	for(later = behavior; later < BEHAVIOR_COUNT; later++)
+		store->batchEnd[later]++;
+
+	//fill in the columns
+	store->xCoordinate[index] = properties->xCoordinate;
+	store->yCoordinate[index] = properties->yCoordinate;
+	store->xSubpixel[index] = 0;
+	store->ySubpixel[index] = 0;
+	store->xSpeed[index] = properties->xSpeed;
+	store->ySpeed[index] = properties->ySpeed;
+	store->xAcceleration[index] = properties->xAcceleration;
+	store->yAcceleration[index] = properties->yAcceleration;
+	store->width[index] = properties->width;
+	store->height[index] = properties->height;
+	store->type[index] = (unsigned char)type;
+	store->behavior[index] = behavior;
+	store->serial[index] = store->nextSerial++;
+	Entity_Set_Flag(store->faceRight, index, properties->faceRight);
+	Entity_Set_Flag(store->destroyed, index, properties->destroyed);
+	Entity_Set_Flag(store->onscreen, index, properties->onscreen);
+	Entity_Set_Flag(store->active, index, false);
+
+	return index;
+}
+
+void Entity_Move(ENTITYSTORE* store, const ENTITYFIELD* field, int begin, int end)
+{
+	/**************************************************************************
+	*  PreCondition: The store has been filled, begin and end are within it.
+	*                  Ranges moved at the same time start at multiples of
+	*                  64, so no two share a flag word
+	* PostCondition: Every active enemy from begin to end - 1 will have
+	*                  moved the way its behavior flies
+	*   Description: Movement pass, one tight loop per behavior rather than a
+	*                  decision per plane
+	*     Algorithm: For each behavior,
+	*                  Cut the range down to the rows of its batch
+	*                  Run the batch's own mover over them
+	**************************************************************************/
+	int behavior, first = 0, last;
+
+	for(behavior = 0; behavior < BEHAVIOR_COUNT; behavior++)
+	{
+		//the part of the range in this batch
+		last = store->batchEnd[behavior] < end ? store->batchEnd[behavior] : end;
+		if((first > begin ? first : begin) < last)
+			batchMovers[behavior](store, field, first > begin ? first : begin, last);
+		first = store->batchEnd[behavior];
+	}
+}
+
+template<unsigned char MOVES>
+static void Move_Batch(ENTITYSTORE* store, const ENTITYFIELD* field, int begin, int end)
+{
+	/**************************************************************************
+	*  PreCondition: Rows begin to end - 1 are all of a behavior that moves
+	*                  as MOVES says
+	* PostCondition: The active enemies among them will have moved
+	*   Description: The movement loop for one behavior. MOVES is a constant,
+	*                  so the steps a behavior doesn't use are compiled out
+	*                  and the rest are branch-free. Rows that don't move
+	*                  (such as the player's jet) are never written, so other
+	*                  jobs can read them meanwhile
+	*     Algorithm: For each entity,
+	*                  Skip it unless it is an active enemy
+	*                  If it homes in, point its speed at the target's
+	*                    middle on each axis and face that way
+	*                  Add the accelerations to the speeds, then the speeds
+	*                    to the fixed-point positions
+	*                  If it bounces,
+	*                    Note its entrance once it is fully inside on each
+	*                      axis it bounces along
+	*                    Once onscreen, if it has crossed a left or right
+	*                      edge it bounces off, reverse its horizontal speed
+	*                      and turn it around
+	*                    Once onscreen, if it has crossed a top or bottom
+	*                      edge it bounces off, reverse its vertical speed
+	**************************************************************************/
+	int index;
+
+	for(index = begin; index < end; index++)
+	{
+		//only active enemies move, the rest are left untouched
+		if(!Entity_Flag(store->active, index) || !(entityTypeFlags[store->type[index]] & TYPE_ENEMY))
+			continue;
+
+		if(MOVES & HOME_IN)
+		{
+			//-1 if the target is up or to the left, 1 otherwise
+			int towardX = ((field->targetX - store->xCoordinate[index] - store->width[index] / 2) >> 31) | 1;
+			int towardY = ((field->targetY - store->yCoordinate[index] - store->height[index] / 2) >> 31) | 1;
+
+			store->xSpeed[index] = abs(store->xSpeed[index]) * towardX;
+			store->ySpeed[index] = abs(store->ySpeed[index]) * towardY;
+			Entity_Set_Flag(store->faceRight, index, towardX > 0);
+		}
+
+		store->xSpeed[index] += store->xAcceleration[index];
+		store->ySpeed[index] += store->yAcceleration[index];
+		Fixed_Advance(&store->xCoordinate[index], &store->xSubpixel[index], store->xSpeed[index]);
+		Fixed_Advance(&store->yCoordinate[index], &store->ySubpixel[index], store->ySpeed[index]);
+
+		if(MOVES & (BOUNCE_X | BOUNCE_Y))
+		{
+			int left = store->xCoordinate[index], top = store->yCoordinate[index];
+			int right = left + store->width[index], bottom = top + store->height[index];
+			int insideX = !(MOVES & BOUNCE_X) || ((left > 0) & (right < field->width));
+			int insideY = !(MOVES & BOUNCE_Y) || ((top > 0) & (bottom < field->height));
+			int onscreen = Entity_Flag(store->onscreen, index) | (insideX & insideY);
+			int flipX = (MOVES & BOUNCE_X) ? onscreen & ((left < 0) | (right > field->width)) : 0;
+			int flipY = (MOVES & BOUNCE_Y) ? onscreen & ((top < 0) | (bottom > field->height)) : 0;
+
+			//note entrance onscreen, and change direction at the edges
+			Entity_Set_Flag(store->onscreen, index, onscreen != 0);
+			store->xSpeed[index] = (store->xSpeed[index] ^ -flipX) + flipX;
+			store->ySpeed[index] = (store->ySpeed[index] ^ -flipY) + flipY;
+			Entity_Set_Flag(store->faceRight, index, Entity_Flag(store->faceRight, index) != (flipX != 0));
+		}
+	}
+}
+
+void Entity_In_Play(const ENTITYSTORE* store, unsigned char typeFilter, uint64_t* selection)
+{
+	/**************************************************************************
+	*  PreCondition: selection holds ENTITY_FLAG_WORDS words
+	* PostCondition: The bit of every entity of a matching type that is in
+	*                  play will be set, all others cleared
+	*   Description: Builds a selection mask to and with collision results
+	*     Algorithm: For each entity,
+	*                  Set its bit if it hasn't been destroyed and its type
+	*                    matches
+	**************************************************************************/
+	int index;
+
+	memset(selection, 0, ENTITY_FLAG_WORDS * sizeof(uint64_t));
+	for(index = 0; index < store->count; index++)
+	{
+		bool inPlay = !Entity_Flag(store->destroyed, index);
+
+		selection[index >> 6] |= (uint64_t)(inPlay && (entityTypeFlags[store->type[index]] & typeFilter)) <<
+			(index & 63);
+	}
+}
+
+int Entity_Retire(ENTITYSTORE* store, int first)
+{
+	/**************************************************************************
+	*  PreCondition: No pass is running over the store
+	* PostCondition: Destroyed entities from first on will be gone, the rest
+	*                  moved down in the same order, and the number retired
+	*                  returned
+	*   Description: Retirement pass, keeps the store as long as the number
+	*                  of live entities rather than every one ever created
+	*     Algorithm: For each entity from first on,
+	*                  If it has been destroyed, count it against its batch
+	*                    and skip it
+	*                  Otherwise, if a gap has opened, copy each column down
+	*                    to the next free row
+	*                Shorten the store to the rows kept
+	*                Move each batch's end down by the entities retired from
+	*                  it and the batches before it
+	**************************************************************************/
+	int gone[BEHAVIOR_COUNT] = { 0 };
+	int index, kept = first, retired, behavior;
+
+	for(index = first; index < store->count; index++)
+	{
+		if(Entity_Flag(store->destroyed, index))
+		{
+			gone[store->behavior[index]]++;
+			continue;
+		}
+
+		if(kept != index)
+		{
+			store->xCoordinate[kept] = store->xCoordinate[index];
+			store->yCoordinate[kept] = store->yCoordinate[index];
+			store->xSubpixel[kept] = store->xSubpixel[index];
+			store->ySubpixel[kept] = store->ySubpixel[index];
+			store->xSpeed[kept] = store->xSpeed[index];
+			store->ySpeed[kept] = store->ySpeed[index];
+			store->xAcceleration[kept] = store->xAcceleration[index];
+			store->yAcceleration[kept] = store->yAcceleration[index];
+			store->width[kept] = store->width[index];
+			store->height[kept] = store->height[index];
+			store->type[kept] = store->type[index];
+			store->behavior[kept] = store->behavior[index];
+			store->serial[kept] = store->serial[index];
+			Entity_Set_Flag(store->faceRight, kept, Entity_Flag(store->faceRight, index));
+			Entity_Set_Flag(store->destroyed, kept, false);
+			Entity_Set_Flag(store->onscreen, kept, Entity_Flag(store->onscreen, index));
+			Entity_Set_Flag(store->active, kept, Entity_Flag(store->active, index));
+		}
+		kept++;
+	}
+
+	retired = store->count - kept;
+	store->count = kept;
+
+	//close up the batches
+	for(behavior = 1; behavior < BEHAVIOR_COUNT; behavior++)
+		gone[behavior] += gone[behavior - 1];
+	for(behavior = 0; behavior < BEHAVIOR_COUNT; behavior++)
+		store->batchEnd[behavior] -= gone[behavior];
+
+	return retired;
+}
+
+static void Open_Row(ENTITYSTORE* store, int row)
+{
+	/**************************************************************************
+	*  PreCondition: The store has room for one more entity
+	* PostCondition: The store will be one longer, with every entity from row
+	*                  on moved up one and row free to fill in
+	*   Description: Makes room to add an entity inside the store
+	*     Algorithm: Move the tail of each column up one row
+	*                Move the tail of each flag column up one bit, from the
+	*                  top down
+	**************************************************************************/
+	int tail = store->count - row, index;
+
+	memmove(&store->xCoordinate[row + 1], &store->xCoordinate[row], tail * sizeof(int));
+	memmove(&store->yCoordinate[row + 1], &store->yCoordinate[row], tail * sizeof(int));
+	memmove(&store->xSubpixel[row + 1], &store->xSubpixel[row], tail * sizeof(uint16_t));
+	memmove(&store->ySubpixel[row + 1], &store->ySubpixel[row], tail * sizeof(uint16_t));
+	memmove(&store->xSpeed[row + 1], &store->xSpeed[row], tail * sizeof(FIXED));
+	memmove(&store->ySpeed[row + 1], &store->ySpeed[row], tail * sizeof(FIXED));
+	memmove(&store->xAcceleration[row + 1], &store->xAcceleration[row], tail * sizeof(FIXED));
+	memmove(&store->yAcceleration[row + 1], &store->yAcceleration[row], tail * sizeof(FIXED));
+	memmove(&store->width[row + 1], &store->width[row], tail * sizeof(int));
+	memmove(&store->height[row + 1], &store->height[row], tail * sizeof(int));
+	memmove(&store->type[row + 1], &store->type[row], tail);
+	memmove(&store->behavior[row + 1], &store->behavior[row], tail);
+	memmove(&store->serial[row + 1], &store->serial[row], tail * sizeof(unsigned));
+	for(index = store->count; index > row; index--)
+	{
+		Entity_Set_Flag(store->faceRight, index, Entity_Flag(store->faceRight, index - 1));
+		Entity_Set_Flag(store->destroyed, index, Entity_Flag(store->destroyed, index - 1));
+		Entity_Set_Flag(store->onscreen, index, Entity_Flag(store->onscreen, index - 1));
+		Entity_Set_Flag(store->active, index, Entity_Flag(store->active, index - 1));
+	}
+	store->count++;
+}
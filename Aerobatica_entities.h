@@ -0,0 +1,143 @@
+/******************************************************************************
+*        Title: Aerobatica
+* Date Started: April 10th, 2009
+*    Developer: Liam Hagerty
+*       Module: Entity Store Header
+*  Description: This module contains the structure-of-arrays storage that
+*                 holds every plane in the game world. Each
+*                 property lives in its own contiguous column and the
+*                 boolean properties are packed 64 entities to a word.
+*                 Planes that are shot down are retired by closing the gap
+*                 they leave, so the passes only ever visit live planes.
+*
+*                 Planes are kept in one batch per behavior, so movement
+*                 runs a loop specialized for each behavior over its batch
+*                 instead of deciding what to do plane by plane
+*      Version: 1.0
+******************************************************************************/
+#ifndef _ENTITIES_H
+#define _ENTITIES_H 1
+
+#pragma region Include Files
+#include <stdint.h>
+#include "Aerobatica_fixed.h" //Fixed-point motion
+#pragma endregion
+
+#pragma region Constants
+#define ENTITY_CAPACITY 4096 //Most entities one world can hold
+#define ENTITY_FLAG_WORDS (ENTITY_CAPACITY / 64)
+#define NO_ENTITY -1
+
+//Behavior bits shared by every entity of a type
+#define TYPE_ENEMY      0x01 //Can be shot down by the player
+#define TYPE_HAZARD     0x02 //Destroys the player on contact
+#define TYPE_PROJECTILE 0x04 //Lives in the projectile pool
+#define TYPE_SEEKER     0x08 //Steers after the player's jet
+
+//Movement bits of each behavior
+#define BOUNCE_X 0x01 //Turns around at the left and right edges
+#define BOUNCE_Y 0x02 //Turns around at the top and bottom edges
+#define HOME_IN  0x04 //Steers at the target each tick
+#pragma endregion
+
+//Kinds of entity in the world
+typedef enum
+{
+	ENTITY_PLAYER_JET,
+	ENTITY_VULCAN_JET,
+	ENTITY_MISSILE_JET,
+	ENTITY_HELICOPTER,
+	ENTITY_BOMBER,
+	ENTITY_PLAYER_BULLET,
+	ENTITY_ENEMY_BULLET,
+	ENTITY_MISSILE,
+	ENTITY_HOMING_MISSILE,
+	ENTITY_TYPE_COUNT
+} ENTITY_TYPE;
+
+//Movement patterns a plane can fly, whatever its type
+typedef enum
+{
+	BEHAVIOR_NONE,              //Moved by something else (the player's jet)
+	BEHAVIOR_VERTICAL_BOUNCE,   //Up and down between the top and bottom
+	BEHAVIOR_HORIZONTAL_BOUNCE, //Back and forth between the sides
+	BEHAVIOR_DIAGONAL_BOUNCE,   //Off all four edges
+	BEHAVIOR_PATROL,            //The bomber's slow sweep up and down
+	BEHAVIOR_HOMING,            //Chases the player's jet
+	BEHAVIOR_COUNT
+} ENTITY_BEHAVIOR;
+
+//Sprite Structure, a single entity's properties gathered together
+typedef struct
+{
+	int xCoordinate, yCoordinate;
+	FIXED xSpeed, ySpeed;               //16.16 pixels per tick
+	FIXED xAcceleration, yAcceleration; //16.16 pixels per tick per tick
+	int width, height;
+	bool faceRight, destroyed, onscreen;
+	unsigned char behavior;
+} SPRITE;
+
+//Entity Store Structure
+typedef struct
+{
+	int count; //Entities in use, always the lowest indices
+	unsigned nextSerial; //Serial the next entity created gets
+	int batchEnd[BEHAVIOR_COUNT]; //Row after the last of each behavior's batch
+
+	//Kinematic columns, whole pixels with the fraction alongside
+	int xCoordinate[ENTITY_CAPACITY], yCoordinate[ENTITY_CAPACITY];
+	uint16_t xSubpixel[ENTITY_CAPACITY], ySubpixel[ENTITY_CAPACITY];
+	FIXED xSpeed[ENTITY_CAPACITY], ySpeed[ENTITY_CAPACITY];
+	FIXED xAcceleration[ENTITY_CAPACITY], yAcceleration[ENTITY_CAPACITY];
+	int width[ENTITY_CAPACITY], height[ENTITY_CAPACITY];
+	unsigned char type[ENTITY_CAPACITY];
+	unsigned char behavior[ENTITY_CAPACITY];
+	unsigned serial[ENTITY_CAPACITY]; //Rises with creation order within a batch, follows the entity as rows close up
+
+	//Packed flag columns
+	uint64_t faceRight[ENTITY_FLAG_WORDS];
+	uint64_t destroyed[ENTITY_FLAG_WORDS];
+	uint64_t onscreen[ENTITY_FLAG_WORDS];
+	uint64_t active[ENTITY_FLAG_WORDS]; //Moved by the update passes this tick
+} ENTITYSTORE;
+
+//Playfield the planes fly in and the point homing planes steer at
+typedef struct
+{
+	int width, height;
+	int targetX, targetY;
+} ENTITYFIELD;
+
+//Behavior bits of each entity type
+extern const unsigned char entityTypeFlags[ENTITY_TYPE_COUNT];
+
+#pragma region Function Prototypes
+void Entity_Clear(ENTITYSTORE*);
+int Entity_Create(ENTITYSTORE*, ENTITY_TYPE, const SPRITE*);
+void Entity_Move(ENTITYSTORE*, const ENTITYFIELD*, int, int);
+void Entity_In_Play(const ENTITYSTORE*, unsigned char, uint64_t*);
+int Entity_Retire(ENTITYSTORE*, int);
+#pragma endregion
+
+#pragma region Flag Helpers
+inline bool Entity_Flag(const uint64_t* flags, int index)
+{
+	//pick the bit out of its word
+	return ((flags[index >> 6] >> (index & 63)) & 1) != 0;
+}
+
+inline void Entity_Set_Flag(uint64_t* flags, int index, bool value)
+{
+	//clear the bit then or in the new value
+	flags[index >> 6] = (flags[index >> 6] & ~((uint64_t)1 << (index & 63))) |
+		((uint64_t)value << (index & 63));
+}
+
+inline uint64_t Entity_Order(const ENTITYSTORE* store, int index)
+{
+	//rows are in batch order, then creation order within a batch
+	return ((uint64_t)store->behavior[index] << 32) | store->serial[index];
+}
+#pragma endregion
+#endif
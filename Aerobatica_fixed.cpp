@@ -0,0 +1,37 @@
+/******************************************************************************
+*        Title: Aerobatica
+* Date Started: April 10th, 2009
+*    Developer: Liam Hagerty
+*       Module: Fixed-Point Kinematics Code Module
+*  Description: This module contains the column kernels that step fixed-point
+*                 motion
+*      Version: 1.0
+******************************************************************************/
+#pragma region Includes
+#include "Aerobatica_fixed.h" //Fixed-Point Kinematics Definitions Header
+#pragma endregion
+
+void Fixed_Integrate(int* pixel, uint16_t* subpixel, FIXED* velocity,
+					 const FIXED* acceleration, int begin, int end)
+{
+	/**************************************************************************
+	*  PreCondition: The columns hold at least end rows
+	* PostCondition: Each row from begin to end - 1 will have sped up by its
+	*                  acceleration and then moved by its new velocity
+	*   Description: One tick of motion along one axis (semi-implicit Euler,
+	*                  so a body with no acceleration moves exactly its
+	*                  speed)
+	*     Algorithm: For each row,
+	*                  Add the acceleration to the velocity
+	*                  Advance the position by the velocity
+	*                (integers only and no branches, so the loop vectorizes
+	*                  and gives the same result on every machine)
+	**************************************************************************/
+	int row;
+
+	for(row = begin; row < end; row++)
+	{
+		velocity[row] += acceleration[row];
+		Fixed_Advance(&pixel[row], &subpixel[row], velocity[row]);
+	}
+}
@@ -0,0 +1,65 @@
+/******************************************************************************
+*        Title: Aerobatica
+* Date Started: April 10th, 2009
+*    Developer: Liam Hagerty
+*       Module: Fixed-Point Kinematics Header
+*  Description: This module contains the 16.16 fixed-point numbers motion is
+*                 kept in, and the integer-only update kernels that advance
+*                 position by velocity and velocity by acceleration.
+*
+*                 Each axis is a whole-pixel column, which collisions and
+*                 drawing read as they always have, beside a column of
+*                 1/65536ths of a pixel, so speeds and accelerations can be
+*                 fractions of a pixel per tick. Nothing here touches
+*                 floating point or relies on how a compiler shifts negative
+*                 numbers, so every build steps the world the same
+*      Version: 1.0
+******************************************************************************/
+#ifndef _FIXED_H
+#define _FIXED_H 1
+
+#pragma region Include Files
+#include <stdint.h>
+#pragma endregion
+
+#pragma region Constants
+#define FIXED_SHIFT 16
+#define FIXED_ONE (1 << FIXED_SHIFT) //One pixel
+#define FIXED_FRACTION (FIXED_ONE - 1)
+
+//A constant number of pixels (whole, or a fraction with a power of two
+//below it, so it is exact) as 16.16
+#define FIXED_PIXELS(pixels) ((FIXED)((pixels) * FIXED_ONE))
+#pragma endregion
+
+//16.16 fixed-point, pixels or pixels per tick. Positions are kept within
+//32767 pixels of the playfield
+typedef int32_t FIXED;
+
+#pragma region Function Prototypes
+void Fixed_Integrate(int*, uint16_t*, FIXED*, const FIXED*, int, int);
+#pragma endregion
+
+#pragma region Fixed-Point Helpers
+inline int Fixed_Floor(FIXED value)
+{
+	//whole pixels rounded down, without shifting a negative number
+	return value >= 0 ? (int)(value >> FIXED_SHIFT) : (int)~(~value >> FIXED_SHIFT);
+}
+
+inline FIXED Fixed_Join(int pixel, uint16_t subpixel)
+{
+	//the whole pixels and the fraction as one number
+	return (FIXED)(pixel * FIXED_ONE + subpixel);
+}
+
+inline void Fixed_Advance(int* pixel, uint16_t* subpixel, FIXED step)
+{
+	//move a position, splitting it back into pixels and fraction
+	FIXED position = Fixed_Join(*pixel, *subpixel) + step;
+
+	*pixel = Fixed_Floor(position);
+	*subpixel = (uint16_t)(position & FIXED_FRACTION);
+}
+#pragma endregion
+#endif
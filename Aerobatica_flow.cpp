@@ -0,0 +1,103 @@
+/******************************************************************************
+*        Title: Aerobatica
+* Date Started: April 10th, 2009
+*    Developer: Liam Hagerty
+*       Module: Game Flow Code Module
+*  Description: This module contains the routines that start a session on
+*                 its title screen and move it from screen to screen
+*      Version: 1.0
+******************************************************************************/
+#pragma region Includes
+#include "Aerobatica_flow.h" //Game Flow Definitions Header
+#pragma endregion
+
+#pragma region Function Prototypes
+static void Change_Screen(GAMEFLOW*, FLOW_SCREEN);
+#pragma endregion
+
+void Flow_Init(GAMEFLOW* flow, SIMULATION* world, unsigned long seed)
+{
+	/**************************************************************************
+	*  PreCondition: The level, if any, has been chosen with Sim_Use_Level
+	* PostCondition: The world will be set up for the first round, waiting
+	*                  on the title screen
+	*   Description: Starts a session
+	*     Algorithm: Set up the Game World() with the seed
+	*                Save it as the start of every round
+	*                Show the title
+	**************************************************************************/
+	Sim_Init(world, seed);
+	Sim_Save(world, &flow->start);
+
+	flow->seed = seed;
+	flow->rounds = 0;
+	Change_Screen(flow, FLOW_TITLE);
+}
+
+bool Flow_Update(GAMEFLOW* flow, SIMULATION* world, unsigned char events)
+{
+	/**************************************************************************
+	*  PreCondition: Flow_Init has run on the flow and world
+	* PostCondition: The flow will be on the screen the events and the
+	*                  round's outcome lead to, returns true if a new round
+	*                  was just started. The world should be ticked
+	*                  afterwards only if the screen is FLOW_PLAYING
+	*   Description: Runs the flow for one tick, before the world's tick
+	*     Algorithm: Title: confirming restarts
+	*                Playing: a won round shows the victory, a lost one the
+	*                  game over
+	*                Victory or game over: once it has been shown long
+	*                  enough that a key still held from the round can't
+	*                  skip it, confirming restarts
+	*                Restart: put the world back to the start with the next
+	*                  round's seed and play it
+	**************************************************************************/
+	flow->screenTicks++;
+
+	switch(flow->screen)
+	{
+	case FLOW_TITLE:
+		if(events & FLOW_CONFIRM)
+			Change_Screen(flow, FLOW_RESTART);
+		break;
+
+	case FLOW_PLAYING:
+		if(world->status == SIM_VICTORY)
+			Change_Screen(flow, FLOW_VICTORY);
+		else if(world->status == SIM_DEFEAT)
+			Change_Screen(flow, FLOW_GAME_OVER);
+		break;
+
+	case FLOW_VICTORY:
+	case FLOW_GAME_OVER:
+		if((events & FLOW_CONFIRM) && flow->screenTicks > FLOW_RESULT_TICKS)
+			Change_Screen(flow, FLOW_RESTART);
+		break;
+
+	case FLOW_RESTART:
+		break;
+	}
+
+	//the next round starts straight away
+	if(flow->screen == FLOW_RESTART)
+	{
+		Sim_Restart(world, &flow->start, flow->seed + flow->rounds);
+		flow->rounds++;
+		Change_Screen(flow, FLOW_PLAYING);
+		return true;
+	}
+
+	return false;
+}
+
+static void Change_Screen(GAMEFLOW* flow, FLOW_SCREEN screen)
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: The flow will be on the screen, with no ticks spent on it
+	*   Description: Moves to a screen
+	*     Algorithm: Set the screen and clear its tick count
+	**************************************************************************/
+	flow->screen = screen;
+	flow->screenTicks = 0;
+}
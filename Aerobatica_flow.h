@@ -0,0 +1,54 @@
+/******************************************************************************
+*        Title: Aerobatica
+* Date Started: April 10th, 2009
+*    Developer: Liam Hagerty
+*       Module: Game Flow Header
+*  Description: This module contains the screens a session moves through
+*                 (title, playing, victory, game over and restart) and the
+*                 events that move it between them. It is run on the
+*                 simulation thread once a tick and never waits on the
+*                 player, so the frame loop keeps drawing behind every
+*                 screen. A restart puts the world back in place from the
+*                 starting world saved when the session began, with no
+*                 level or texture reloaded
+*      Version: 1.0
+******************************************************************************/
+#ifndef _FLOW_H
+#define _FLOW_H 1
+
+#pragma region Include Files
+#include "Aerobatica_simulation.h" //The world being played
+#pragma endregion
+
+#pragma region Constants
+//Event bits, gathered between ticks
+#define FLOW_CONFIRM 0x01 //Start from the title, play again from a result
+
+#define FLOW_RESULT_TICKS 30 //Ticks a result is shown before it can be dismissed
+#pragma endregion
+
+//Screen the session is on
+typedef enum
+{
+	FLOW_TITLE,
+	FLOW_PLAYING,
+	FLOW_VICTORY,
+	FLOW_GAME_OVER,
+	FLOW_RESTART //Passed through for a tick while the world is reset
+} FLOW_SCREEN;
+
+//Game Flow Structure
+typedef struct
+{
+	FLOW_SCREEN screen;
+	unsigned long screenTicks; //Ticks spent on the current screen
+	unsigned long seed;        //Seed of the first round, each later one adds one
+	unsigned long rounds;      //Rounds started
+	SIMSNAPSHOT start;         //World before the first tick of a round
+} GAMEFLOW;
+
+#pragma region Function Prototypes
+void Flow_Init(GAMEFLOW*, SIMULATION*, unsigned long);
+bool Flow_Update(GAMEFLOW*, SIMULATION*, unsigned char);
+#pragma endregion
+#endif
@@ -3,25 +3,50 @@
 * Date Started: April 10th, 2009
 *    Developer: Liam Hagerty
 *       Module: Game Code Module
-*  Description: This module contains all the game logic and flow procedures
+*  Description: This module contains the game flow, input and rendering
+*                 procedures that connect the Game World to Windows. The
+*                 Game World ticks on a thread of its own and hands each
+*                 result to the window's thread through a triple buffer, so
+*                 a slow frame never holds up a tick and a tick never
+*                 changes a frame half way through drawing it
 *      Version: 1.0
 ******************************************************************************/
 #pragma region Includes
-#include "game.h"        //Game Definitions Header
-#include "musicPlayer.h" //Header for sound implementation
+#include "game.h"              //Game Definitions Header
+#include "musicPlayer.h"       //Header for sound implementation
+#include "Aerobatica_triplebuffer.h" //World snapshots for the window's thread
 #pragma endregion
 
 #pragma region Global Variables
-LPDIRECT3DTEXTURE9 spriteSheetPointer, spriteSheetMirrorPointer;
-SPRITE playerJet, enemyVulcanJet, enemyUnguidedMissileJet, enemyHelicopter;
-SPRITE enemyBomber, playerBullet, enemyBullet, missile, homingMissile;
-long start = GetTickCount();
+LPDIRECT3DTEXTURE9 spriteSheetPointer;
+SIMULATION gameWorld;     //Only the simulation thread touches it
+GAMEFLOW gameFlow;        //Screens the session moves through, simulation thread only
+long long lastStep;       //Clock reading when the simulation last stepped
+std::atomic<int> shownScreen;       //FLOW_SCREEN after the latest tick
+std::atomic<bool> simRunning;
+std::thread simThread;
 LPD3DXSPRITE spriteHandlerPointer;
+LPD3DXFONT screenFontPointer;
 LPDIRECT3DSURFACE9 backgroundPointer;
 HRESULT resultHandle;
 extern LPDIRECT3DDEVICE9 direct3DDevicePointer;
 extern LPDIRECT3DSURFACE9 backbufferPointer;
 MUSICPLAYER gameMusic;
+MIXER gameMixer;         //Sound effects, played from the simulation thread
+PARTICLESYSTEM gameParticles; //Burst from the simulation thread, run on the window's
+PARTICLEBATCH particleBatch;
+long long lastParticleStep;   //Clock reading when the particles last stepped
+INPUTSAMPLER gameInput;       //Keyboard changes, stamped on a thread of their own
+INPUTPOLLED keyboardInput;
+RENDERQUEUE renderQueue;
+RENDERHISTORY renderHistory;
+JOBSYSTEM gameJobs;      //Owned by the simulation thread
+INPUTLOG sessionLog;
+LEVEL gameLevel;         //Mapped level file, if there is one
+TRIPLEBUFFER snapshots;
+WORLDSNAPSHOT snapshotSlots[3];
+const char* soundFiles[SOUND_COUNT] = //Recordings used over the built-in effects
+	{ "player shot.wav", "enemy shot.wav", "missile.wav", "explosion.wav", "player hit.wav" };
 #pragma endregion
 
 int Game_Init(HWND windowHandle)
@@ -30,18 +55,30 @@ int Game_Init(HWND windowHandle)
 	*  PreCondition: The window has been set up correctly
 	* PostCondition: The start-up game settings will be initialized
 	*   Description: Initializes the game
-	*     Algorithm: Seed the Random Number Generator
+	*     Algorithm: Pick the round's seed
 	*                Initialize the Keyboard
 	*                Create the Sprite Handler object
 	*                Load the Sprites' Textures()
 	*                Load the Background
-	*                Set the default Sprites' Properties()
+	*                Create the font for the screens' text
+	*                Map the level file, playing the built-in level without it
+	*                Start the session's flow, which sets up the Game World()
+	*                  with the seed and waits on the title screen
+	*                Publish the starting world for the first frame
+	*                Make the sound effects, loading any recordings there
+	*                  are over them, and start the mixer
+	*                Set up the particles
+	*                Start sampling the keyboard
+	*                Start the simulation thread
 	*                Show the instructions
 	*                Load and play the Music
 	**************************************************************************/
 
-	//set random number seed
-	srand(time(NULL));	
+	//pick the first round's seed, the Game World draws its random numbers
+	//from it
+	unsigned long seed = (unsigned long)time(NULL);
+	int sound;
+	INPUTSOURCE source;
 
 	//Initialize Keyboard
 	if (!Init_Keyboard(windowHandle))
@@ -64,8 +101,50 @@ int Game_Init(HWND windowHandle)
 	//load the background
 	backgroundPointer = LoadSurface("sky9.jpg",D3DCOLOR_XRGB(255,0,255));
 
-	//Set the default data for the sprites
-	Set_Sprites_Properties();
+	//the title and result screens write over the world
+	resultHandle = D3DXCreateFont(direct3DDevicePointer, SCREEN_FONT_HEIGHT, 0, FW_BOLD, 1, FALSE,
+		DEFAULT_CHARSET, OUT_DEFAULT_PRECIS, DEFAULT_QUALITY, DEFAULT_PITCH | FF_DONTCARE, "Arial",
+		&screenFontPointer);
+	if (resultHandle != D3D_OK)
+		return 0;
+
+	//the level is used straight from the mapped file
+	if(Level_Open(&gameLevel, LEVEL_FILE))
+		Sim_Use_Level(&gameLevel);
+
+	//Set the default data for the game world, kept for every round
+	Flow_Init(&gameFlow, &gameWorld, seed);
+
+	//the first frame draws the starting world
+	lastStep = Timer_Microseconds();
+	Render_Capture(&renderHistory, &gameWorld);
+	Triple_Init(&snapshots, snapshotSlots, sizeof(WORLDSNAPSHOT));
+	Render_Snapshot((WORLDSNAPSHOT*)Triple_Back(&snapshots), &gameWorld, &renderHistory, lastStep);
+	Triple_Publish(&snapshots);
+	shownScreen.store(gameFlow.screen);
+
+	//the effects are all in memory before play starts, the game plays on
+	//silently if the sound card can't be opened
+	if(!Mixer_Init(&gameMixer))
+		return 0;
+	for(sound = 0; sound < SOUND_COUNT; sound++)
+		Mixer_Load(&gameMixer, (SOUND_ID)sound, soundFiles[sound]);
+	if(!Mixer_Start(&gameMixer, MIXER_OUTPUT_DEVICE, NULL))
+		Mixer_Start(&gameMixer, MIXER_OUTPUT_NULL, NULL);
+
+	//explosions and exhaust, seeded apart from the world
+	Particles_Init(&gameParticles, seed);
+	lastParticleStep = Timer_Microseconds();
+
+	//stamp every change of the keys from here on, the ticks take them
+	//by when they happened
+	Input_Polled_Source(&source, &keyboardInput, Poll_Controls);
+	Input_Init(&gameInput, &source);
+	Input_Start(&gameInput);
+
+	//tick from here on
+	simRunning.store(true);
+	simThread = std::thread(Run_Simulation);
 
 	//Initialize the sound handler
 	gameMusic.MPInit();
@@ -85,60 +164,30 @@ void Game_Run(HWND windowHandle)
 	/**************************************************************************
 	*  PreCondition: The Game_Init function has run successfully
 	* PostCondition: All steps will be performed to keep the game properly updated
-	*   Description: Main Game Loop
+	*   Description: Main Game Loop, on the window's thread. The Game World
+	*                  ticks on its own thread meanwhile
 	*     Algorithm: Make sure the Direct 3D Device is still valid
-	*                Determine if significant delay has passed (maintain frame rate)
-	*                  Reset framerate timer
-	*                  Check if the player has won
-	*                  Check if the player has lost
-	*                  Move the enemy planes
-	*                  Move all the discharged firearms
-	*                  Check for hit enemies
-	*                Check for input()
-	*                Draw the next frame on the Backbuffer(Rendering)
+	*                Check for input() to leave the game
+	*                Pick up the latest snapshot of the Game World
+	*                Draw the snapshot on the Backbuffer(Rendering), part
+	*                  way between its last two ticks
+	*                Draw the explosions and exhaust over the sprites
+	*                Draw the current screen's text over it
 	*                Copy the Backbuffer to the screen
-	**************************************************************************/		
+	**************************************************************************/
+	const WORLDSNAPSHOT* snapshot;
 
 	//make sure the Direct3D Device is valid
 	if (direct3DDevicePointer == NULL)
-		return;	
-
-	//after short delay, ready for next frame?
-	//this keeps the game running at a steady frame rate
-	if(GetTickCount() - start >= 30)
-	{
-		//reset timing
-		start = GetTickCount();		
-
-		//Check Victory Condition
-		if(enemyBomber.destroyed)
-		{
-			//Congratulate the player then tell Windows to end the program
-			MessageBox(windowHandle,"Congratulations, you have cleared the skies!","Victory!",MB_OK);
-			PostMessage(windowHandle, WM_DESTROY, 0, 0);
-		}
-
-		//Check Loss Conditions
-		if(Check_Loss())
-		{
-			//Inform the player of their defeat and tell Windows to end the program
-			MessageBox(windowHandle,"You have been shot down. Better luck next time!","Game Over",MB_OK);
-			PostMessage(windowHandle, WM_DESTROY, 0, 0);
-		}
+		return;
 
-		//Move the enemy planes
-		Move_Enemies();
-
-		//move the bullets and missiles
-		Move_Weaponry();
-
-		//Check for enemy planes being shot down
-		Check_Scoring();
-	}
-
-	//Check for keyboard input
+	//Check for the Escape Key, the controls go straight to the simulation
 	Check_Input(windowHandle);
 
+	//draw whatever the simulation published last
+	Triple_Update(&snapshots);
+	snapshot = (const WORLDSNAPSHOT*)Triple_Front(&snapshots);
+
 	//start rendering
 	if(direct3DDevicePointer->BeginScene())
 	{
@@ -150,7 +199,13 @@ void Game_Run(HWND windowHandle)
 		spriteHandlerPointer->Begin(D3DXSPRITE_ALPHABLEND);
 
 		//Draw the Sprites
-		Draw_Sprites();
+		Draw_Sprites(snapshot);
+
+		//the effects over them
+		Draw_Particles(snapshot);
+
+		//and the title or the outcome over them
+		Draw_Screen((FLOW_SCREEN)shownScreen.load());
 
 		//stop drawing
 		spriteHandlerPointer->End();
@@ -160,7 +215,108 @@ void Game_Run(HWND windowHandle)
 	}
 
 	//display the back buffer on the screen
-	direct3DDevicePointer->Present(NULL, NULL, NULL, NULL);
+	{
+		PROFILE_SCOPE("Present");
+		direct3DDevicePointer->Present(NULL, NULL, NULL, NULL);
+	}
+
+	//the frame is over
+	PROFILE_FRAME();
+}
+
+void Run_Simulation()
+{
+	/**************************************************************************
+	*  PreCondition: Game_Init has set up the Game World and published it
+	* PostCondition: The Game World will have ticked until Game_End stopped
+	*                  the thread
+	*   Description: Body of the simulation thread, which owns the Game World,
+	*                  the game flow, the job system and the session log
+	*     Algorithm: Start the job system and split large ticks across it
+	*                Until told to stop,
+	*                  For each fixed 30 ms tick due on the high-resolution
+	*                    clock (a steady pace whatever the frame rate),
+	*                    Take the keys changed before the tick ended
+	*                    Update the game flow with the screen events
+	*                    If a round just started, log it from the start
+	*                    If a round is being played, step the Game World
+	*                      and log the tick's input and resulting state
+	*                  If anything ticked, publish a snapshot and the screen
+	*                    for the window
+	*                  Sleep until the next tick is due
+	*                Stop the job system
+	**************************************************************************/
+	long long now, elapsed, banked;
+	int ticksDue, ticked;
+	SIM_INPUT buttons, input;
+
+	//one worker per core besides this one and the window's
+	Jobs_Init(&gameJobs, Jobs_Default_Workers() - 1);
+	Sim_Use_Jobs(&gameJobs);
+
+	while(simRunning.load())
+	{
+		//time the step, a long stall only ever costs the catch-up limit
+		now = Timer_Microseconds();
+		elapsed = now - lastStep;
+		lastStep = now;
+		if(elapsed > SIM_MAX_CATCHUP_TICKS * SIM_TICK_US)
+			elapsed = SIM_MAX_CATCHUP_TICKS * SIM_TICK_US;
+
+		//advance the world by every whole tick that has elapsed
+		ticksDue = Sim_Bank(&gameWorld, (int)elapsed);
+		ticked = ticksDue;
+		banked = now - gameWorld.accumulator; //When the last tick due ended
+		while(ticksDue-- > 0)
+		{
+			//each tick takes exactly the keys changed before it ended, so a
+			//tap between frames still lands in the tick it happened in
+			buttons = Input_For_Tick(&gameInput, banked - ticksDue * SIM_TICK_US);
+			input = buttons & INPUT_CONTROLS;
+
+			//move between screens, the start of a round is logged afresh so
+			//the latest one can be replayed (the game plays on without a log
+			//if the file can't be created)
+			if(Flow_Update(&gameFlow, &gameWorld, (buttons & INPUT_CONFIRM) ? FLOW_CONFIRM : 0))
+			{
+				if(sessionLog.file != NULL)
+					Replay_Finish(&sessionLog);
+				Replay_Create(&sessionLog, SESSION_LOG, gameWorld.seed, REPLAY_HASHES);
+			}
+
+			//the frame is drawn between the last two ticks
+			if(ticksDue == 0)
+				Render_Capture(&renderHistory, &gameWorld);
+
+			//the world waits behind the title and the results
+			if(gameFlow.screen != FLOW_PLAYING)
+				continue;
+
+			Sim_Tick(&gameWorld, input);
+			Mixer_Play_Events(&gameMixer, &gameWorld);
+			Particles_Burst_Blasts(&gameParticles, &gameWorld);
+			if(sessionLog.file != NULL)
+			{
+				PROFILE_SCOPE("Replay_Write");
+				Replay_Write(&sessionLog, input, Sim_Hash(&gameWorld));
+			}
+		}
+
+		//hand the result to the window's thread
+		if(ticked > 0)
+		{
+			Render_Snapshot((WORLDSNAPSHOT*)Triple_Back(&snapshots), &gameWorld, &renderHistory, now);
+			Triple_Publish(&snapshots);
+			shownScreen.store(gameFlow.screen);
+		}
+
+		//wait out the rest of the tick
+		std::this_thread::sleep_for(std::chrono::microseconds(SIM_TICK_US - gameWorld.accumulator));
+	}
+
+	//stop the workers
+	Sim_Use_Jobs(NULL);
+	Jobs_Shutdown(&gameJobs);
 }
 
 void Game_End(HWND windowHandle)
@@ -169,125 +325,131 @@ void Game_End(HWND windowHandle)
 	*  PreCondition: The Game Loop has finished
 	* PostCondition: All resources will be freed for future use
 	*   Description: This function performs all post-game clean-up
-	*     Algorithm: Free the Surface
+	*     Algorithm: Free the Sprite Sheet
 	*                Free the Background
+	*                Free the Font
 	*                Free the Sprite Handler
 	*                Free the Sound Effects
+	*                Stop the simulation thread
+	*                Stop sampling the keyboard
+	*                Stop the mixer and free the sound effects
+	*                Finish the session log
+	*                Unmap the level file
+	*                Write out the phase timings, in profiling builds
 	**************************************************************************/
 
-	//free the surfaces
-	spriteSheetPointer->Release();
-	spriteSheetMirrorPointer->Release();
+	//free the sprite sheet
+	if(spriteSheetPointer != NULL)
+		spriteSheetPointer->Release();
 
 	//free the background
 	if(backgroundPointer != NULL)
 		backgroundPointer->Release();
 
+	//free the font
+	if(screenFontPointer != NULL)
+		screenFontPointer->Release();
+
 	//free the sprite handler
 	if(spriteHandlerPointer != NULL)
 		spriteHandlerPointer->Release();
 
 	//free the sound file
 	gameMusic.MPRelease();
+
+	//let the current step finish, then stop ticking
+	simRunning.store(false);
+	if(simThread.joinable())
+		simThread.join();
+
+	//nothing takes the keys any more
+	Input_Stop(&gameInput);
+
+	//nothing plays sounds any more
+	Mixer_Stop(&gameMixer);
+	Mixer_Release(&gameMixer);
+
+	//write out the rest of the session log
+	if(sessionLog.file != NULL)
+		Replay_Finish(&sessionLog);
+
+	//nothing draws from the level any more
+	if(gameLevel.view != NULL)
+	{
+		Sim_Use_Level(NULL);
+		Level_Close(&gameLevel);
+	}
+
+#ifdef AEROBATICA_PROFILE
+	//write out the timings
+	FILE* report = fopen(PROFILE_REPORT_FILE, "w");
+	if(report != NULL)
+	{
+		PROFILE_REPORT(report);
+		fclose(report);
+	}
+	PROFILE_WRITE_TRACE(PROFILE_TRACE_FILE);
+#endif
 }
 
 void Check_Input(HWND windowHandle)
 {
 	/**************************************************************************
-	*  PreCondition: The game loop is running
-	* PostCondition: Keyboard presses will be checked and updated
-	*   Description: This function handles all actions associated with the keyboard
-	*     Algorithm: Update the keyboard state
-	*                If the Left Arrow is pressed,
-	*                  face the jet left and move left, though not offscreen
-	*                Else If the Right Arrow is pressed,
-	*                  face the jet right and move right, though not offscreen
-	*                If the Up Arrow is pressed,
-	*                  move the jet up, though not offscreen
-	*                Else If the Down Arrow is pressed,
-	*                  move the jet down, though not offscreen
-	*                If the Spacebar is pressed,
-	*                  Fire the bullet from the front of the jet if one is not present
-	*                If the Escape Key is pressed,
+	*  PreCondition: The game loop is running and the keyboard is being sampled
+	* PostCondition: The game will be ending if the Escape Key is held
+	*   Description: This function checks the latest keys the sampler saw for
+	*                  the way out, on the window's thread
+	*     Algorithm: If the Escape Key is pressed,
 	*                  end the game and application
 	**************************************************************************/
+	PROFILE_SCOPE("Check_Input");
+
+	//check for escape key to exit program
+	if(Input_Latest(&gameInput) & INPUT_QUIT)
+		PostMessage(windowHandle, WM_DESTROY, 0, 0); //End the program
+}
+
+SIM_INPUT Poll_Controls()
+{
+	/**************************************************************************
+	*  PreCondition: The keyboard was initialized
+	* PostCondition: The keys held now will be returned as buttons
+	*   Description: This function reads the keyboard into the buttons the
+	*                  input sampler stamps, on the sampler's thread
+	*     Algorithm: Update the keyboard state
+	*                Note each held Arrow key
+	*                Note if the Spacebar is held
+	*                Note if the Enter Key is held, for the game flow
+	*                Note if the Escape Key is held, to leave
+	**************************************************************************/
+	SIM_INPUT input = 0;
+
 	//update the keyboard
 	Poll_Keyboard();
 
-	//check for left arrow
+	//check for the arrows
 	if(Key_Down(DIK_LEFT))
-	{
-		//Check if the player is trying to go offscreen
-		if(playerJet.xCoordinate > 0)
-			playerJet.xCoordinate -= playerJet.xSpeed; //Move left
-		//Face the player left
-		playerJet.faceRight = false;		
-	}
-	//check for right arrow
-	else 		
-		if(Key_Down(DIK_RIGHT))
-		{
-			//Check if player is trying to go offscreen
-			if(playerJet.xCoordinate + playerJet.width < 1000)
-				playerJet.xCoordinate += playerJet.xSpeed; //Move right
-			//Face the player right
-			playerJet.faceRight = true;				
-		}
-	
-	//check for up arrow
+		input |= INPUT_LEFT;
+	if(Key_Down(DIK_RIGHT))
+		input |= INPUT_RIGHT;
 	if(Key_Down(DIK_UP))
-	{
-		//Check if the player is trying to go offscreen
-		if(playerJet.yCoordinate > 0)
-			playerJet.yCoordinate -= playerJet.ySpeed; //Move up	
-	}
-	//check for down arrow
-	else 
-	{
-		if(Key_Down(DIK_DOWN))	
-			//Check if the player is trying to go offscreen
-			if(playerJet.yCoordinate + playerJet.height < 700)
-				playerJet.yCoordinate += playerJet.ySpeed;	//Move down
-	}
+		input |= INPUT_UP;
+	if(Key_Down(DIK_DOWN))
+		input |= INPUT_DOWN;
 
 	//check for Space Bar
 	if(Key_Down(DIK_SPACE))
-	{
-		//Make sure the player is not reloading
-		if(!playerBullet.onscreen)
-		{
-			//Fire the bullet from the jet front
-			if(playerJet.faceRight)
-			{
-				//Put the bullet ahead of the player and face it right
-				playerBullet.xCoordinate = playerJet.xCoordinate + playerJet.width + 5;
-				playerBullet.faceRight = true;
+		input |= INPUT_FIRE;
 
-				//If the previous bullet's vector is backwards, fix it
-				if(playerBullet.xSpeed < 0)
-					playerBullet.xSpeed = -playerBullet.xSpeed;
-			}
-			//Bullet will travel left
-			else
-			{
-				//Put the bullet ahead of the player and face it left
-				playerBullet.xCoordinate = playerJet.xCoordinate - 5;
-				playerBullet.faceRight = false;
+	//check for Enter to start or play again
+	if(Key_Down(DIK_RETURN))
+		input |= INPUT_CONFIRM;
 
-				//If the previous bullet's vector is backwards, fix it
-				if(playerBullet.xSpeed > 0)
-					playerBullet.xSpeed = -playerBullet.xSpeed;
-			}
-
-			//Fire the bullet from the jet center
-			playerBullet.yCoordinate = playerJet.yCoordinate + playerJet.height / 2;
-			playerBullet.onscreen = true;
-		}
-	}
+	//check for the escape key, the window's thread ends the program
+	if(Key_Down(DIK_ESCAPE))
+		input |= INPUT_QUIT;
 
-	//check for escape key to exit program
-	if (Key_Down(DIK_ESCAPE))
-		PostMessage(windowHandle, WM_DESTROY, 0, 0); //End the program
+	return input;
 }
 
 bool Load_Animations()
@@ -297,529 +459,151 @@ bool Load_Animations()
 	* PostCondition: The skins associated with the game sprites will be loaded
 	*   Description: This function loads and partitions the sprite sheet for
 	*                  each of the game's sprites
-	*     Algorithm: Load the normal sprite sheet
-	*                Make sure the sheet loaded correctly
-	*                Load the mirrored sprite sheet
+	*     Algorithm: Load the sprite sheet
 	*                Make sure the sheet loaded correctly
+	*                (left-facing sprites are flipped when drawn, so there is
+	*                  no mirrored copy to load)
 	**************************************************************************/
-	//load the normal sprite animations
+	//load the sprite animations
 	spriteSheetPointer = LoadTexture("sprite sheet copy.jpg",D3DCOLOR_XRGB(255,255,255));
 
 	//make sure the sprite animations were loaded successfully
 	if (spriteSheetPointer == NULL)
 		return false;
 
-	//load the mirrored sprite animations
-	spriteSheetMirrorPointer = LoadTexture("sprite sheet copy mirror.jpg",
-		D3DCOLOR_XRGB(255,255,255));
-
-	//make sure the mirrored sprite animations were loaded correctly
-	if (spriteSheetMirrorPointer == NULL)
-		return false;
-
 	//everything loaded fine
 	return true;
 }
 
-void Set_Sprites_Properties()
-{
-	/**************************************************************************
-	*  PreCondition: The Direct 3D Device is valid
-	* PostCondition: The default properties of the game sprites will be set
-	*   Description: This function sets all the default properties of the sprites
-	*     Algorithm: Set the Player Sprite's properties
-	*                Set the Player Bullet Sprite's properties
-	*                Set the Vulcan Enemy Sprite's properties
-	*                Set the Enemy Bullet Sprite's properties
-	*                Set the Missile Enemy Sprite's properties
-	*                Set the Missile Sprite's properties
-	*                Set the Homing Missile Sprite's properties
-	*                Set the Helicopter Enemy Sprite's properties
-	*                Set the Bomber Enemy Sprite's properties
-	**************************************************************************/
-	//initialize the player sprite's properties
-	playerJet.xCoordinate = 100;
-	playerJet.yCoordinate = 350;
-	playerJet.xSpeed = 5;
-	playerJet.ySpeed = 5;
-	playerJet.width = 126;
-	playerJet.height = 47;
-	playerJet.faceRight = true;
-	playerJet.destroyed = false;
-	playerJet.onscreen = true;
-
-	//initialize the player's bullet sprite properties
-	playerBullet.xCoordinate = -200;
-	playerBullet.yCoordinate = -200;
-	playerBullet.xSpeed = 50;
-	playerBullet.ySpeed = 0;
-	playerBullet.width = 317;
-	playerBullet.height = 36;
-	playerBullet.faceRight = true;
-	playerBullet.destroyed = false;
-	playerBullet.onscreen = false;
-
-	//initialize the enemy vulcan jet sprite's properties
-	enemyVulcanJet.xCoordinate = 700;
-	enemyVulcanJet.yCoordinate = -100;
-	enemyVulcanJet.xSpeed = 0;
-	enemyVulcanJet.ySpeed = 5;
-	enemyVulcanJet.width = 140;
-	enemyVulcanJet.height = 33;
-	enemyVulcanJet.faceRight = false;
-	enemyVulcanJet.destroyed = false;
-	enemyVulcanJet.onscreen = false;
-
-	//initialize the enemy's bullet sprite properties
-	enemyBullet.xCoordinate = 1200;
-	enemyBullet.yCoordinate = 900;
-	enemyBullet.xSpeed = 5;
-	enemyBullet.ySpeed = 0;
-	enemyBullet.width = 317;
-	enemyBullet.height = 36;
-	enemyBullet.faceRight = false;
-	enemyBullet.destroyed = false;
-	enemyBullet.onscreen = false;
-
-	//initialize the enemy missile jet sprite's properties
-	enemyUnguidedMissileJet.xCoordinate = 1100;
-	enemyUnguidedMissileJet.yCoordinate = 600;
-	enemyUnguidedMissileJet.xSpeed = -5;
-	enemyUnguidedMissileJet.ySpeed = 0;
-	enemyUnguidedMissileJet.width = 128;
-	enemyUnguidedMissileJet.height = 32;
-	enemyUnguidedMissileJet.faceRight = false;
-	enemyUnguidedMissileJet.destroyed = false;
-	enemyUnguidedMissileJet.onscreen = false;
-
-	//initialize the missile sprite's properties
-	missile.xCoordinate = 1500;
-	missile.yCoordinate = 1000;
-	missile.xSpeed = -5;
-	missile.ySpeed = 0;
-	missile.width = 509;
-	missile.height = 40;
-	missile.faceRight = false;
-	missile.destroyed = false;
-	missile.onscreen = false;
-
-	//initialize the homing missile sprite's properties
-	homingMissile.xCoordinate = 1300;
-	homingMissile.yCoordinate = 500;
-	homingMissile.xSpeed = 5;
-	homingMissile.ySpeed = 5;
-	homingMissile.width = 509;
-	homingMissile.height = 40;
-	homingMissile.faceRight = false;
-	homingMissile.destroyed = false;
-	homingMissile.onscreen = false;
-
-	//initialize the enemy helicopter sprites's properties
-	enemyHelicopter.xCoordinate = -200;
-	enemyHelicopter.yCoordinate = 200;
-	enemyHelicopter.xSpeed = 5;
-	enemyHelicopter.ySpeed = 5;
-	enemyHelicopter.width = 144;
-	enemyHelicopter.height = 41;
-	enemyHelicopter.faceRight = true;
-	enemyHelicopter.destroyed = false;
-	enemyHelicopter.onscreen = false;
-
-	//initialize the enemy bomber sprite's properties
-	enemyBomber.xCoordinate = 500;
-	enemyBomber.yCoordinate = 800;
-	enemyBomber.xSpeed = 0;
-	enemyBomber.ySpeed = -5;
-	enemyBomber.width = 309;
-	enemyBomber.height = 98;
-	enemyBomber.faceRight = false;
-	enemyBomber.destroyed = false;
-	enemyBomber.onscreen = false;
-}
-
-void Draw_Sprites()
+void Draw_Sprites(const WORLDSNAPSHOT* snapshot)
 {
 	/**************************************************************************
 	*  PreCondition: Direct 3D was initialized correctly
 	* PostCondition: The desired sprites will be drawn to the backbuffer
 	*   Description: This function draws the game sprites to the backbuffer
-	*     Algorithm: Get the positions of the sprites
-	*                Create and initialize Drawing Rectangles for the Sprites
-	*                If the sprite is facing right, use normal sprite sheet
-	*                Else, use the mirrored sprite sheet for drawing
-	**************************************************************************/
-	//Create the vectors to update sprite positions
-	D3DXVECTOR3 playerPosition((float)playerJet.xCoordinate, (float)playerJet.yCoordinate, 0);
-	D3DXVECTOR3 enemyVulcanPosition((float)enemyVulcanJet.xCoordinate, (float)enemyVulcanJet.yCoordinate, 0);
-	D3DXVECTOR3 enemyMissilePosition((float)enemyUnguidedMissileJet.xCoordinate,
-		(float)enemyUnguidedMissileJet.yCoordinate, 0);
-	D3DXVECTOR3 enemyHelicopterPosition((float)enemyHelicopter.xCoordinate, (float)enemyHelicopter.yCoordinate, 0);
-	D3DXVECTOR3 enemyBomberPosition((float)enemyBomber.xCoordinate, (float)enemyBomber.yCoordinate, 0);
-	D3DXVECTOR3 playerBulletPosition((float)playerBullet.xCoordinate, (float)playerBullet.yCoordinate, 0);
-	D3DXVECTOR3 enemyBulletPosition((float)enemyBullet.xCoordinate, (float)enemyBullet.yCoordinate, 0);
-
-	//Create the drawing rectangles for the sprites
-	RECT playerRectangle, enemyVulcanRectangle, enemyMissileRectangle;
-	RECT enemyHelicopterRectangle, enemyBomberRectangle, playerBulletRectangle;
-	RECT enemyBulletRectangle;
-
-	//Initialize the rectangles
-	ZeroMemory(&playerRectangle, sizeof(playerRectangle));
-	ZeroMemory(&enemyVulcanRectangle, sizeof(enemyVulcanRectangle));
-	ZeroMemory(&enemyMissileRectangle, sizeof(enemyMissileRectangle));
-	ZeroMemory(&enemyHelicopterRectangle, sizeof(enemyHelicopterRectangle));
-	ZeroMemory(&enemyBomberRectangle, sizeof(enemyBomberRectangle));
-	ZeroMemory(&playerBulletRectangle, sizeof(playerBulletRectangle));
-	ZeroMemory(&enemyBulletRectangle, sizeof(enemyBulletRectangle));
-
-	//configure and draw the player rectangle
-	if(playerJet.faceRight)
-		Draw_To_Backbuffer(playerJet, playerRectangle, playerPosition, 22, 33, 144, 76);
-	else
-		Draw_To_Backbuffer(playerJet, playerRectangle, playerPosition, 1855, 33, 1975, 76);
-
-	//configure and draw the Vulcan Jet rectangle
-	if(!enemyVulcanJet.destroyed)
-		if(enemyVulcanJet.faceRight)
-			Draw_To_Backbuffer(enemyVulcanJet, enemyVulcanRectangle, enemyVulcanPosition, 36, 526, 174, 557);
-		else
-			Draw_To_Backbuffer(enemyVulcanJet, enemyVulcanRectangle, enemyVulcanPosition, 1825, 526, 1961, 557);
-	else
-		enemyVulcanJet.xCoordinate = -500;
-
-	//configure and draw the Missile Jet rectangle
-	if(!enemyUnguidedMissileJet.destroyed)
-		if(enemyUnguidedMissileJet.faceRight)
-			Draw_To_Backbuffer(enemyUnguidedMissileJet, enemyMissileRectangle, enemyMissilePosition, 38, 782, 165, 812);
-		else
-			Draw_To_Backbuffer(enemyUnguidedMissileJet, enemyMissileRectangle, enemyMissilePosition, 1834, 782, 1960, 812);
-	else
-		enemyUnguidedMissileJet.xCoordinate = -500;
-
-	//configure and draw the Helicopter rectangle
-	if(!enemyHelicopter.destroyed)
-		if(enemyHelicopter.faceRight)
-			Draw_To_Backbuffer(enemyHelicopter, enemyHelicopterRectangle, enemyHelicopterPosition, 29, 1078, 170, 1120);
-		else
-			Draw_To_Backbuffer(enemyHelicopter, enemyHelicopterRectangle, enemyHelicopterPosition, 1825, 1078, 1969, 1120);
-	else
-		enemyHelicopter.xCoordinate = -500;
-
-	//configure and draw the Bomber rectangle	
-	if(enemyBomber.faceRight)
-		Draw_To_Backbuffer(enemyBomber, enemyBomberRectangle, enemyBomberPosition, 0, 249, 335, 345);
-	else
-		Draw_To_Backbuffer(enemyBomber, enemyBomberRectangle, enemyBomberPosition, 1663, 249, 2000, 345);
-
-	//Configure and draw the player bullet rectangle
-	if(playerBullet.faceRight)
-		Draw_To_Backbuffer(playerBullet, playerBulletRectangle, playerBulletPosition, 584, 307, 945, 343);
-	else
-		Draw_To_Backbuffer(playerBullet, playerBulletRectangle, playerBulletPosition, 1053, 307, 1379, 343);
-
-	//Configure and draw the enemy bullet rectangle
-	if(enemyBullet.faceRight)
-		Draw_To_Backbuffer(enemyBullet, enemyBulletRectangle, enemyBulletPosition, 584, 307, 945, 343);
-	else
-		Draw_To_Backbuffer(enemyBullet, enemyBulletRectangle, enemyBulletPosition, 1053, 307, 1379, 343);
-}
-
-void Draw_To_Backbuffer(SPRITE entity, RECT spriteRectangle, D3DXVECTOR3 position,
-						long leftX, long topY, long rightX, long bottomY)
-{
-	/**************************************************************************
-	*  PreCondition: WINAPI has been initialized
-	* PostCondition: The sprite will be drawn to the backbuffer
-	*   Description: This function sets the coordinates for the image source of
-	*                  a sprite from a sheet and then draws them to the backbuffer
-	*     Algorithm: Set the left-most x coordinate
-	*                Set the top-most y coordinate
-	*                Set the right-most x coordinate
-	*                Set the bottom-most y coordinate
-	*                If the sprite is facing right, use the normal sprite sheet
-	*                Else use the mirrored sprite sheet for drawing
-	**************************************************************************/	
-
-	//Set the rectangle parameters for the source file
-	spriteRectangle.left = leftX;
-	spriteRectangle.top = topY;
-	spriteRectangle.right = rightX;
-	spriteRectangle.bottom = bottomY;
-
-	//draw the sprite
-	if(entity.faceRight)
-		spriteHandlerPointer->Draw(spriteSheetPointer, &spriteRectangle, NULL,
-			&position, D3DCOLOR_XRGB(255,255,255));
-	else
-		spriteHandlerPointer->Draw(spriteSheetMirrorPointer, &spriteRectangle, NULL,
-			&position, D3DCOLOR_XRGB(255,255,255));
-}
-
-int Check_Collision(SPRITE Sprite1, SPRITE Sprite2)
-{
-	/**************************************************************************
-	*  PreCondition: The Sprites have been initialized
-	* PostCondition: It will be determined if two Sprites are colliding
-	*   Description: This function determines if two sprites are colliding
-	*     Algorithm: Load the first Sprite's coordinates into a RECT
-	*                Load the second Sprite's coordinates into a RECT
-	*                Call IntersectRect() to determine collision validity
+	*     Algorithm: Have the snapshot queue a draw record per sprite, placed
+	*                  as far between its last two ticks as the clock is
+	*                Put the flipped records after the unflipped ones
+	*                For each record,
+	*                  Look up its rectangle in the frame table
+	*                  If it faces left, mirror it about its own centre
+	*                  Draw it from the sprite sheet
+	*                Put the transform back
 	**************************************************************************/
-	RECT spriteRectangle1, spriteRectangle2, intersectionRectangle;
-
-	//Initialize the first rectangle
-	spriteRectangle1.left = Sprite1.xCoordinate;
-	spriteRectangle1.top = Sprite1.yCoordinate;
-	spriteRectangle1.right = Sprite1.xCoordinate + Sprite1.width;
-	spriteRectangle1.bottom = Sprite1.yCoordinate + Sprite1.height;
-
-	//Initialize the second rectangle
-	spriteRectangle2.left = Sprite2.xCoordinate;
-	spriteRectangle2.top = Sprite2.yCoordinate;
-	spriteRectangle2.right = Sprite2.xCoordinate + Sprite2.width;
-	spriteRectangle2.bottom = Sprite2.yCoordinate + Sprite2.height;
-
-	//Determine collision
-	return IntersectRect(&intersectionRectangle, &spriteRectangle1, &spriteRectangle2);
-}
-
-bool Check_Loss()
-{
-	/**************************************************************************
-	*  PreCondition: The game loop is running
-	* PostCondition: It will be determined if the player has been destroyed
-	*   Description: This function checks collision of the player against all
-	*                  possible enemy sprites
-	*     Algorithm: Check player collision against enemy bullet
-	*                Check player collision against enemy missile
-	*                Check player collision against enemy homing missile
-	*                Check player collision against vulcan jet
-	*                Check player collision against missile jet
-	*                Check player collision against helicopter
-	*                If all of the above fail, player has not lost
-	**************************************************************************/
-	//Check collision against an enemy bullet
-	if(Check_Collision(playerJet,enemyBullet))
+	PROFILE_SCOPE("Draw_Sprites");
+	D3DXMATRIX transform;
+	D3DXVECTOR2 mirror(-1.0f, 1.0f);
+	int record;
+
+	//Build this frame's queue
+	Render_Clear(&renderQueue);
+	//(the job system belongs to the simulation thread, so this one queues alone)
+	Render_Emit_World(&renderQueue, &snapshot->world, &snapshot->history,
+		Render_Snapshot_Alpha(snapshot, Timer_Microseconds()), NULL);
+	Render_Sort(&renderQueue);
+
+	//Submit it in one pass
+	for(record = 0; record < renderQueue.sortedCount; record++)
 	{
-		playerJet.destroyed = true;
-		enemyBullet.xCoordinate = -200;
-		enemyBullet.yCoordinate = -200;
-		return true;
-	}
-	else
-		//Check collision against an enemy dumbfire missile
-		if(Check_Collision(playerJet, missile))
-		{
-			playerJet.destroyed = true;
-			missile.xCoordinate = 1500;
-			missile.yCoordinate = 1000;
-			return true;
-		}
-		else
-			//check collision against an enemy homing missile
-			if(Check_Collision(playerJet, homingMissile))
-			{
-				playerJet.destroyed = true;
-				homingMissile.xCoordinate = 1300;
-				homingMissile.yCoordinate = 500;
-				return true;
-			}
-			else
-				//check if the player rammed the vulcan jet
-				if(Check_Collision(playerJet, enemyVulcanJet))
-				{
-					playerJet.destroyed = true;
-					enemyVulcanJet.destroyed = true;
-					return true;
-				}
-				else
-					//check if the player rammed the missile jet
-					if(Check_Collision(playerJet, enemyUnguidedMissileJet))
-					{
-						playerJet.destroyed = true;
-						enemyUnguidedMissileJet.destroyed = true;
-						return true;
-					}
-					else
-						//check if the player rammed the helicopter
-						if(Check_Collision(playerJet, enemyHelicopter))
-						{
-							playerJet.destroyed = true;
-							enemyHelicopter.destroyed = true;
-							return true;
-						}	
-
-	//Player is OK
-	return false;
-}
-
-void Move_Enemies()
-{
-	/**************************************************************************
-	*  PreCondition: The enemy sprites have been allocated properly
-	* PostCondition: The enemy sprites will be moved
-	*   Description: This function keeps the enemy planes moving onscreen
-	*     Algorithm: If the Vulcan Jet is still flying,
-	*                  Make its entrance, then move it up and down the screen
-	*                Else If the Missile Jet is still flying,
-	*                  Make its entrance, then move it left and right on screen
-	*                Else If the Helicopter is still flying,
-	*                  Make its entrance, then move it diagonally on screen
-	*                Else If the Bomber is still flying,
-	*                  Make its entrance, then movie it up and down the screen
-	**************************************************************************/
+		const DRAWRECORD* draw = &renderQueue.sorted[record];
+		const ATLASRECT* source = Render_Source(snapshot->world.level, draw);
+		RECT spriteRectangle = { source->left, source->top, source->right, source->bottom };
+		D3DXVECTOR3 position((float)draw->xCoordinate, (float)draw->yCoordinate, 0);
 
-	//If the Vulcan Jet hasn't been shot down
-	if(!enemyVulcanJet.destroyed)
-	{
-		//move the vulcan jet
-		enemyVulcanJet.yCoordinate += enemyVulcanJet.ySpeed;
+		//flip left-facing sprites in place
+		if(draw->flip)
+		{
+			D3DXVECTOR2 centre(draw->xCoordinate + (source->right - source->left) / 2.0f,
+				draw->yCoordinate + (source->bottom - source->top) / 2.0f);
 
-		//note entrance onscreen
-		if(enemyVulcanJet.yCoordinate > 0 && enemyVulcanJet.yCoordinate < 700)
-			enemyVulcanJet.onscreen = true;		
+			D3DXMatrixTransformation2D(&transform, &centre, 0, &mirror, NULL, 0, NULL);
+			spriteHandlerPointer->SetTransform(&transform);
+		}
 
-		//if the vulcan jet has moved offscreen, change its direction
-		if(enemyVulcanJet.onscreen)
-			if(enemyVulcanJet.yCoordinate + enemyVulcanJet.height > 700 || enemyVulcanJet.yCoordinate < 0)
-				enemyVulcanJet.ySpeed = -enemyVulcanJet.ySpeed;
+		//draw the sprite
+		spriteHandlerPointer->Draw(spriteSheetPointer, &spriteRectangle, NULL, &position,
+			D3DCOLOR_XRGB(255,255,255));
 	}
-	else
-		//If the Missile Jet hasn't been shot down
-		if(!enemyUnguidedMissileJet.destroyed)
-		{
-			//move the missile jet
-			enemyUnguidedMissileJet.xCoordinate += enemyUnguidedMissileJet.xSpeed;
-
-			//note entrance onscreen
-			if(enemyUnguidedMissileJet.xCoordinate > 0 && enemyUnguidedMissileJet.xCoordinate + enemyUnguidedMissileJet.width  < 1000)
-				enemyUnguidedMissileJet.onscreen = true;		
-
-			//if the missile jet has moved offscreen, change its direction
-			if(enemyUnguidedMissileJet.onscreen)				
-				if(enemyUnguidedMissileJet.xCoordinate < 0 || 
-					enemyUnguidedMissileJet.xCoordinate + enemyUnguidedMissileJet.width > 1000)
-				{
-					enemyUnguidedMissileJet.xSpeed = -enemyUnguidedMissileJet.xSpeed;
-					enemyUnguidedMissileJet.faceRight = !enemyUnguidedMissileJet.faceRight;
-				}
-		}
-		else
-			//If the Helicopter hasn't been shot down
-			if(!enemyHelicopter.destroyed)
-			{
-				//move the helicopter
-				enemyHelicopter.xCoordinate += enemyHelicopter.xSpeed;
-				enemyHelicopter.yCoordinate += enemyHelicopter.ySpeed;
-
-				//note entrance onscreen
-				if((enemyHelicopter.xCoordinate > 0 && enemyHelicopter.xCoordinate < 1000) &&
-					(enemyHelicopter.yCoordinate > 0 && enemyHelicopter.yCoordinate < 700))
-					enemyHelicopter.onscreen = true;		
-
-				//if the helicopter has moved offscreen, change its direction
-				if(enemyHelicopter.onscreen)
-				{
-					//if the helicopter moves offscreen, change its direction
-					if(enemyHelicopter.xCoordinate < 0 || enemyHelicopter.xCoordinate + enemyHelicopter.width > 1000)
-					{
-						enemyHelicopter.xSpeed = -enemyHelicopter.xSpeed;
-						enemyHelicopter.faceRight = !enemyHelicopter.faceRight;
-					}
-					if(enemyHelicopter.yCoordinate < 0 || enemyHelicopter.yCoordinate + enemyHelicopter.height > 700)
-						enemyHelicopter.ySpeed = -enemyHelicopter.ySpeed;
-				}
-			}
-			else
-				//If the Bomber Boss hasn't been shot down
-				if(!enemyBomber.destroyed)
-				{
-					//move the bomber
-					enemyBomber.yCoordinate += enemyBomber.ySpeed;
-
-					//note entrance onscreen
-					if(enemyBomber.yCoordinate > 0 && enemyBomber.yCoordinate + enemyBomber.height < 700)
-						enemyBomber.onscreen = true;		
-
-					//if the vulcan jet has moved offscreen, change its direction
-					if(enemyBomber.onscreen)
-						//if the Bomber moves offscreen, change its direction
-						if(enemyBomber.yCoordinate < 0 || enemyBomber.yCoordinate + enemyBomber.height > 700)
-							enemyBomber.ySpeed = -enemyBomber.ySpeed;
-				}
-			return;
+
+	//leave the sprite handler unflipped for the next frame
+	D3DXMatrixIdentity(&transform);
+	spriteHandlerPointer->SetTransform(&transform);
 }
 
-void Move_Weaponry()
+void Draw_Particles(const WORLDSNAPSHOT* snapshot)
 {
 	/**************************************************************************
-	*  PreCondition: The sprites have been set up correctly
-	* PostCondition: The weaponry sprites will be updated
-	*   Description: This function moves and updates all the weapon sprites
-	*     Algorithm: If the player has fired a bullet, move it on screen
-	*                If the enemy has fired a bullet, move it on screen
-	*                If the enemy fires a missile, move it on screen
+	*  PreCondition: The Sprite Handler has begun drawing
+	* PostCondition: The particles will have stepped by the time since the
+	*                  last frame and been drawn to the backbuffer
+	*   Description: This function runs and draws the explosions and exhaust
+	*     Algorithm: Time the step, a stall only ever costs the longest one
+	*                Puff exhaust behind the snapshot's missiles
+	*                Update the particles and record the living ones
+	*                For each record, draw a few pixels from the middle of
+	*                  the bullet's artwork centred on it, tinted by its kind
+	*                  and faded by its age
 	**************************************************************************/
-
-	//If the player has fired a shot
-	if(playerBullet.onscreen)
+	PROFILE_SCOPE("Draw_Particles");
+	static const D3DCOLOR particleColors[PARTICLE_KIND_COUNT] =
 	{
-		//move the bullet
-		playerBullet.xCoordinate += playerBullet.xSpeed;
-
-		//if the bullet goes off the screen, make note the shot is finished
-		if(playerBullet.xCoordinate > 1000 || playerBullet.xCoordinate < 0 - playerBullet.width)
-			playerBullet.onscreen = false;
-	}
-
-	//If the enemy has fired a shot
-	if(enemyBullet.onscreen)
+		D3DCOLOR_XRGB(255,160,40),  //Flame
+		D3DCOLOR_XRGB(110,110,110), //Smoke
+		D3DCOLOR_XRGB(230,230,230)  //Exhaust
+	};
+	const ATLASRECT* source = &snapshot->world.level->frames[FRAME_BULLET];
+	int left = (source->left + source->right - PARTICLE_PIXELS) / 2;
+	int top = (source->top + source->bottom - PARTICLE_PIXELS) / 2;
+	RECT particleRectangle = { left, top, left + PARTICLE_PIXELS, top + PARTICLE_PIXELS };
+	D3DXVECTOR3 centre(PARTICLE_PIXELS / 2.0f, PARTICLE_PIXELS / 2.0f, 0);
+	long long now = Timer_Microseconds();
+	float seconds = (now - lastParticleStep) / 1000000.0f;
+	int record;
+
+	//step by the frame's time
+	lastParticleStep = now;
+	if(seconds > PARTICLE_MAX_FRAME_SECONDS)
+		seconds = PARTICLE_MAX_FRAME_SECONDS;
+	Particles_Exhaust(&gameParticles, &snapshot->world, seconds);
+	Particles_Update(&gameParticles, seconds);
+	Particles_Emit(&gameParticles, &particleBatch);
+
+	//Submit them in one pass
+	for(record = 0; record < particleBatch.count; record++)
 	{
-		//move the bullet
-		enemyBullet.xCoordinate += enemyBullet.xSpeed;
+		const PARTICLERECORD* particle = &particleBatch.records[record];
+		D3DXVECTOR3 position((float)particle->xCoordinate, (float)particle->yCoordinate, 0);
 
-		//if the bullet goes off the screen, make note the shot is finished
-		if(enemyBullet.xCoordinate < 0 - enemyBullet.width)
-			enemyBullet.onscreen = false;
-	}
-
-	//If the enemy has fired a missile
-	if(missile.onscreen)
-	{
-		//move the missile
-		missile.xCoordinate += missile.xSpeed;
-
-		//if the missile goes off the screen, make note the shot is finished
-		if(missile.xCoordinate < 0 - missile.width)
-			missile.onscreen = false;
+		spriteHandlerPointer->Draw(spriteSheetPointer, &particleRectangle, &centre, &position,
+			(particleColors[particle->kind] & 0x00FFFFFF) | ((D3DCOLOR)particle->shade << 24));
 	}
 }
 
-void Check_Scoring()
+void Draw_Screen(FLOW_SCREEN screen)
 {
 	/**************************************************************************
-	*  PreCondition: The enemy sprites have been initialized
-	* PostCondition: The appropriate enemy will be checked for being hit by the player
-	*   Description: This function checks if the player has hit an enemy with a
-	*                  bullet
-	*     Algorithm: Check if the player hit the Vulcan Jet
-	*                Check if the player hit the Missile Jet
-	*                Check if the player hit the Helicopter
-	*                Check if the player hit the Bomber
+	*  PreCondition: The Sprite Handler has begun drawing
+	* PostCondition: The screen's text will be drawn over the world, if it
+	*                  has any
+	*   Description: This function draws the title and the round's outcome,
+	*                  the world carries on being drawn behind them
+	*     Algorithm: Look up the screen's text
+	*                Draw it centred across the lower part of the window
 	**************************************************************************/
-	//Check if the player's bullet hit the Vulcan Jet
-	if(Check_Collision(playerBullet, enemyVulcanJet))
-		enemyVulcanJet.destroyed = true;
-	else
-		//Check if the player's bullet hit the Missile Jet
-		if(Check_Collision(playerBullet, enemyUnguidedMissileJet))
-			enemyUnguidedMissileJet.destroyed = true;
-		else
-			//Check if the player's bullet hit the Helicopter
-			if(Check_Collision(playerBullet, enemyHelicopter))
-				enemyHelicopter.destroyed = true;
-			else
-				//Check if the player's bullet hit the Bomber
-				if(Check_Collision(playerBullet, enemyBomber))
-					enemyBomber.destroyed = true;
-}
\ No newline at end of file
+	static const char* screenText[] =
+	{
+		"AEROBATICA\n\nArrows to move, Spacebar to fire\nPress Enter to take off",          //Title
+		NULL,                                                                               //Playing
+		"Congratulations, you have cleared the skies!\n\nPress Enter to fly again",       //Victory
+		"You have been shot down. Better luck next time!\n\nPress Enter to fly again",    //Game Over
+		NULL                                                                                //Restart
+	};
+	RECT textRectangle = { 0, SCREEN_HEIGHT / 3, SCREEN_WIDTH, SCREEN_HEIGHT };
+
+	if(screenText[screen] == NULL)
+		return;
+
+	//batched with the sprites
+	screenFontPointer->DrawText(spriteHandlerPointer, screenText[screen], -1, &textRectangle,
+		DT_CENTER | DT_WORDBREAK, D3DCOLOR_XRGB(255,255,255));
+}
@@ -19,38 +19,45 @@
 #include <time.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
 #include "dxgraphics.h"
 #include "dxinput.h"
+#include "Aerobatica_simulation.h" //Renderer-free game world
+#include "Aerobatica_render.h"     //Draw records and world snapshots
+#include "Aerobatica_replay.h"     //Input logs
+#include "Aerobatica_timer.h"      //High-resolution clock
+#include "Aerobatica_profiler.h"   //Phase timings
+#include "Aerobatica_flow.h"       //Title, playing and result screens
+#include "Aerobatica_mixer.h"      //Sound effects
+#include "Aerobatica_particles.h"  //Explosions and exhaust
+#include "Aerobatica_input.h"      //Timestamped input
 #pragma endregion
 
 #pragma region Constants
 #define FULLSCREEN 0 //0 = Windowed, 1 = Fullscreen
 #define SCREEN_WIDTH 1000
 #define SCREEN_HEIGHT 700
+#define SESSION_LOG "last session.aerolog" //Replay of the latest round
+#define LEVEL_FILE "Aerobatica.aerolevel"   //Compiled level, the built-in one is used without it
+#define PROFILE_REPORT_FILE "profile.txt"   //Phase timings, profiling builds only
+#define PROFILE_TRACE_FILE "profile trace.json"
+#define SCREEN_FONT_HEIGHT 36 //Text of the title and result screens
+#define PARTICLE_MAX_FRAME_SECONDS 0.1f //Longest step the particles take, after a stall
+#define PARTICLE_PIXELS 4 //Size of a particle, cut from the middle of the bullet's artwork
 #pragma endregion
 
-//Sprite Structure
-typedef struct
-{
-	int xCoordinate, yCoordinate;
-	int xSpeed, ySpeed;
-	int width, height;
-	bool faceRight, destroyed, onscreen;
-} SPRITE;
-
 #pragma region Function Prototypes
 int Game_Init(HWND);
 void Game_Run(HWND);
 void Game_End(HWND);
+void Run_Simulation();
 void Check_Input(HWND);
+SIM_INPUT Poll_Controls();
 bool Load_Animations();
-void Set_Sprites_Properties();
-void Draw_Sprites();
-void Draw_To_Backbuffer(SPRITE, RECT, D3DXVECTOR3, long, long, long, long);
-int Check_Collision(SPRITE, SPRITE);
-bool Check_Loss();
-void Move_Enemies();
-void Move_Weaponry();
-void Check_Scoring();
+void Draw_Sprites(const WORLDSNAPSHOT*);
+void Draw_Particles(const WORLDSNAPSHOT*);
+void Draw_Screen(FLOW_SCREEN);
 #pragma endregion
-#endif
\ No newline at end of file
+#endif
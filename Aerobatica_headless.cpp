@@ -0,0 +1,663 @@
+/******************************************************************************
+*        Title: Aerobatica
+* Date Started: April 10th, 2009
+*    Developer: Liam Hagerty
+*       Module: Headless Runner
+*  Description: This module runs the game world without a window or Direct3D
+*                 device so it can be soak tested and its recorded sessions
+*                 checked on any build machine
+*        Usage: Aerobatica_headless [level <file>] [ticks] [draws]
+*                 soak test, draws prints the last tick's sorted draw records
+*               Aerobatica_headless [level <file>] record <log> [ticks] [seed]
+*                 record one round of scripted play with state hashes
+*               Aerobatica_headless [level <file>] replay <log> [log...]
+*                 re-simulate each log, exits with 1 if any of them differs
+*               Aerobatica_headless [level <file>] netplay [ticks] [latency]
+*                 [jitter] [loss%] [seed]
+*                 play two rollback sessions over a lossy loopback link,
+*                 exits with 1 if they don't end where one world fed both
+*                 players' inputs does
+*               Aerobatica_headless [level <file>] sound <wav file> [seconds]
+*                 play in real time with the mixer writing the effects to a
+*                 WAV file, and report how the voices and queue coped
+*               Aerobatica_headless [level <file>] input [seconds] [device]
+*                 play in real time from the input sampler, driven by a
+*                 script of short taps or an evdev device, and report how
+*                 late changes reached their ticks
+*               Every run plays the built-in level unless given a compiled one
+*      Version: 1.0
+******************************************************************************/
+#pragma region Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <chrono>
+#include <thread>
+#include "Aerobatica_simulation.h" //Renderer-free game world
+#include "Aerobatica_render.h"     //Draw records
+#include "Aerobatica_replay.h"     //Input logs
+#include "Aerobatica_profiler.h"   //Phase timings
+#include "Aerobatica_netplay.h"    //Rollback sessions
+#include "Aerobatica_mixer.h"      //Sound effects
+#include "Aerobatica_timer.h"      //Real-time pacing
+#include "Aerobatica_input.h"      //Timestamped input
+#pragma endregion
+
+#pragma region Constants
+#define DEFAULT_SOAK_TICKS 1000000
+#define DEFAULT_RECORD_TICKS 10000
+#define DEFAULT_SEED 2009
+#define DEFAULT_NETPLAY_TICKS 3000
+#define DEFAULT_LATENCY 3      //Frames each packet takes
+#define DEFAULT_JITTER 2       //Most extra frames one can be held up
+#define DEFAULT_LOSS_PERCENT 10
+#define NETPLAY_FRAME_LIMIT 20 //Frames allowed per tick before a netplay run gives up
+#define DEFAULT_SOUND_SECONDS 10
+#define DEFAULT_INPUT_SECONDS 10
+#define INPUT_TAP_MS 5       //Scripted fire taps, far shorter than a tick
+#define INPUT_TAP_GAP_MS 47  //From one tap to the next, longer than a tick
+#define INPUT_TURN_MS 250    //Scripted direction changes
+#define HEADLESS_TRACE_FILE "headless trace.json" //Written by profiling builds
+#pragma endregion
+
+#pragma region Function Prototypes
+int Run_Soak(int, char*[]);
+int Run_Record(int, char*[]);
+int Run_Replay(int, char*[]);
+int Run_Netplay(int, char*[]);
+int Run_Sound(int, char*[]);
+int Run_Input(int, char*[]);
+SIM_INPUT Scripted_Input(unsigned long*);
+void Print_Draws(const SIMULATION*);
+#pragma endregion
+
+#pragma region Global Variables
+static SIMULATION world; //too large for the stack
+static JOBSYSTEM jobs;
+static LEVEL level;
+static SIMSNAPSHOT start;                //World at the start of a soak round
+static NETSESSION sessions[NET_PLAYERS]; //Each holds its snapshots
+static NETLINK links[NET_PLAYERS];       //Packets on their way to each player
+static MIXER mixer;
+static INPUTSAMPLER sampler;
+#pragma endregion
+
+int main(int argc, char* argv[])
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: The requested run will have finished, returns non-zero
+	*                  if it failed
+	*   Description: Headless entry point
+	*     Algorithm: Map the level file, if one was given
+	*                Start the job system and split large ticks across it
+	*                Record, replay, play netplay, play with sound or play from
+	*                  the input sampler if asked to, otherwise soak test
+	*                Stop the job system
+	**************************************************************************/
+	int result;
+
+	//play a compiled level instead of the built-in one
+	if(argc > 2 && strcmp(argv[1], "level") == 0)
+	{
+		if(!Level_Open(&level, argv[2]))
+		{
+			fprintf(stderr, "%s: not a level for this version\n", argv[2]);
+			return 1;
+		}
+		Sim_Use_Level(&level);
+		argc -= 2;
+		argv += 2;
+	}
+
+	Jobs_Init(&jobs, Jobs_Default_Workers());
+	Sim_Use_Jobs(&jobs);
+
+	if(argc > 1 && strcmp(argv[1], "record") == 0)
+		result = Run_Record(argc - 2, argv + 2);
+	else if(argc > 1 && strcmp(argv[1], "replay") == 0)
+		result = Run_Replay(argc - 2, argv + 2);
+	else if(argc > 1 && strcmp(argv[1], "netplay") == 0)
+		result = Run_Netplay(argc - 2, argv + 2);
+	else if(argc > 1 && strcmp(argv[1], "sound") == 0)
+		result = Run_Sound(argc - 2, argv + 2);
+	else if(argc > 1 && strcmp(argv[1], "input") == 0)
+		result = Run_Input(argc - 2, argv + 2);
+	else
+		result = Run_Soak(argc - 1, argv + 1);
+
+	Sim_Use_Jobs(NULL);
+	Jobs_Shutdown(&jobs);
+	if(level.view != NULL)
+	{
+		Sim_Use_Level(NULL);
+		Level_Close(&level);
+	}
+
+	return result;
+}
+
+int Run_Soak(int argc, char* argv[])
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: The world will have been stepped the requested number of
+	*                  ticks and the throughput reported
+	*   Description: Soak test
+	*     Algorithm: Read the tick count from the command line
+	*                Set up the Game World() and keep it as every round's
+	*                  start
+	*                For every tick,
+	*                  Generate scripted input and step the world
+	*                  Restart the round in place whenever one finishes
+	*                Report rounds played and ticks per second
+	*                Report the phase timings, in profiling builds
+	*                If asked, print the draw records for the final state
+	**************************************************************************/
+	unsigned long ticks = DEFAULT_SOAK_TICKS, inputState = 12345;
+	unsigned long tick, victories = 0, defeats = 0;
+	clock_t started;
+	double seconds;
+
+	//read the number of ticks to run
+	if(argc > 0)
+		ticks = strtoul(argv[0], NULL, 10);
+
+	//Set up the first round
+	Sim_Init(&world, DEFAULT_SEED);
+	Sim_Save(&world, &start);
+
+	started = clock();
+	for(tick = 0; tick < ticks; tick++)
+	{
+		//play one tick at the fixed rate
+		Sim_Step(&world, Scripted_Input(&inputState), SIM_TICK_US);
+		PROFILE_FRAME();
+
+		//tally the round and start another
+		if(world.status != SIM_PLAYING)
+		{
+			if(world.status == SIM_VICTORY)
+				victories++;
+			else
+				defeats++;
+			Sim_Restart(&world, &start, DEFAULT_SEED + victories + defeats);
+		}
+	}
+	seconds = (double)(clock() - started) / CLOCKS_PER_SEC;
+
+	//report the results
+	printf("ticks: %lu  victories: %lu  defeats: %lu\n", ticks, victories, defeats);
+	if(seconds > 0)
+		printf("%.0f ticks per second\n", ticks / seconds);
+
+	//phase timings, in profiling builds
+	PROFILE_REPORT(stdout);
+	PROFILE_WRITE_TRACE(HEADLESS_TRACE_FILE);
+
+	//show what would be drawn
+	if(argc > 1 && strcmp(argv[1], "draws") == 0)
+		Print_Draws(&world);
+
+	return 0;
+}
+
+int Run_Record(int argc, char* argv[])
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: A log of one round of scripted play will be written,
+	*                  returns non-zero if it couldn't be
+	*   Description: Makes input logs for regression runs
+	*     Algorithm: Read the log name, tick limit and seed
+	*                Start a round with the seed
+	*                Until the round ends or the limit is reached,
+	*                  Run a tick with scripted input and log it
+	**************************************************************************/
+	unsigned long ticks = DEFAULT_RECORD_TICKS, seed = DEFAULT_SEED, inputState;
+	INPUTLOG log;
+
+	if(argc < 1)
+	{
+		fprintf(stderr, "record needs a log file name\n");
+		return 1;
+	}
+	if(argc > 1)
+		ticks = strtoul(argv[1], NULL, 10);
+	if(argc > 2)
+		seed = strtoul(argv[2], NULL, 10);
+
+	if(!Replay_Create(&log, argv[0], seed, REPLAY_HASHES))
+	{
+		fprintf(stderr, "%s: could not be created\n", argv[0]);
+		return 1;
+	}
+
+	//play the round, the scripted player follows the seed too
+	Sim_Init(&world, seed);
+	inputState = seed;
+	while(log.ticks < ticks && world.status == SIM_PLAYING)
+	{
+		SIM_INPUT input = Scripted_Input(&inputState);
+
+		Sim_Tick(&world, input);
+		Replay_Write(&log, input, Sim_Hash(&world));
+	}
+
+	printf("%s: %lu ticks, %s\n", argv[0], log.ticks,
+		world.status == SIM_VICTORY ? "victory" : world.status == SIM_DEFEAT ? "defeat" : "unfinished");
+	Replay_Finish(&log);
+
+	return 0;
+}
+
+int Run_Replay(int argc, char* argv[])
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: Each log will have been re-simulated and checked,
+	*                  returns non-zero if any log was unreadable or differed
+	*   Description: Regression check for recorded sessions
+	*     Algorithm: For each log,
+	*                  Replay_Run() it
+	*                  Report the first tick that differed, if any
+	*                Report the totals and the replay speed
+	**************************************************************************/
+	unsigned long ticks = 0;
+	int log, failures = 0;
+	clock_t started = clock();
+	double seconds;
+
+	for(log = 0; log < argc; log++)
+	{
+		INPUTLOG input;
+		long differs;
+
+		if(!Replay_Open(&input, argv[log]))
+		{
+			printf("%s: not an input log\n", argv[log]);
+			failures++;
+			continue;
+		}
+
+		differs = Replay_Run(&input, &world);
+		ticks += input.ticks;
+		if(differs != REPLAY_MATCH)
+		{
+			printf("%s: differs at tick %ld\n", argv[log], differs);
+			failures++;
+		}
+		Replay_Close(&input);
+	}
+	seconds = (double)(clock() - started) / CLOCKS_PER_SEC;
+
+	//report the results
+	printf("logs: %d  failed: %d  ticks: %lu\n", argc, failures, ticks);
+	if(seconds > 0)
+		printf("%.0f ticks per second\n", ticks / seconds);
+
+	return failures > 0;
+}
+
+int Run_Netplay(int argc, char* argv[])
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: Two sessions will have played the requested ticks over
+	*                  simulated links and been checked, returns non-zero if
+	*                  they didn't finish, desynced, or ended somewhere else
+	*                  than the reference world
+	*   Description: Loopback test of rollback netplay
+	*     Algorithm: Read the tick count, link conditions and seed
+	*                Start a session for each player and a link to each
+	*                Each frame until both have played every tick on real
+	*                  input,
+	*                  Each player takes the packets that have arrived
+	*                  Each player advances with their scripted input,
+	*                    offering it again next frame if they stalled
+	*                  Each player sends a packet
+	*                Roll both sessions back to settle their last guesses
+	*                Play a reference world with both players' inputs
+	*                Report the sessions' counts and compare their worlds
+	*                  with it
+	**************************************************************************/
+	unsigned long ticks = DEFAULT_NETPLAY_TICKS, seed = DEFAULT_SEED;
+	int latency = DEFAULT_LATENCY, jitter = DEFAULT_JITTER, loss = DEFAULT_LOSS_PERCENT;
+	unsigned long inputState[NET_PLAYERS], frame, tick, reference;
+	SIM_INPUT next[NET_PLAYERS];
+	NETPACKET packet;
+	int player, failures = 0;
+
+	if(argc > 0)
+		ticks = strtoul(argv[0], NULL, 10);
+	if(argc > 1)
+		latency = atoi(argv[1]);
+	if(argc > 2)
+		jitter = atoi(argv[2]);
+	if(argc > 3)
+		loss = atoi(argv[3]);
+	if(argc > 4)
+		seed = strtoul(argv[4], NULL, 10);
+
+	//each player follows their own script
+	for(player = 0; player < NET_PLAYERS; player++)
+	{
+		Net_Start(&sessions[player], player, seed);
+		Net_Link_Init(&links[player], latency, jitter, loss, seed + player + 1);
+		inputState[player] = seed + player;
+		next[player] = Scripted_Input(&inputState[player]);
+	}
+
+	for(frame = 0; frame < ticks * NETPLAY_FRAME_LIMIT; frame++)
+	{
+		if(sessions[0].confirmed >= ticks && sessions[1].confirmed >= ticks)
+			break;
+
+		for(player = 0; player < NET_PLAYERS; player++)
+			while(Net_Link_Receive(&links[player], frame, &packet))
+				Net_Take_Packet(&sessions[player], &packet);
+
+		for(player = 0; player < NET_PLAYERS; player++)
+			if(sessions[player].tick < ticks && Net_Advance(&sessions[player], next[player]))
+				next[player] = Scripted_Input(&inputState[player]);
+
+		for(player = 0; player < NET_PLAYERS; player++)
+		{
+			Net_Make_Packet(&sessions[player], &packet);
+			Net_Link_Send(&links[1 - player], &packet, frame);
+		}
+	}
+
+	//settle the last guesses
+	for(player = 0; player < NET_PLAYERS; player++)
+		Net_Roll_Back(&sessions[player]);
+
+	//one world with everybody's input
+	for(player = 0; player < NET_PLAYERS; player++)
+		inputState[player] = seed + player;
+	Sim_Init(&world, seed);
+	for(tick = 0; tick < ticks; tick++)
+	{
+		SIM_INPUT pilot = Scripted_Input(&inputState[NET_PILOT]);
+
+		Sim_Tick(&world, Net_Crew_Input(pilot, Scripted_Input(&inputState[NET_GUNNER])));
+	}
+	reference = Sim_Hash(&world);
+
+	//report the results
+	printf("frames: %lu  ticks: %lu  latency: %d+%d  loss: %d%%\n", frame, ticks, latency, jitter, loss);
+	for(player = 0; player < NET_PLAYERS; player++)
+	{
+		const NETSESSION* session = &sessions[player];
+
+		printf("player %d: stalls: %lu  rollbacks: %lu  resimulated: %lu  deepest: %lu  packets lost: %lu/%lu",
+			player, session->stalls, session->rollbacks, session->resimulated, session->deepest,
+			links[1 - player].lost, links[1 - player].sent);
+		if(session->confirmed < ticks)
+		{
+			printf("  unfinished\n");
+			failures++;
+		}
+		else if(session->desyncTick != NET_NO_TICK)
+		{
+			printf("  desync at tick %lu\n", session->desyncTick);
+			failures++;
+		}
+		else if(Sim_Hash(&session->world) != reference)
+		{
+			printf("  differs from the reference\n");
+			failures++;
+		}
+		else
+			printf("  matches\n");
+	}
+
+	return failures > 0;
+}
+
+int Run_Sound(int argc, char* argv[])
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: The requested seconds of scripted play will have been
+	*                  mixed into the WAV file and the mixer's counts
+	*                  reported, returns non-zero if the file couldn't be
+	*                  written
+	*   Description: Real-time test of the sound mixer
+	*     Algorithm: Read the file name and the seconds to play
+	*                Make the effects and start the mixer on the file
+	*                For every tick, at the game's own pace,
+	*                  Step the world with scripted input and play its
+	*                    events, as the simulation thread does
+	*                  Restart the round in place whenever one finishes
+	*                Stop the mixer and report the sounds played, stolen,
+	*                  refused and dropped, and how long commands waited
+	**************************************************************************/
+	unsigned long seconds = DEFAULT_SOUND_SECONDS, inputState = 12345;
+	unsigned long tick, ticks, rounds = 0;
+	long long due, now;
+
+	if(argc < 1)
+	{
+		fprintf(stderr, "sound needs a WAV file name\n");
+		return 1;
+	}
+	if(argc > 1)
+		seconds = strtoul(argv[1], NULL, 10);
+	ticks = (unsigned long)(seconds * 1000000ULL / SIM_TICK_US);
+
+	if(!Mixer_Init(&mixer))
+	{
+		fprintf(stderr, "not enough memory for the sound effects\n");
+		return 1;
+	}
+	if(!Mixer_Start(&mixer, MIXER_OUTPUT_FILE, argv[0]))
+	{
+		fprintf(stderr, "%s: could not be created\n", argv[0]);
+		Mixer_Release(&mixer);
+		return 1;
+	}
+
+	//play in real time, so the mixer thread runs alongside as in the game
+	Sim_Init(&world, DEFAULT_SEED);
+	Sim_Save(&world, &start);
+	due = Timer_Microseconds();
+	for(tick = 0; tick < ticks; tick++)
+	{
+		Sim_Tick(&world, Scripted_Input(&inputState));
+		Mixer_Play_Events(&mixer, &world);
+		PROFILE_FRAME();
+
+		if(world.status != SIM_PLAYING)
+			Sim_Restart(&world, &start, DEFAULT_SEED + ++rounds);
+
+		due += SIM_TICK_US;
+		now = Timer_Microseconds();
+		if(due > now)
+			std::this_thread::sleep_for(std::chrono::microseconds(due - now));
+	}
+	Mixer_Stop(&mixer);
+
+	//report the results
+	printf("%s: %lu ticks, %lu blocks, %lu rounds\n", argv[0], ticks, mixer.blocks, rounds);
+	printf("played: %lu  stolen: %lu  refused: %lu  dropped: %lu\n",
+		mixer.played, mixer.stolen, mixer.refused, mixer.dropped.load());
+	if(mixer.played + mixer.refused > 0)
+		printf("latency: %lld us average, %lld us worst\n",
+			mixer.totalLatency / (long long)(mixer.played + mixer.refused), mixer.worstLatency);
+	PROFILE_REPORT(stdout);
+
+	Mixer_Release(&mixer);
+	return 0;
+}
+
+int Run_Input(int argc, char* argv[])
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: The requested seconds will have been played in real time
+	*                  from the input sampler and its latency reported,
+	*                  returns non-zero if the source couldn't be set up or a
+	*                  scripted tap was lost
+	*   Description: Real-time test of the input sampler
+	*     Algorithm: Read the seconds and the device, if one was given
+	*                Without a device, script a player tapping fire for a
+	*                  few milliseconds at a time (shorter than a tick) while
+	*                  turning the jet round every quarter second
+	*                Start the sampler on the device or the script
+	*                For every tick, at the game's own pace,
+	*                  Step the world with the input the sampler has for the
+	*                    tick, restarting rounds as they finish
+	*                  Count the ticks that fired, and the ones that would
+	*                    have by looking only at what was held as they ended
+	*                Report the changes taken and how long they waited, and
+	*                  for a script whether every tap reached a tick
+	**************************************************************************/
+	static const SIM_INPUT turns[4] = { INPUT_LEFT, INPUT_UP, INPUT_RIGHT, INPUT_DOWN };
+	unsigned long seconds = DEFAULT_INPUT_SECONDS, tick, ticks, rounds = 0;
+	unsigned long taps = 0, firing = 0, heldFiring = 0;
+	INPUTEVENT* script = NULL;
+	INPUTSCRIPT scripted;
+	INPUTEVDEV device;
+	INPUTSOURCE source;
+	SIM_INPUT input, buttons, last = 0;
+	long long due, now;
+	int events = 0, millisecond;
+	bool lost;
+
+	if(argc > 0)
+		seconds = strtoul(argv[0], NULL, 10);
+	ticks = (unsigned long)(seconds * 1000000ULL / SIM_TICK_US);
+
+	if(argc > 1)
+	{
+		//a real device
+		if(!Input_Evdev_Source(&source, &device, argv[1]))
+		{
+			fprintf(stderr, "%s: could not be opened as an input device\n", argv[1]);
+			return 1;
+		}
+	}
+	else
+	{
+		//a scripted player, a change wherever the buttons differ from the
+		//millisecond before
+		script = (INPUTEVENT*)malloc((seconds * 1000 + 1) * sizeof(INPUTEVENT));
+		if(script == NULL)
+		{
+			fprintf(stderr, "not enough memory for the script\n");
+			return 1;
+		}
+		for(millisecond = 0; millisecond < (int)(seconds * 1000); millisecond++)
+		{
+			buttons = turns[(millisecond / INPUT_TURN_MS) % 4];
+			if(millisecond % INPUT_TAP_GAP_MS < INPUT_TAP_MS)
+				buttons |= INPUT_FIRE;
+			if(buttons == last)
+				continue;
+			if((buttons & ~last) & INPUT_FIRE)
+				taps++;
+			script[events].time = millisecond * 1000LL;
+			script[events].buttons = buttons;
+			events++;
+			last = buttons;
+		}
+		Input_Scripted_Source(&source, &scripted, script, events, Timer_Microseconds() + SIM_TICK_US);
+	}
+	Input_Init(&sampler, &source);
+	Input_Start(&sampler);
+
+	//play in real time, each tick taking what happened before it ended
+	Sim_Init(&world, DEFAULT_SEED);
+	Sim_Save(&world, &start);
+	due = Timer_Microseconds();
+	for(tick = 0; tick < ticks; tick++)
+	{
+		due += SIM_TICK_US;
+		now = Timer_Microseconds();
+		if(due > now)
+			std::this_thread::sleep_for(std::chrono::microseconds(due - now));
+
+		input = Input_For_Tick(&sampler, due);
+		if(input & INPUT_FIRE)
+			firing++;
+		if(sampler.held & INPUT_FIRE)
+			heldFiring++;
+
+		Sim_Tick(&world, input & INPUT_CONTROLS);
+		if(world.status != SIM_PLAYING)
+			Sim_Restart(&world, &start, DEFAULT_SEED + ++rounds);
+	}
+	Input_Stop(&sampler);
+	if(script == NULL)
+		Input_Evdev_Close(&device);
+
+	//report the results
+	printf("%s source: %lu ticks, %lu changes taken, %lu dropped\n", source.name, ticks,
+		sampler.consumed, sampler.dropped.load());
+	if(sampler.consumed > 0)
+		printf("latency: %lld us average, %lld us worst\n",
+			sampler.totalLatency / (long long)sampler.consumed, sampler.worstLatency);
+
+	//every tap should have reached a tick, the last may still be on its way
+	lost = false;
+	if(script != NULL)
+	{
+		lost = firing + 1 < taps;
+		printf("taps: %lu  ticks firing: %lu  ticks firing from what was held: %lu\n",
+			taps, firing, heldFiring);
+		free(script);
+	}
+
+	return lost;
+}
+
+SIM_INPUT Scripted_Input(unsigned long* state)
+{
+	/**************************************************************************
+	*  PreCondition: The state has been seeded
+	* PostCondition: A repeatable pseudo-random set of controls will be returned
+	*   Description: This function stands in for a player during soak runs
+	*     Algorithm: Advance a linear congruential generator
+	*                Use its upper bits to pick a horizontal direction, a
+	*                  vertical direction and whether to fire, with each
+	*                  direction equally likely so the jet roams the playfield
+	**************************************************************************/
+	static const SIM_INPUT horizontal[3] = { 0, INPUT_LEFT, INPUT_RIGHT };
+	static const SIM_INPUT vertical[3] = { 0, INPUT_UP, INPUT_DOWN };
+	unsigned long bits;
+
+	//advance the generator
+	*state = (*state * 1103515245UL + 12345UL) & 0xFFFFFFFFUL;
+	bits = *state >> 16;
+
+	return (SIM_INPUT)(horizontal[bits % 3] | vertical[(bits / 3) % 3] | ((bits & 0x100) ? INPUT_FIRE : 0));
+}
+
+void Print_Draws(const SIMULATION* world)
+{
+	/**************************************************************************
+	*  PreCondition: The world has been stepped
+	* PostCondition: The world's sorted draw records will be printed
+	*   Description: Shows the command stream a renderer would submit
+	*     Algorithm: Queue and sort the world's draw records
+	*                Print each one with its sprite sheet rectangle
+	**************************************************************************/
+	static RENDERQUEUE queue;
+	int record;
+
+	Render_Clear(&queue);
+	Render_Emit_World(&queue, world, NULL, 0, NULL);
+	Render_Sort(&queue);
+
+	for(record = 0; record < queue.sortedCount; record++)
+	{
+		const DRAWRECORD* draw = &queue.sorted[record];
+		const ATLASRECT* source = Render_Source(world->level, draw);
+
+		printf("frame %d at (%d,%d)%s from (%d,%d)-(%d,%d)\n", draw->frame, draw->xCoordinate,
+			draw->yCoordinate, draw->flip ? " flipped" : "", source->left, source->top,
+			source->right, source->bottom);
+	}
+}
@@ -0,0 +1,390 @@
+/******************************************************************************
+*        Title: Aerobatica
+* Date Started: April 10th, 2009
+*    Developer: Liam Hagerty
+*       Module: Input Sampler Code Module
+*  Description: This module contains the routines that run the sampler
+*                 thread, hand each tick its changes, and read the polled,
+*                 scripted and evdev sources
+*      Version: 1.0
+******************************************************************************/
+#pragma region Includes
+#include <chrono>
+#include "Aerobatica_input.h" //Input Sampler Definitions Header
+#include "Aerobatica_timer.h" //Timestamps and pacing
+#ifdef _WIN32
+#include <windows.h>
+#include <mmsystem.h>
+#pragma comment(lib, "winmm.lib")
+#endif
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/ioctl.h>
+#include <linux/input.h>
+#endif
+#pragma endregion
+
+#pragma region Function Prototypes
+static void Run_Sampler(INPUTSAMPLER*);
+static bool Read_Polled(void*, INPUTEVENT*);
+static bool Read_Script(void*, INPUTEVENT*);
+#ifdef __linux__
+static bool Read_Evdev(void*, INPUTEVENT*);
+#endif
+#pragma endregion
+
+void Input_Init(INPUTSAMPLER* sampler, const INPUTSOURCE* source)
+{
+	/**************************************************************************
+	*  PreCondition: The source is open and ready to read
+	* PostCondition: The sampler will be ready to Start, with nothing held
+	*   Description: Sets up the sampler on a source
+	*     Algorithm: Keep the source
+	*                Set up the change queue over the sampler's storage
+	*                Clear the buttons held and the counts
+	**************************************************************************/
+	sampler->source = *source;
+	Ring_Init(&sampler->events, sampler->eventStorage, INPUT_EVENTS, sizeof(INPUTEVENT));
+	sampler->dropped.store(0);
+	sampler->latest.store(0);
+	sampler->running.store(false);
+
+	sampler->held = 0;
+	sampler->waiting = false;
+	sampler->consumed = 0;
+	sampler->totalLatency = 0;
+	sampler->worstLatency = 0;
+}
+
+void Input_Start(INPUTSAMPLER* sampler)
+{
+	/**************************************************************************
+	*  PreCondition: Input_Init has run and the sampler isn't running
+	* PostCondition: The sampler thread will be reading the source
+	*   Description: Starts sampling
+	*     Algorithm: On Windows, ask for millisecond sleeps so the thread
+	*                  keeps its pace
+	*                Start the sampler thread
+	**************************************************************************/
+#ifdef _WIN32
+	timeBeginPeriod(1);
+#endif
+	sampler->running.store(true);
+	sampler->thread = std::thread(Run_Sampler, sampler);
+}
+
+void Input_Stop(INPUTSAMPLER* sampler)
+{
+	/**************************************************************************
+	*  PreCondition: Input_Start has run
+	* PostCondition: The sampler thread will have finished
+	*   Description: Stops sampling, the source is left for its owner to
+	*                  close
+	*     Algorithm: Let the current sample finish, then stop the thread
+	*                Hand back the millisecond sleeps on Windows
+	**************************************************************************/
+	sampler->running.store(false);
+	if(sampler->thread.joinable())
+		sampler->thread.join();
+#ifdef _WIN32
+	timeEndPeriod(1);
+#endif
+}
+
+SIM_INPUT Input_For_Tick(INPUTSAMPLER* sampler, long long tickEnd)
+{
+	/**************************************************************************
+	*  PreCondition: Only the simulation thread calls this, once a tick with
+	*                  the clock reading the tick ended at, in order
+	* PostCondition: The buttons held at the end of the tick will be returned,
+	*                  along with any pressed during it, even if they were let
+	*                  go again before it ended
+	*   Description: Gives a tick exactly the input that happened during it
+	*     Algorithm: Take each change stamped before the tick ended, starting
+	*                  with one left over from the last tick,
+	*                  Note the buttons it pressed and hold what it holds
+	*                  Count how long it waited to be taken
+	*                Leave the first later change for the next tick
+	**************************************************************************/
+	long long now = Timer_Microseconds(), latency;
+	SIM_INPUT pressed = 0;
+
+	for(;;)
+	{
+		//the next change, if there is one
+		if(!sampler->waiting)
+		{
+			if(!Ring_Pop(&sampler->events, &sampler->next))
+				break;
+			sampler->waiting = true;
+		}
+
+		//later ones belong to later ticks
+		if(sampler->next.time >= tickEnd)
+			break;
+
+		pressed |= sampler->next.buttons & ~sampler->held;
+		sampler->held = sampler->next.buttons;
+		sampler->waiting = false;
+
+		latency = now - sampler->next.time;
+		sampler->consumed++;
+		sampler->totalLatency += latency;
+		if(latency > sampler->worstLatency)
+			sampler->worstLatency = latency;
+	}
+
+	return sampler->held | pressed;
+}
+
+SIM_INPUT Input_Latest(const INPUTSAMPLER* sampler)
+{
+	/**************************************************************************
+	*  PreCondition: Input_Init has run
+	* PostCondition: The buttons held after the newest change read will be
+	*                  returned
+	*   Description: Lets threads other than the simulation's see what is
+	*                  held, for buttons that aren't tied to ticks such as
+	*                  quitting
+	*     Algorithm: Read the latest buttons
+	**************************************************************************/
+	return sampler->latest.load();
+}
+
+void Input_Polled_Source(INPUTSOURCE* source, INPUTPOLLED* polled, SIM_INPUT (*poll)())
+{
+	/**************************************************************************
+	*  PreCondition: poll returns the buttons held at the moment it is called
+	* PostCondition: The source will report each change poll shows, stamped
+	*                  when it was seen
+	*   Description: Makes a source of a polled device
+	*     Algorithm: Keep the poll function, with nothing held yet
+	*                Point the source at it
+	**************************************************************************/
+	polled->poll = poll;
+	polled->last = 0;
+
+	source->name = "polled";
+	source->read = Read_Polled;
+	source->context = polled;
+}
+
+void Input_Scripted_Source(INPUTSOURCE* source, INPUTSCRIPT* script, const INPUTEVENT* events,
+						   int count, long long started)
+{
+	/**************************************************************************
+	*  PreCondition: The events are in time order, their times counted from
+	*                  the start
+	* PostCondition: The source will report each event once the clock
+	*                  reaches it, stamped with the time it was due
+	*   Description: Makes a source that plays back a script, standing in
+	*                  for a player in latency runs
+	*     Algorithm: Keep the script and its start
+	*                Point the source at it
+	**************************************************************************/
+	script->events = events;
+	script->count = count;
+	script->next = 0;
+	script->started = started;
+
+	source->name = "scripted";
+	source->read = Read_Script;
+	source->context = script;
+}
+
+#ifdef __linux__
+bool Input_Evdev_Source(INPUTSOURCE* source, INPUTEVDEV* device, const char* path)
+{
+	/**************************************************************************
+	*  PreCondition: path names an evdev device, such as /dev/input/event0
+	* PostCondition: The source will report the device's key changes stamped
+	*                  by the kernel, returns false if it couldn't be opened
+	*   Description: Makes a source of a Linux input device
+	*     Algorithm: Open the device without blocking
+	*                Have the kernel stamp events on the monotonic clock,
+	*                  the one the game's timer reads
+	*                Point the source at it, with nothing held yet
+	**************************************************************************/
+	int clock = CLOCK_MONOTONIC;
+
+	device->file = open(path, O_RDONLY | O_NONBLOCK);
+	if(device->file < 0)
+		return false;
+	if(ioctl(device->file, EVIOCSCLOCKID, &clock) != 0)
+	{
+		close(device->file);
+		device->file = -1;
+		return false;
+	}
+	device->buttons = 0;
+
+	source->name = "evdev";
+	source->read = Read_Evdev;
+	source->context = device;
+	return true;
+}
+
+void Input_Evdev_Close(INPUTEVDEV* device)
+{
+	/**************************************************************************
+	*  PreCondition: The sampler reading the device has stopped
+	* PostCondition: The device will be closed, if it was open
+	*   Description: Releases a Linux input device
+	*     Algorithm: Close the file
+	**************************************************************************/
+	if(device->file >= 0)
+		close(device->file);
+	device->file = -1;
+}
+
+static bool Read_Evdev(void* context, INPUTEVENT* event)
+{
+	/**************************************************************************
+	*  PreCondition: Input_Evdev_Source opened the device
+	* PostCondition: The next key change of a button will be filled in and
+	*                  true returned, or false if none has arrived
+	*   Description: Reads the changes a Linux input device has queued
+	*     Algorithm: Read the device's events until one presses or lets go
+	*                  of a button the game uses, ignoring key repeats
+	*                Apply it to the buttons held and stamp the change with
+	*                  the kernel's time
+	**************************************************************************/
+	static const struct
+	{
+		unsigned short code;
+		SIM_INPUT button;
+	} keys[] =
+	{
+		{ KEY_LEFT, INPUT_LEFT }, { KEY_RIGHT, INPUT_RIGHT }, { KEY_UP, INPUT_UP },
+		{ KEY_DOWN, INPUT_DOWN }, { KEY_SPACE, INPUT_FIRE }, { KEY_ENTER, INPUT_CONFIRM },
+		{ KEY_ESC, INPUT_QUIT }
+	};
+	INPUTEVDEV* device = (INPUTEVDEV*)context;
+	struct input_event raw;
+	unsigned key;
+
+	while(read(device->file, &raw, sizeof(raw)) == (ssize_t)sizeof(raw))
+	{
+		if(raw.type != EV_KEY || raw.value == 2)
+			continue;
+
+		for(key = 0; key < sizeof(keys) / sizeof(keys[0]); key++)
+			if(keys[key].code == raw.code)
+			{
+				if(raw.value)
+					device->buttons |= keys[key].button;
+				else
+					device->buttons &= ~keys[key].button;
+
+				event->time = (long long)raw.time.tv_sec * 1000000 + raw.time.tv_usec;
+				event->buttons = device->buttons;
+				return true;
+			}
+	}
+
+	return false;
+}
+#else
+bool Input_Evdev_Source(INPUTSOURCE* source, INPUTEVDEV* device, const char* path)
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: Returns false, there are no evdev devices here
+	*   Description: Stand-in for platforms without evdev, which use the
+	*                  polled or scripted sources instead
+	*     Algorithm: Report failure
+	**************************************************************************/
+	device->file = -1;
+	return false;
+}
+
+void Input_Evdev_Close(INPUTEVDEV* device)
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: None
+	*   Description: Stand-in for platforms without evdev
+	*     Algorithm: Nothing
+	**************************************************************************/
+}
+#endif
+
+static void Run_Sampler(INPUTSAMPLER* sampler)
+{
+	/**************************************************************************
+	*  PreCondition: Started by Input_Start
+	* PostCondition: Every change the source reported will have been queued
+	*                  until Input_Stop
+	*   Description: Body of the sampler thread
+	*     Algorithm: Until told to stop,
+	*                  Read every change the source has and queue it,
+	*                    counting any the queue had no room for
+	*                  Sleep until the next sample is due
+	**************************************************************************/
+	long long due = Timer_Microseconds(), now;
+	INPUTEVENT event;
+
+	while(sampler->running.load())
+	{
+		while(sampler->source.read(sampler->source.context, &event))
+		{
+			sampler->latest.store(event.buttons);
+			if(!Ring_Push(&sampler->events, &event))
+				sampler->dropped.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		//keep to the sampling rate
+		due += INPUT_SAMPLE_US;
+		now = Timer_Microseconds();
+		if(due > now)
+			std::this_thread::sleep_for(std::chrono::microseconds(due - now));
+		else
+			due = now;
+	}
+}
+
+static bool Read_Polled(void* context, INPUTEVENT* event)
+{
+	/**************************************************************************
+	*  PreCondition: Input_Polled_Source set up the context
+	* PostCondition: A change since the last poll will be filled in and true
+	*                  returned, or false if nothing changed
+	*   Description: Reads a polled device
+	*     Algorithm: Poll the buttons and stamp them straight away
+	*                Report them only if they differ from the last poll
+	**************************************************************************/
+	INPUTPOLLED* polled = (INPUTPOLLED*)context;
+	SIM_INPUT buttons = polled->poll();
+
+	if(buttons == polled->last)
+		return false;
+
+	polled->last = buttons;
+	event->time = Timer_Microseconds();
+	event->buttons = buttons;
+	return true;
+}
+
+static bool Read_Script(void* context, INPUTEVENT* event)
+{
+	/**************************************************************************
+	*  PreCondition: Input_Scripted_Source set up the context
+	* PostCondition: The next event will be filled in and true returned once
+	*                  it is due, otherwise false
+	*   Description: Plays back a script
+	*     Algorithm: If the next event's time has come, report it stamped
+	*                  with the time it was due and move on
+	**************************************************************************/
+	INPUTSCRIPT* script = (INPUTSCRIPT*)context;
+
+	if(script->next >= script->count ||
+		script->started + script->events[script->next].time > Timer_Microseconds())
+		return false;
+
+	event->time = script->started + script->events[script->next].time;
+	event->buttons = script->events[script->next].buttons;
+	script->next++;
+	return true;
+}
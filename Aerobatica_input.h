@@ -0,0 +1,113 @@
+/******************************************************************************
+*        Title: Aerobatica
+* Date Started: April 10th, 2009
+*    Developer: Liam Hagerty
+*       Module: Input Sampler Header
+*  Description: This module contains the input sampler. A thread of its own
+*                 reads an input source every millisecond and passes each
+*                 change of the buttons held, stamped with the time it
+*                 happened, through a lock-free ring to the simulation
+*                 thread. Each tick then takes exactly the changes stamped
+*                 before it ended, so a tap between two frames is never lost
+*                 and the tick it lands in doesn't depend on the frame rate.
+*
+*                 Sources only have to report changes, so any backend fits:
+*                 a polled device such as the DirectInput keyboard, a Linux
+*                 evdev device with the kernel's own timestamps, or a
+*                 script of timed changes for latency runs
+*      Version: 1.0
+******************************************************************************/
+#ifndef _INPUTSAMPLER_H
+#define _INPUTSAMPLER_H 1
+
+#pragma region Include Files
+#include <atomic>
+#include <thread>
+#include "Aerobatica_simulation.h" //Controls
+#include "Aerobatica_ringbuffer.h" //Change queue
+#pragma endregion
+
+#pragma region Constants
+//Button bits beyond the world's controls
+#define INPUT_CONFIRM 0x20 //Start from the title, play again
+#define INPUT_QUIT    0x40 //Leave the game
+#define INPUT_CONTROLS (INPUT_LEFT | INPUT_RIGHT | INPUT_UP | INPUT_DOWN | INPUT_FIRE) //Bits the world ticks on
+
+#define INPUT_EVENTS 1024    //Changes the queue holds, a power of two
+#define INPUT_SAMPLE_US 1000 //How often the sampler reads its source
+#pragma endregion
+
+//Input Event Structure, a change of the buttons held
+typedef struct
+{
+	long long time;    //Clock reading (microseconds) the change happened at
+	SIM_INPUT buttons; //Every button held from then on
+} INPUTEVENT;
+
+//Input Source Structure, a backend the sampler reads from. read fills in
+//the next change and returns true, or returns false if there is none yet
+typedef struct
+{
+	const char* name;
+	bool (*read)(void*, INPUTEVENT*);
+	void* context;
+} INPUTSOURCE;
+
+//Polled Source Structure, a function returning the buttons held now,
+//turned into changes stamped when they were seen
+typedef struct
+{
+	SIM_INPUT (*poll)();
+	SIM_INPUT last;
+} INPUTPOLLED;
+
+//Scripted Source Structure, changes played back at set times
+typedef struct
+{
+	const INPUTEVENT* events; //Times are microseconds after the start
+	int count;
+	int next;
+	long long started;        //Clock reading the script was started at
+} INPUTSCRIPT;
+
+//Evdev Source Structure, a Linux input device
+typedef struct
+{
+	int file;
+	SIM_INPUT buttons;
+} INPUTEVDEV;
+
+//Input Sampler Structure
+typedef struct
+{
+	INPUTSOURCE source;
+
+	//Sampler thread to simulation thread
+	RINGBUFFER events;
+	INPUTEVENT eventStorage[INPUT_EVENTS];
+	std::atomic<unsigned long> dropped; //Changes lost to a full queue
+	std::atomic<SIM_INPUT> latest;      //Buttons after the newest change, for other threads to glance at
+
+	std::thread thread;
+	std::atomic<bool> running;
+
+	//Used by the simulation thread alone
+	SIM_INPUT held;      //Buttons held at the end of the latest tick
+	bool waiting;        //A change popped that belongs to a later tick
+	INPUTEVENT next;
+	unsigned long consumed;                //Changes taken by ticks
+	long long totalLatency, worstLatency;  //Microseconds from a change to its tick taking it
+} INPUTSAMPLER;
+
+#pragma region Function Prototypes
+void Input_Init(INPUTSAMPLER*, const INPUTSOURCE*);
+void Input_Start(INPUTSAMPLER*);
+void Input_Stop(INPUTSAMPLER*);
+SIM_INPUT Input_For_Tick(INPUTSAMPLER*, long long);
+SIM_INPUT Input_Latest(const INPUTSAMPLER*);
+void Input_Polled_Source(INPUTSOURCE*, INPUTPOLLED*, SIM_INPUT (*)());
+void Input_Scripted_Source(INPUTSOURCE*, INPUTSCRIPT*, const INPUTEVENT*, int, long long);
+bool Input_Evdev_Source(INPUTSOURCE*, INPUTEVDEV*, const char*);
+void Input_Evdev_Close(INPUTEVDEV*);
+#pragma endregion
+#endif
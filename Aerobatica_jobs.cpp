@@ -0,0 +1,438 @@
+/******************************************************************************
+*        Title: Aerobatica
+* Date Started: April 10th, 2009
+*    Developer: Liam Hagerty
+*       Module: Job System Code Module
+*  Description: This module contains the worker threads, the lock-free
+*                 work-stealing deques (Chase-Lev) and the routines that
+*                 create, link, run and wait on jobs
+*      Version: 1.0
+******************************************************************************/
+#pragma region Includes
+#include "Aerobatica_jobs.h" //Job System Definitions Header
+#pragma endregion
+
+#pragma region Constants
+#define JOB_IDLE_SPINS 64 //Empty looks for work before a worker sleeps
+#pragma endregion
+
+#pragma region Global Variables
+static thread_local int jobThread = 0; //Queue of the calling thread, 0 for the owner
+#pragma endregion
+
+#pragma region Function Prototypes
+static void Worker_Main(JOBSYSTEM*, int);
+static JOB* Next_Job(JOBSYSTEM*, int);
+static void Run_Job(JOBSYSTEM*, JOB*);
+static void Finish_Job(JOBSYSTEM*, JOB*);
+static void Release_Job(JOBSYSTEM*, JOB*);
+static void Queue_Push(JOBSYSTEM*, JOBQUEUE*, JOB*);
+static JOB* Queue_Take(JOBQUEUE*);
+static JOB* Queue_Steal(JOBQUEUE*);
+#pragma endregion
+
+void Jobs_Init(JOBSYSTEM* system, int workerCount)
+{
+	/**************************************************************************
+	*  PreCondition: The system has been allocated (it is large, keep it
+	*                  static) and isn't running
+	* PostCondition: The workers will be started and waiting for jobs. The
+	*                  calling thread owns the system
+	*   Description: Starts the job system
+	*     Algorithm: Keep the worker count within bounds
+	*                Empty every queue and the job list
+	*                Start each worker on its own queue
+	**************************************************************************/
+	int queue;
+
+	if(workerCount < 0)
+		workerCount = 0;
+	if(workerCount > JOB_MAX_WORKERS)
+		workerCount = JOB_MAX_WORKERS;
+	system->workerCount = workerCount;
+
+	//empty everything
+	for(queue = 0; queue <= JOB_MAX_WORKERS; queue++)
+	{
+		system->queues[queue].top.store(0);
+		system->queues[queue].bottom.store(0);
+	}
+	system->jobsUsed.store(0);
+	system->queued.store(0);
+	system->sleeping.store(0);
+	system->running.store(true);
+	jobThread = 0;
+
+	//start the workers
+	for(queue = 1; queue <= workerCount; queue++)
+		system->workers[queue - 1] = std::thread(Worker_Main, system, queue);
+}
+
+void Jobs_Shutdown(JOBSYSTEM* system)
+{
+	/**************************************************************************
+	*  PreCondition: Jobs_Init has run and no jobs are outstanding
+	* PostCondition: Every worker will have stopped
+	*   Description: Stops the job system
+	*     Algorithm: Tell the workers to stop and wake any that are sleeping
+	*                Wait for each one to finish
+	**************************************************************************/
+	int worker;
+
+	system->running.store(false);
+	{
+		std::lock_guard<std::mutex> lock(system->sleepLock);
+	}
+	system->wake.notify_all();
+
+	for(worker = 0; worker < system->workerCount; worker++)
+		system->workers[worker].join();
+	system->workerCount = 0;
+}
+
+void Jobs_Reset(JOBSYSTEM* system)
+{
+	/**************************************************************************
+	*  PreCondition: Every job created since the last reset has finished
+	* PostCondition: The whole job list will be free again
+	*   Description: Called once a frame's or a tick's graph is done
+	*     Algorithm: Start handing out jobs from the front again
+	**************************************************************************/
+	system->jobsUsed.store(0);
+}
+
+int Jobs_Default_Workers()
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: The number of workers to start will be returned
+	*   Description: One worker per core besides the owning thread's
+	*     Algorithm: Ask how many threads the processor runs at once
+	**************************************************************************/
+	int cores = (int)std::thread::hardware_concurrency();
+
+	if(cores <= 1)
+		return 0;
+	return cores - 1 < JOB_MAX_WORKERS ? cores - 1 : JOB_MAX_WORKERS;
+}
+
+JOB* Job_Create(JOBSYSTEM* system, JOBFUNCTION function, void* data, int begin, int end, int chunk)
+{
+	/**************************************************************************
+	*  PreCondition: Jobs_Init has run
+	* PostCondition: A job covering rows begin to end - 1 will be returned,
+	*                  not yet submitted, or NULL if the job list is used up
+	*   Description: Makes a job. With a chunk size it will be cut into
+	*                  pieces of that many rows (counted from begin) when it
+	*                  runs, each of which may run on a different thread
+	*     Algorithm: Claim the next free job
+	*                Fill it in, holding it back until Job_Submit
+	**************************************************************************/
+	int index = system->jobsUsed.fetch_add(1);
+	JOB* job;
+
+	if(index >= JOB_CAPACITY)
+		return NULL;
+
+	job = &system->jobs[index];
+	job->function = function;
+	job->data = data;
+	job->begin = begin;
+	job->end = end;
+	job->chunk = chunk;
+	job->parent = NULL;
+	job->unfinished.store(1);
+	job->waitingOn.store(1); //released by Job_Submit
+	job->dependentCount = 0;
+
+	return job;
+}
+
+void Job_Depends(JOB* job, JOB* prerequisite)
+{
+	/**************************************************************************
+	*  PreCondition: Neither job has been submitted yet
+	* PostCondition: The job won't start until the prerequisite (and all its
+	*                  chunks) has finished
+	*   Description: Adds an edge to the dependency graph
+	*     Algorithm: Note the job on the prerequisite's list
+	*                Count one more job it is waiting on
+	**************************************************************************/
+	prerequisite->dependents[prerequisite->dependentCount++] = job;
+	job->waitingOn.fetch_add(1);
+}
+
+void Job_Submit(JOBSYSTEM* system, JOB* job)
+{
+	/**************************************************************************
+	*  PreCondition: Called from the owning thread or inside a running job
+	* PostCondition: The job will run once everything it depends on has
+	*                  finished
+	*   Description: Hands a job to the system
+	*     Algorithm: Lift the hold Job_Create put on it, queueing it if
+	*                  nothing else is holding it back
+	**************************************************************************/
+	Release_Job(system, job);
+}
+
+void Job_Wait(JOBSYSTEM* system, JOB* job)
+{
+	/**************************************************************************
+	*  PreCondition: The job has been submitted by this thread
+	* PostCondition: The job and all its chunks will have finished
+	*   Description: Waits for a job, running other jobs meanwhile so the
+	*                  waiting thread is never idle
+	*     Algorithm: Until the job is finished,
+	*                  Run the next job this thread can find
+	**************************************************************************/
+	while(job->unfinished.load(std::memory_order_acquire) > 0)
+	{
+		JOB* next = Next_Job(system, jobThread);
+
+		if(next != NULL)
+			Run_Job(system, next);
+		else
+			std::this_thread::yield();
+	}
+}
+
+static void Worker_Main(JOBSYSTEM* system, int queue)
+{
+	/**************************************************************************
+	*  PreCondition: Started by Jobs_Init
+	* PostCondition: The worker will have run jobs until shut down
+	*   Description: Worker thread body
+	*     Algorithm: Claim the queue
+	*                Until the system stops,
+	*                  Run the next job this worker can find
+	*                  After a run of finding nothing, sleep until a job is
+	*                    queued
+	**************************************************************************/
+	int idle = 0;
+
+	jobThread = queue;
+
+	while(system->running.load(std::memory_order_relaxed))
+	{
+		JOB* job = Next_Job(system, queue);
+
+		if(job != NULL)
+		{
+			Run_Job(system, job);
+			idle = 0;
+		}
+		else if(++idle < JOB_IDLE_SPINS)
+			std::this_thread::yield();
+		else
+		{
+			std::unique_lock<std::mutex> lock(system->sleepLock);
+
+			system->sleeping.fetch_add(1);
+			system->wake.wait(lock, [system] {
+				return system->queued.load() > 0 || !system->running.load(); });
+			system->sleeping.fetch_sub(1);
+			idle = 0;
+		}
+	}
+}
+
+static JOB* Next_Job(JOBSYSTEM* system, int queue)
+{
+	/**************************************************************************
+	*  PreCondition: queue belongs to the calling thread
+	* PostCondition: A job to run will be returned, or NULL if there was none
+	*   Description: Finds work for a thread
+	*     Algorithm: Take the newest job on the thread's own queue
+	*                Otherwise try stealing the oldest from each other queue
+	**************************************************************************/
+	int queues = system->workerCount + 1;
+	JOB* job = Queue_Take(&system->queues[queue]);
+	int victim;
+
+	for(victim = 1; job == NULL && victim < queues; victim++)
+		job = Queue_Steal(&system->queues[(queue + victim) % queues]);
+
+	if(job != NULL)
+		system->queued.fetch_sub(1);
+
+	return job;
+}
+
+static void Run_Job(JOBSYSTEM* system, JOB* job)
+{
+	/**************************************************************************
+	*  PreCondition: The job was taken from a queue
+	* PostCondition: The job's rows will be done, or cut into chunks that are
+	*                  queued
+	*   Description: Runs one job
+	*     Algorithm: If it has a chunk size and more rows than that,
+	*                  Queue a chunk job for each run of chunk rows (any that
+	*                    can't be made are run here instead)
+	*                Otherwise call its function on its rows
+	*                Mark this part finished
+	**************************************************************************/
+	if(job->chunk > 0 && job->end - job->begin > job->chunk)
+	{
+		int begin;
+
+		for(begin = job->begin; begin < job->end; begin += job->chunk)
+		{
+			int end = job->end - begin > job->chunk ? begin + job->chunk : job->end;
+			JOB* piece = Job_Create(system, job->function, job->data, begin, end, 0);
+
+			if(piece == NULL)
+			{
+				job->function(job->data, begin, end);
+				continue;
+			}
+			piece->parent = job;
+			job->unfinished.fetch_add(1);
+			Job_Submit(system, piece);
+		}
+	}
+	else
+		job->function(job->data, job->begin, job->end);
+
+	Finish_Job(system, job);
+}
+
+static void Finish_Job(JOBSYSTEM* system, JOB* job)
+{
+	/**************************************************************************
+	*  PreCondition: Part of the job (itself or a chunk) has finished
+	* PostCondition: If that was the last part, the jobs waiting on it will
+	*                  be released and its parent told
+	*   Description: Completion bookkeeping
+	*     Algorithm: Copy out the links (once the count reaches zero a waiter
+	*                  may reset the job list and reuse this job)
+	*                Count the part off
+	*                If none are left,
+	*                  Release each dependent
+	*                  Finish this part of the parent
+	**************************************************************************/
+	JOB* dependents[JOB_MAX_DEPENDENTS];
+	JOB* parent = job->parent;
+	int dependentCount = job->dependentCount;
+	int dependent;
+
+	for(dependent = 0; dependent < dependentCount; dependent++)
+		dependents[dependent] = job->dependents[dependent];
+
+	if(job->unfinished.fetch_sub(1, std::memory_order_acq_rel) != 1)
+		return;
+
+	for(dependent = 0; dependent < dependentCount; dependent++)
+		Release_Job(system, dependents[dependent]);
+
+	if(parent != NULL)
+		Finish_Job(system, parent);
+}
+
+static void Release_Job(JOBSYSTEM* system, JOB* job)
+{
+	/**************************************************************************
+	*  PreCondition: One of the things the job was waiting on is done
+	* PostCondition: If it was the last, the job will be queued
+	*   Description: Lets a job through once nothing holds it back
+	*     Algorithm: Count the hold off
+	*                If none are left, push it on the calling thread's queue
+	**************************************************************************/
+	if(job->waitingOn.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		Queue_Push(system, &system->queues[jobThread], job);
+}
+
+static void Queue_Push(JOBSYSTEM* system, JOBQUEUE* queue, JOB* job)
+{
+	/**************************************************************************
+	*  PreCondition: The queue belongs to the calling thread and isn't full
+	* PostCondition: The job will be on the bottom of the queue and a
+	*                  sleeping worker woken
+	*   Description: Owner end of the deque
+	*     Algorithm: Count it as queued (first, so the count is never short)
+	*                Store the job past the bottom
+	*                Publish it by moving the bottom down (release)
+	*                Wake a worker if any sleep
+	**************************************************************************/
+	long bottom = queue->bottom.load(std::memory_order_relaxed);
+
+	system->queued.fetch_add(1);
+	queue->slots[bottom & (JOB_QUEUE_SIZE - 1)].store(job, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	queue->bottom.store(bottom + 1, std::memory_order_relaxed);
+
+	if(system->sleeping.load() > 0)
+	{
+		//taking the lock means a worker between its check and its wait
+		//can't miss the wake up
+		{
+			std::lock_guard<std::mutex> lock(system->sleepLock);
+		}
+		system->wake.notify_one();
+	}
+}
+
+static JOB* Queue_Take(JOBQUEUE* queue)
+{
+	/**************************************************************************
+	*  PreCondition: The queue belongs to the calling thread
+	* PostCondition: The newest job will be removed and returned, or NULL if
+	*                  the queue was empty or a thief got the last one
+	*   Description: Owner end of the deque
+	*     Algorithm: Claim the bottom slot
+	*                If it was the only job left, race the thieves for it
+	*                  by moving the top past it
+	*                If there was nothing, put the bottom back
+	**************************************************************************/
+	long bottom = queue->bottom.load(std::memory_order_relaxed) - 1;
+	long top;
+	JOB* job = NULL;
+
+	queue->bottom.store(bottom, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	top = queue->top.load(std::memory_order_relaxed);
+
+	if(top <= bottom)
+	{
+		job = queue->slots[bottom & (JOB_QUEUE_SIZE - 1)].load(std::memory_order_relaxed);
+		if(top == bottom)
+		{
+			//last job, a thief may be after it too
+			if(!queue->top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+				std::memory_order_relaxed))
+				job = NULL;
+			queue->bottom.store(bottom + 1, std::memory_order_relaxed);
+		}
+	}
+	else
+		queue->bottom.store(bottom + 1, std::memory_order_relaxed);
+
+	return job;
+}
+
+static JOB* Queue_Steal(JOBQUEUE* queue)
+{
+	/**************************************************************************
+	*  PreCondition: None, any thread may steal
+	* PostCondition: The oldest job will be removed and returned, or NULL if
+	*                  the queue was empty or another thread won it
+	*   Description: Thief end of the deque
+	*     Algorithm: Read the top, then the bottom
+	*                If there is a job between them, read it and claim it by
+	*                  moving the top past it
+	**************************************************************************/
+	long top = queue->top.load(std::memory_order_acquire);
+	long bottom;
+	JOB* job;
+
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	bottom = queue->bottom.load(std::memory_order_acquire);
+	if(top >= bottom)
+		return NULL;
+
+	job = queue->slots[top & (JOB_QUEUE_SIZE - 1)].load(std::memory_order_relaxed);
+	if(!queue->top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+		std::memory_order_relaxed))
+		return NULL;
+
+	return job;
+}
@@ -0,0 +1,91 @@
+/******************************************************************************
+*        Title: Aerobatica
+* Date Started: April 10th, 2009
+*    Developer: Liam Hagerty
+*       Module: Job System Header
+*  Description: This module contains the work-stealing job system the tick
+*                 and the renderer split their passes over. Each thread owns
+*                 a lock-free deque of jobs, works from its own end and
+*                 steals from the far end of the others' when it runs dry.
+*
+*                 A job covers a range of rows. Given a chunk size it is cut
+*                 into fixed chunks when it runs, so the same rows always
+*                 land in the same chunk whatever the number of threads, and
+*                 a job can wait on others finishing before it starts, so
+*                 the passes of a tick form a dependency graph
+*      Version: 1.0
+******************************************************************************/
+#ifndef _JOBS_H
+#define _JOBS_H 1
+
+#pragma region Include Files
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#pragma endregion
+
+#pragma region Constants
+#define JOB_CAPACITY 4096     //Jobs that can exist between Jobs_Reset calls
+#define JOB_QUEUE_SIZE 4096   //Jobs each thread can have queued, a power of two
+#define JOB_MAX_WORKERS 63    //Threads besides the one that owns the system
+#define JOB_MAX_DEPENDENTS 8  //Jobs that can wait on any one job
+#define JOB_CACHE_LINE 64
+#pragma endregion
+
+//Work done by a job on rows begin to end - 1
+typedef void (*JOBFUNCTION)(void*, int, int);
+
+//Job Structure
+typedef struct JOB
+{
+	JOBFUNCTION function;
+	void* data;
+	int begin, end;
+	int chunk;                     //Rows per piece it is cut into, 0 to run whole
+	struct JOB* parent;            //Job this one is a chunk of
+	std::atomic<int> unfinished;   //Itself plus its chunks still to finish
+	std::atomic<int> waitingOn;    //Jobs that must finish before it can start
+	struct JOB* dependents[JOB_MAX_DEPENDENTS];
+	int dependentCount;
+} JOB;
+
+//One thread's deque, the owner pushes and takes at the bottom, thieves
+//take from the top
+typedef struct
+{
+	std::atomic<long> top;
+	char topPadding[JOB_CACHE_LINE - sizeof(std::atomic<long>)];
+	std::atomic<long> bottom;
+	char bottomPadding[JOB_CACHE_LINE - sizeof(std::atomic<long>)];
+	std::atomic<JOB*> slots[JOB_QUEUE_SIZE];
+} JOBQUEUE;
+
+//Job System Structure
+typedef struct
+{
+	int workerCount;
+	JOBQUEUE queues[JOB_MAX_WORKERS + 1]; //Queue 0 belongs to the owning thread
+	JOB jobs[JOB_CAPACITY];
+	std::atomic<int> jobsUsed;
+	std::thread workers[JOB_MAX_WORKERS];
+	std::atomic<bool> running;
+
+	//Idle workers sleep until a job is queued
+	std::mutex sleepLock;
+	std::condition_variable wake;
+	std::atomic<int> queued;   //Jobs queued and not yet taken
+	std::atomic<int> sleeping; //Workers waiting on wake
+} JOBSYSTEM;
+
+#pragma region Function Prototypes
+void Jobs_Init(JOBSYSTEM*, int);
+void Jobs_Shutdown(JOBSYSTEM*);
+void Jobs_Reset(JOBSYSTEM*);
+int Jobs_Default_Workers();
+JOB* Job_Create(JOBSYSTEM*, JOBFUNCTION, void*, int, int, int);
+void Job_Depends(JOB*, JOB*);
+void Job_Submit(JOBSYSTEM*, JOB*);
+void Job_Wait(JOBSYSTEM*, JOB*);
+#pragma endregion
+#endif
@@ -0,0 +1,340 @@
+/******************************************************************************
+*        Title: Aerobatica
+* Date Started: April 10th, 2009
+*    Developer: Liam Hagerty
+*       Module: Level Code Module
+*  Description: This module contains the routines that map a compiled level
+*                 into memory and check its header, and the built-in level
+*                 used when there is no level file
+*      Version: 1.0
+******************************************************************************/
+#pragma region Includes
+#include <string.h>
+#include "Aerobatica_level.h"    //Level Definitions Header
+#include "Aerobatica_entities.h" //Entity types
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#pragma endregion
+
+//the tables are used in place, so their layout is part of the file format
+static_assert(sizeof(ATLASRECT) == 8, "ATLASRECT must match the level file");
+static_assert(sizeof(ARCHETYPE) == 28, "ARCHETYPE must match the level file");
+static_assert(sizeof(LEVELSPAWN) == 12, "LEVELSPAWN must match the level file");
+static_assert(sizeof(LEVELWAVE) == 8, "LEVELWAVE must match the level file");
+static_assert(sizeof(FRAMEMASK) == 8, "FRAMEMASK must match the level file");
+static_assert(sizeof(LEVELHEADER) == 80, "LEVELHEADER must match the level file");
+static_assert(ENTITY_TYPE_COUNT <= LEVEL_TYPE_SLOTS, "Every entity type needs a frame slot");
+
+#pragma region Global Variables
+static const char levelMagic[4] = { 'A', 'E', 'R', 'L' };
+
+//The original cast, four planes attacking in turn
+static const ATLASRECT builtinFrames[FRAME_COUNT] =
+{
+	{ 0, 0, 0, 0 },          //None
+	{ 22, 33, 144, 76 },     //Player Jet
+	{ 36, 526, 174, 557 },   //Vulcan Jet
+	{ 38, 782, 165, 812 },   //Missile Jet
+	{ 29, 1078, 170, 1120 }, //Helicopter
+	{ 0, 249, 335, 345 },    //Bomber
+	{ 584, 307, 945, 343 }   //Bullet
+};
+
+static const ARCHETYPE builtinArchetypes[] =
+{
+	//type right behavior                pad width height xSpd              ySpd              xAcc yAcc
+	{ 0, 1, BEHAVIOR_NONE,              0, 126, 47, FIXED_PIXELS(5),  FIXED_PIXELS(5),  0, 0 }, //Player Jet
+	{ 1, 0, BEHAVIOR_VERTICAL_BOUNCE,   0, 140, 33, 0,                FIXED_PIXELS(5),  0, 0 }, //Vulcan Jet
+	{ 2, 0, BEHAVIOR_HORIZONTAL_BOUNCE, 0, 128, 32, FIXED_PIXELS(-5), 0,                0, 0 }, //Unguided Missile Jet
+	{ 3, 1, BEHAVIOR_DIAGONAL_BOUNCE,   0, 144, 41, FIXED_PIXELS(5),  FIXED_PIXELS(5),  0, 0 }, //Helicopter
+	{ 4, 0, BEHAVIOR_PATROL,            0, 309, 98, 0,                FIXED_PIXELS(-5), 0, 0 }  //Bomber
+};
+
+static const LEVELSPAWN builtinSpawns[] =
+{
+	//archetype delay x y
+	{ 0, 0, 100, 350 },  //Player Jet
+	{ 1, 0, 700, -100 }, //Vulcan Jet
+	{ 2, 0, 1100, 600 }, //Unguided Missile Jet
+	{ 3, 0, -200, 200 }, //Helicopter
+	{ 4, 0, 500, 800 }   //Bomber
+};
+
+static const LEVELWAVE builtinWaves[] =
+{
+	{ 1, 1 }, //Vulcan Jet
+	{ 2, 1 }, //Unguided Missile Jet
+	{ 3, 1 }, //Helicopter
+	{ 4, 1 }  //Bomber
+};
+
+static const LEVELHEADER builtinHeader =
+{
+	{ 'A', 'E', 'R', 'L' }, LEVEL_VERSION, LEVEL_BYTE_ORDER, 0,
+	FRAME_COUNT, 0,
+	sizeof(builtinArchetypes) / sizeof(ARCHETYPE), 0,
+	sizeof(builtinWaves) / sizeof(LEVELWAVE), 0,
+	sizeof(builtinSpawns) / sizeof(LEVELSPAWN), 0,
+	0, 0, 0, //Hit boxes are solid, there is no sprite sheet to cut masks from
+	0,
+	{
+		FRAME_PLAYER_JET,  //Player Jet
+		FRAME_VULCAN_JET,  //Vulcan Jet
+		FRAME_MISSILE_JET, //Missile Jet
+		FRAME_HELICOPTER,  //Helicopter
+		FRAME_BOMBER,      //Bomber
+		FRAME_BULLET,      //Player Bullet
+		FRAME_BULLET,      //Enemy Bullet
+		FRAME_BULLET,      //Missile, drawn as a bullet until it has artwork
+		FRAME_BULLET       //Homing Missile
+	}
+};
+
+static const LEVEL builtinLevel =
+{
+	&builtinHeader, builtinFrames, builtinArchetypes, builtinWaves, builtinSpawns, NULL, NULL,
+	NULL, 0, NULL, NULL
+};
+#pragma endregion
+
+#pragma region Function Prototypes
+static bool Table_Fits(uint32_t, uint32_t, size_t, size_t);
+static bool Masks_Fit(const LEVELHEADER*, const unsigned char*, size_t);
+#pragma endregion
+
+bool Level_Open(LEVEL* level, const char* path)
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: The level file will be mapped read-only and its tables
+	*                  ready to use, returns false (with nothing left open) if
+	*                  it can't be mapped or isn't a level of this version
+	*   Description: Loads a compiled level without reading or parsing it,
+	*                  pages are only brought in as the game touches them
+	*     Algorithm: Open the file and find its size
+	*                Map the whole of it
+	*                Bind() the tables to the mapping
+	**************************************************************************/
+	memset(level, 0, sizeof(LEVEL));
+
+#ifdef _WIN32
+	LARGE_INTEGER size;
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL, NULL);
+	HANDLE mapping;
+
+	if(file == INVALID_HANDLE_VALUE)
+		return false;
+	if(!GetFileSizeEx(file, &size) || size.QuadPart < (LONGLONG)sizeof(LEVELHEADER) ||
+		(mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL)) == NULL)
+	{
+		CloseHandle(file);
+		return false;
+	}
+	level->file = file;
+	level->mapping = mapping;
+	level->size = (size_t)size.QuadPart;
+	level->view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+	struct stat status;
+	int file = open(path, O_RDONLY);
+	void* view;
+
+	if(file < 0)
+		return false;
+	if(fstat(file, &status) != 0 || status.st_size < (off_t)sizeof(LEVELHEADER))
+	{
+		close(file);
+		return false;
+	}
+	view = mmap(NULL, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	close(file); //the mapping keeps the file open
+	level->size = (size_t)status.st_size;
+	level->view = view != MAP_FAILED ? view : NULL;
+#endif
+
+	//check the header and find the tables
+	if(level->view == NULL || !Level_Bind(level, level->view, level->size))
+	{
+		Level_Close(level);
+		return false;
+	}
+
+	return true;
+}
+
+void Level_Close(LEVEL* level)
+{
+	/**************************************************************************
+	*  PreCondition: Level_Open has run on the level, and nothing is using it
+	* PostCondition: The mapping will be released
+	*   Description: Unloads a level opened from a file
+	*     Algorithm: Unmap the view
+	*                Close the mapping and the file, on Windows
+	**************************************************************************/
+#ifdef _WIN32
+	if(level->view != NULL)
+		UnmapViewOfFile(level->view);
+	if(level->mapping != NULL)
+		CloseHandle((HANDLE)level->mapping);
+	if(level->file != NULL)
+		CloseHandle((HANDLE)level->file);
+#else
+	if(level->view != NULL)
+		munmap(level->view, level->size);
+#endif
+
+	memset(level, 0, sizeof(LEVEL));
+}
+
+bool Level_Bind(LEVEL* level, const void* bytes, size_t size)
+{
+	/**************************************************************************
+	*  PreCondition: bytes holds size bytes of a compiled level, 4-byte
+	*                  aligned (a mapping always is)
+	* PostCondition: The level's tables will point into the bytes, returns
+	*                  false if they aren't a level this build can use
+	*   Description: Checks a level in constant time, the records themselves
+	*                  are checked as they are used
+	*     Algorithm: Check the magic, version and byte order
+	*                Make sure each table lies inside the file, aligned
+	*                Make sure each type's frame exists, and any masks fit
+	*                Point the tables at their offsets
+	*                Make sure the player starts as a plane that only the
+	*                  controls move
+	**************************************************************************/
+	const unsigned char* base = (const unsigned char*)bytes;
+	const LEVELHEADER* header = (const LEVELHEADER*)bytes;
+	const LEVELSPAWN* player;
+	int type;
+
+	//is it a level from this version of the compiler, for this machine
+	if(size < sizeof(LEVELHEADER) || memcmp(header->magic, levelMagic, sizeof(levelMagic)) != 0 ||
+		header->version != LEVEL_VERSION || header->byteOrder != LEVEL_BYTE_ORDER ||
+		header->fileBytes != size)
+		return false;
+
+	//do the tables fit
+	if(header->frameCount == 0 || header->frameCount > LEVEL_MAX_FRAMES || header->archetypeCount == 0 ||
+		header->playerSpawn >= header->spawnCount ||
+		!Table_Fits(header->frameOffset, header->frameCount, sizeof(ATLASRECT), size) ||
+		!Table_Fits(header->archetypeOffset, header->archetypeCount, sizeof(ARCHETYPE), size) ||
+		!Table_Fits(header->waveOffset, header->waveCount, sizeof(LEVELWAVE), size) ||
+		!Table_Fits(header->spawnOffset, header->spawnCount, sizeof(LEVELSPAWN), size))
+		return false;
+	for(type = 0; type < LEVEL_TYPE_SLOTS; type++)
+		if(header->typeFrames[type] >= header->frameCount)
+			return false;
+	if(header->maskOffset != 0 && !Masks_Fit(header, base, size))
+		return false;
+
+	level->header = header;
+	level->frames = (const ATLASRECT*)(base + header->frameOffset);
+	level->archetypes = (const ARCHETYPE*)(base + header->archetypeOffset);
+	level->waves = (const LEVELWAVE*)(base + header->waveOffset);
+	level->spawns = (const LEVELSPAWN*)(base + header->spawnOffset);
+	level->masks = header->maskOffset != 0 ? (const FRAMEMASK*)(base + header->maskOffset) : NULL;
+	level->maskWords = header->maskOffset != 0 ?
+		(const uint64_t*)(base + header->maskWordOffset) : NULL;
+
+	//the player's jet has to exist for a round to start, and fly no
+	//behavior of its own so it keeps the store's first row
+	player = &level->spawns[header->playerSpawn];
+	if(player->archetype >= header->archetypeCount ||
+		level->archetypes[player->archetype].type >= ENTITY_TYPE_COUNT ||
+		(entityTypeFlags[level->archetypes[player->archetype].type] & TYPE_PROJECTILE) ||
+		level->archetypes[player->archetype].behavior != BEHAVIOR_NONE)
+		return false;
+
+	return true;
+}
+
+const LEVEL* Level_Builtin()
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: The level compiled into the game will be returned
+	*   Description: The original cast, used when no level file is loaded
+	*     Algorithm: Return the constant tables
+	**************************************************************************/
+	return &builtinLevel;
+}
+
+void Level_Mask(const LEVEL* level, int type, bool faceRight, COLLISIONMASK* mask)
+{
+	/**************************************************************************
+	*  PreCondition: The level has been bound
+	* PostCondition: mask will hold the collision mask of the frame the
+	*                  entity type is drawn with, turned the way it faces,
+	*                  or be solid if there isn't one
+	*   Description: Looks up the pixels an entity can be hit in
+	*     Algorithm: Solid if the level has no masks or the type's frame
+	*                  has an empty one
+	*                Otherwise point at the frame's rows, skipping past the
+	*                  right-facing rows for a left-facing entity
+	**************************************************************************/
+	const FRAMEMASK* frame;
+
+	mask->rows = NULL;
+	mask->width = mask->height = mask->rowWords = 0;
+	if(level->masks == NULL || type < 0 || type >= LEVEL_TYPE_SLOTS)
+		return;
+	frame = &level->masks[level->header->typeFrames[type]];
+	if(frame->width == 0 || frame->height == 0)
+		return;
+
+	mask->width = frame->width;
+	mask->height = frame->height;
+	mask->rowWords = (frame->width + 63) / 64;
+	mask->rows = level->maskWords + frame->firstWord +
+		(faceRight ? 0 : mask->rowWords * mask->height);
+}
+
+static bool Masks_Fit(const LEVELHEADER* header, const unsigned char* base, size_t size)
+{
+	/**************************************************************************
+	*  PreCondition: header's frame table has been checked
+	* PostCondition: Returns whether the mask table and every mask's rows,
+	*                  both ways round, lie inside the mask words
+	*   Description: Bounds check for the masks, so Level_Mask() never has to
+	*     Algorithm: Check the tables fit, the words 8-byte aligned
+	*                Check each frame's rows end within the words
+	**************************************************************************/
+	const FRAMEMASK* masks = (const FRAMEMASK*)(base + header->maskOffset);
+	uint32_t frame;
+
+	if(!Table_Fits(header->maskOffset, header->frameCount, sizeof(FRAMEMASK), size) ||
+		header->maskWordOffset % 8 != 0 ||
+		!Table_Fits(header->maskWordOffset, header->maskWordCount, sizeof(uint64_t), size))
+		return false;
+	for(frame = 0; frame < header->frameCount; frame++)
+		if(masks[frame].firstWord > header->maskWordCount ||
+			2ULL * ((masks[frame].width + 63) / 64) * masks[frame].height >
+			header->maskWordCount - masks[frame].firstWord)
+			return false;
+
+	return true;
+}
+
+static bool Table_Fits(uint32_t offset, uint32_t count, size_t recordSize, size_t size)
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: Returns whether count records starting at offset lie
+	*                  within size bytes and are 4-byte aligned
+	*   Description: Bounds check for one table of a level file
+	*     Algorithm: Check the alignment
+	*                Compare the table's length with the room after its
+	*                  offset (without adding, so nothing can overflow)
+	**************************************************************************/
+	if(offset % 4 != 0 || offset > size)
+		return false;
+
+	return count <= (size - offset) / recordSize;
+}
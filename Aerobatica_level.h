@@ -0,0 +1,135 @@
+/******************************************************************************
+*        Title: Aerobatica
+* Date Started: April 10th, 2009
+*    Developer: Liam Hagerty
+*       Module: Level Header
+*  Description: This module contains the compiled level format. A level
+*                 holds the sprite sheet frames, the enemy archetypes (size,
+*                 fixed-point speed and acceleration, facing and movement
+*                 pattern of each kind of plane), where the player starts
+*                 and the waves of planes to send in, each plane a number of
+*                 ticks into its wave. It is written offline by the level
+*                 compiler as one flat, versioned, little-endian file of
+*                 fixed-size records, which is mapped into memory and used
+*                 where it lies, so opening a level only checks the header
+*                 however many waves it holds.
+*
+*                 Layout: a LEVELHEADER, then the frame, archetype, wave and
+*                 spawn tables at the offsets it gives, each 4-byte aligned.
+*                 A level compiled with its sprite sheet also has a mask
+*                 per frame and the 8-byte aligned mask words they index
+*      Version: 1.0
+******************************************************************************/
+#ifndef _LEVEL_H
+#define _LEVEL_H 1
+
+#pragma region Include Files
+#include <stddef.h>
+#include <stdint.h>
+#include "Aerobatica_collision.h" //Collision masks
+#pragma endregion
+
+#pragma region Constants
+#define LEVEL_VERSION 4
+#define LEVEL_BYTE_ORDER 0x01020304UL //Reads differently on a big-endian machine
+#define LEVEL_TYPE_SLOTS 16           //Entity types the header has a frame for
+#define LEVEL_MAX_FRAMES 256          //Frames a draw record can name
+#define LEVEL_FILE_EXTENSION ".aerolevel"
+#pragma endregion
+
+//Frames on the built-in sprite sheet
+typedef enum
+{
+	FRAME_NONE,
+	FRAME_PLAYER_JET,
+	FRAME_VULCAN_JET,
+	FRAME_MISSILE_JET,
+	FRAME_HELICOPTER,
+	FRAME_BOMBER,
+	FRAME_BULLET,
+	FRAME_COUNT
+} ATLAS_FRAME_ID;
+
+//Where a frame sits on the sprite sheet, drawn facing right
+typedef struct
+{
+	int16_t left, top, right, bottom;
+} ATLASRECT;
+
+//Where a frame's collision mask sits in the mask words, the rows facing
+//right and then the same rows mirrored to face left
+typedef struct
+{
+	uint16_t width, height; //0 for a frame without a mask
+	uint32_t firstWord;
+} FRAMEMASK;
+
+//One kind of plane
+typedef struct
+{
+	uint8_t type;      //ENTITY_TYPE it behaves as
+	uint8_t faceRight;
+	uint8_t behavior;  //ENTITY_BEHAVIOR it flies
+	uint8_t reserved;
+	int32_t width, height;
+	int32_t xSpeed, ySpeed;               //16.16 pixels per tick
+	int32_t xAcceleration, yAcceleration; //16.16 pixels per tick per tick
+} ARCHETYPE;
+
+//One plane placed in a wave
+typedef struct
+{
+	uint16_t archetype;
+	uint16_t delay; //Ticks after its wave starts
+	int32_t xCoordinate, yCoordinate;
+} LEVELSPAWN;
+
+//A run of spawns started together once the last wave is down
+typedef struct
+{
+	uint32_t firstSpawn, spawnCount;
+} LEVELWAVE;
+
+//Level File Header
+typedef struct
+{
+	char magic[4];                //"AERL"
+	uint32_t version;             //LEVEL_VERSION
+	uint32_t byteOrder;           //LEVEL_BYTE_ORDER
+	uint32_t fileBytes;
+	uint32_t frameCount, frameOffset;
+	uint32_t archetypeCount, archetypeOffset;
+	uint32_t waveCount, waveOffset;
+	uint32_t spawnCount, spawnOffset;
+	uint32_t maskOffset;          //frameCount FRAMEMASKs, 0 for solid boxes
+	uint32_t maskWordCount, maskWordOffset;
+	uint32_t playerSpawn;         //Spawn the player's jet starts from
+	uint8_t typeFrames[LEVEL_TYPE_SLOTS]; //Frame each entity type is drawn with
+} LEVELHEADER;
+
+//Level Structure, tables point straight into the mapped file
+typedef struct
+{
+	const LEVELHEADER* header;
+	const ATLASRECT* frames;
+	const ARCHETYPE* archetypes;
+	const LEVELWAVE* waves;
+	const LEVELSPAWN* spawns;
+	const FRAMEMASK* masks;   //NULL if the level has none
+	const uint64_t* maskWords;
+
+	//the mapping, NULL for levels that aren't from a file
+	void* view;
+	size_t size;
+	void* file;
+	void* mapping;
+} LEVEL;
+
+#pragma region Function Prototypes
+bool Level_Open(LEVEL*, const char*);
+void Level_Close(LEVEL*);
+bool Level_Bind(LEVEL*, const void*, size_t);
+const LEVEL* Level_Builtin();
+void Level_Mask(const LEVEL*, int, bool, COLLISIONMASK*);
+#pragma endregion
+#endif
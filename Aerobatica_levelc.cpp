@@ -0,0 +1,752 @@
+/******************************************************************************
+*        Title: Aerobatica
+* Date Started: April 10th, 2009
+*    Developer: Liam Hagerty
+*       Module: Level Compiler
+*  Description: This module turns a level's text description into the flat
+*                 binary the game maps at start-up, so all the parsing and
+*                 name lookups happen here, offline, and never in the game.
+*
+*                 Source lines (# starts a comment):
+*                   frame <name> <left> <top> <right> <bottom>
+*                   draw <entity type> <frame name>
+*                   archetype <name> <entity type> <behavior> <width>
+*                             <height> <x speed> <y speed> <left|right>
+*                             [<x acceleration> <y acceleration>]
+*                     speeds are pixels per tick and accelerations pixels
+*                     per tick per tick, either can have a fraction (2.25)
+*                   player <archetype> <x> <y>
+*                     the archetype has to fly "none", the controls move it
+*                   wave
+*                   spawn <archetype> <x> <y> [delay]
+*                     adds a plane to the last wave, delay ticks after the
+*                     wave starts
+*                   sheet <tolerance> <bitmap file>
+*                     cuts a collision mask for every frame out of the
+*                     sprite sheet, an uncompressed 24 or 32-bit .bmp. A
+*                     pixel within tolerance of white on every channel
+*                     (the colour key the sheet is drawn with) is
+*                     see-through. Without it hit boxes are solid
+*
+*                 Frame "none" is always frame 0, an entity type without a
+*                 draw line is not drawn
+*        Usage: Aerobatica_levelc <source> <output.aerolevel>
+*      Version: 1.0
+******************************************************************************/
+#pragma region Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Aerobatica_level.h"    //Level file format
+#include "Aerobatica_entities.h" //Entity types and behaviors
+#include "Aerobatica_schedule.h" //Spawns a wave can hold
+#pragma endregion
+
+#pragma region Constants
+#define LEVELC_NAME_LENGTH 32
+#define LEVELC_LINE_LENGTH 256
+#define LEVELC_MAX_ARCHETYPES 1024
+#define LEVELC_MAX_WAVES 65536
+#define LEVELC_MAX_SPAWNS 262144
+#define LEVELC_MAX_DELAY 65535
+#define LEVELC_MAX_PIXELS 32767 //Largest whole part of a fixed-point value
+#define LEVELC_MAX_DIGITS 9     //Fraction digits a fixed-point value can have
+#define LEVELC_MAX_SHEET 16384  //Widest and tallest sprite sheet
+#pragma endregion
+
+//Level Source Structure, the tables as they are read
+typedef struct
+{
+	char frameNames[LEVEL_MAX_FRAMES][LEVELC_NAME_LENGTH];
+	ATLASRECT frames[LEVEL_MAX_FRAMES];
+	int frameCount;
+	char archetypeNames[LEVELC_MAX_ARCHETYPES][LEVELC_NAME_LENGTH];
+	ARCHETYPE archetypes[LEVELC_MAX_ARCHETYPES];
+	int archetypeCount;
+	LEVELWAVE waves[LEVELC_MAX_WAVES];
+	int waveCount;
+	LEVELSPAWN spawns[LEVELC_MAX_SPAWNS];
+	int spawnCount;
+	int playerSpawn;
+	unsigned char typeFrames[LEVEL_TYPE_SLOTS];
+
+	//collision masks, if there is a sheet to cut them from
+	char sheetPath[LEVELC_LINE_LENGTH];
+	int sheetTolerance;
+	FRAMEMASK masks[LEVEL_MAX_FRAMES];
+	uint64_t* maskWords;
+	int maskWordCount;
+} LEVELSOURCE;
+
+//Sprite sheet, 3 bytes (blue, green, red) a pixel, top row first
+typedef struct
+{
+	unsigned char* pixels;
+	int width, height;
+} SHEETIMAGE;
+
+#pragma region Function Prototypes
+bool Read_Source(LEVELSOURCE*, const char*);
+bool Read_Line(LEVELSOURCE*, char*);
+bool Write_Level(const LEVELSOURCE*, const char*);
+bool Load_Sheet(SHEETIMAGE*, const char*);
+bool Cut_Masks(LEVELSOURCE*, const SHEETIMAGE*);
+unsigned long Get_Value(const unsigned char*, int);
+int Find_Name(char (*)[LEVELC_NAME_LENGTH], int, const char*);
+int Find_Type(const char*);
+int Find_Behavior(const char*);
+bool Parse_Fixed(const char*, int32_t*);
+unsigned char* Put_Value(unsigned char*, unsigned long, int);
+#pragma endregion
+
+#pragma region Global Variables
+static LEVELSOURCE source; //too large for the stack
+
+//Entity type names, in ENTITY_TYPE order
+static const char* typeNames[ENTITY_TYPE_COUNT] =
+{
+	"player_jet", "vulcan_jet", "missile_jet", "helicopter", "bomber",
+	"player_bullet", "enemy_bullet", "missile", "homing_missile"
+};
+
+//Behavior names, in ENTITY_BEHAVIOR order
+static const char* behaviorNames[BEHAVIOR_COUNT] =
+{
+	"none", "vertical_bounce", "horizontal_bounce", "diagonal_bounce", "patrol",
+	"homing"
+};
+#pragma endregion
+
+int main(int argc, char* argv[])
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: The compiled level will be written, returns non-zero if
+	*                  the source had errors or the output couldn't be written
+	*   Description: Level compiler entry point
+	*     Algorithm: Read the source
+	*                Write the binary
+	*                Open it the way the game does to make sure it loads
+	*                Report what went in
+	**************************************************************************/
+	LEVEL level;
+
+	if(argc != 3)
+	{
+		fprintf(stderr, "Usage: Aerobatica_levelc <source> <output%s>\n", LEVEL_FILE_EXTENSION);
+		return 1;
+	}
+
+	if(!Read_Source(&source, argv[1]))
+		return 1;
+
+	if(!Write_Level(&source, argv[2]))
+	{
+		fprintf(stderr, "%s: could not be written\n", argv[2]);
+		return 1;
+	}
+	free(source.maskWords);
+
+	//check the result loads
+	if(!Level_Open(&level, argv[2]))
+	{
+		fprintf(stderr, "%s: written but does not load\n", argv[2]);
+		return 1;
+	}
+	printf("%s: %u frames, %u archetypes, %u waves, %u spawns, %u mask words, %lu bytes\n",
+		argv[2], level.header->frameCount, level.header->archetypeCount, level.header->waveCount,
+		level.header->spawnCount, level.header->maskWordCount, (unsigned long)level.size);
+	Level_Close(&level);
+
+	return 0;
+}
+
+bool Read_Source(LEVELSOURCE* level, const char* path)
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: The level's tables will be filled in from the source,
+	*                  returns false (having reported why) if it has errors
+	*   Description: Reads a level's text description
+	*     Algorithm: Start with just frame "none" and no player
+	*                Read_Line() each line, reporting the line of any error
+	*                Make sure the player was placed
+	*                If a sprite sheet was named, cut the frames' masks from it
+	**************************************************************************/
+	char line[LEVELC_LINE_LENGTH];
+	int lineNumber = 0, errors = 0;
+	FILE* file = fopen(path, "r");
+
+	if(file == NULL)
+	{
+		fprintf(stderr, "%s: could not be opened\n", path);
+		return false;
+	}
+
+	//frame 0 draws nothing
+	memset(level, 0, sizeof(LEVELSOURCE));
+	strcpy(level->frameNames[0], "none");
+	level->frameCount = 1;
+	level->playerSpawn = -1;
+
+	while(fgets(line, sizeof(line), file) != NULL)
+	{
+		lineNumber++;
+		if(!Read_Line(level, line))
+		{
+			fprintf(stderr, "%s:%d: %s", path, lineNumber, line);
+			errors++;
+		}
+	}
+	fclose(file);
+
+	if(level->playerSpawn < 0)
+	{
+		fprintf(stderr, "%s: no player line\n", path);
+		errors++;
+	}
+
+	if(level->sheetPath[0] != '\0' && errors == 0)
+	{
+		SHEETIMAGE sheet;
+
+		if(!Load_Sheet(&sheet, level->sheetPath))
+		{
+			fprintf(stderr, "%s: could not be read as an uncompressed 24 or 32-bit bitmap\n", level->sheetPath);
+			return false;
+		}
+		if(!Cut_Masks(level, &sheet))
+		{
+			fprintf(stderr, "%s: a frame lies outside the sprite sheet\n", level->sheetPath);
+			errors++;
+		}
+		free(sheet.pixels);
+	}
+
+	return errors == 0;
+}
+
+bool Read_Line(LEVELSOURCE* level, char* line)
+{
+	/**************************************************************************
+	*  PreCondition: Read_Source has set up the level
+	* PostCondition: The line's record will be added, returns false if the
+	*                  line is malformed, names something unknown or
+	*                  overflows a table
+	*   Description: Reads one line of level source
+	*     Algorithm: Cut off any comment and skip blank lines
+	*                Read the keyword and hand the rest to its record
+	**************************************************************************/
+	char keyword[LEVELC_NAME_LENGTH], name[LEVELC_NAME_LENGTH], other[LEVELC_NAME_LENGTH];
+	char* comment = strchr(line, '#');
+	int left, top, right, bottom, type, index;
+
+	if(comment != NULL)
+		*comment = '\0';
+	if(sscanf(line, "%31s", keyword) != 1)
+		return true;
+
+	if(strcmp(keyword, "frame") == 0)
+	{
+		if(sscanf(line, "%*s %31s %d %d %d %d", name, &left, &top, &right, &bottom) != 5 ||
+			level->frameCount >= LEVEL_MAX_FRAMES || Find_Name(level->frameNames, level->frameCount, name) >= 0)
+			return false;
+		strcpy(level->frameNames[level->frameCount], name);
+		level->frames[level->frameCount].left = (int16_t)left;
+		level->frames[level->frameCount].top = (int16_t)top;
+		level->frames[level->frameCount].right = (int16_t)right;
+		level->frames[level->frameCount].bottom = (int16_t)bottom;
+		level->frameCount++;
+	}
+	else if(strcmp(keyword, "draw") == 0)
+	{
+		if(sscanf(line, "%*s %31s %31s", name, other) != 2 || (type = Find_Type(name)) < 0 ||
+			(index = Find_Name(level->frameNames, level->frameCount, other)) < 0)
+			return false;
+		level->typeFrames[type] = (unsigned char)index;
+	}
+	else if(strcmp(keyword, "archetype") == 0)
+	{
+		ARCHETYPE* archetype = &level->archetypes[level->archetypeCount];
+		char behaviorName[LEVELC_NAME_LENGTH], motion[4][LEVELC_NAME_LENGTH];
+		int width, height, behavior, fields;
+
+		if(level->archetypeCount >= LEVELC_MAX_ARCHETYPES)
+			return false;
+		fields = sscanf(line, "%*s %31s %31s %31s %d %d %31s %31s %31s %31s %31s", name, other,
+			behaviorName, &width, &height, motion[0], motion[1], keyword, motion[2], motion[3]);
+		if(fields == 8)
+		{
+			//no acceleration given
+			strcpy(motion[2], "0");
+			strcpy(motion[3], "0");
+		}
+		if((fields != 8 && fields != 10) ||
+			!Parse_Fixed(motion[0], &archetype->xSpeed) || !Parse_Fixed(motion[1], &archetype->ySpeed) ||
+			!Parse_Fixed(motion[2], &archetype->xAcceleration) ||
+			!Parse_Fixed(motion[3], &archetype->yAcceleration) ||
+			(type = Find_Type(other)) < 0 || (entityTypeFlags[type] & TYPE_PROJECTILE) ||
+			(behavior = Find_Behavior(behaviorName)) < 0 ||
+			Find_Name(level->archetypeNames, level->archetypeCount, name) >= 0 ||
+			(strcmp(keyword, "left") != 0 && strcmp(keyword, "right") != 0))
+			return false;
+		strcpy(level->archetypeNames[level->archetypeCount], name);
+		archetype->type = (uint8_t)type;
+		archetype->faceRight = strcmp(keyword, "right") == 0;
+		archetype->behavior = (uint8_t)behavior;
+		archetype->width = width;
+		archetype->height = height;
+		level->archetypeCount++;
+	}
+	else if(strcmp(keyword, "wave") == 0)
+	{
+		if(level->waveCount >= LEVELC_MAX_WAVES)
+			return false;
+		level->waves[level->waveCount].firstSpawn = level->spawnCount;
+		level->waves[level->waveCount].spawnCount = 0;
+		level->waveCount++;
+	}
+	else if(strcmp(keyword, "player") == 0 || strcmp(keyword, "spawn") == 0)
+	{
+		LEVELSPAWN* spawn = &level->spawns[level->spawnCount];
+		bool player = strcmp(keyword, "player") == 0;
+		int delay = 0;
+
+		//the player is placed once and only moved by the controls, planes
+		//only go in a wave, and a wave's planes all have to fit in the spawn
+		//schedule at once
+		if(level->spawnCount >= LEVELC_MAX_SPAWNS || (player && level->playerSpawn >= 0) ||
+			(!player && (level->waveCount == 0 ||
+				level->waves[level->waveCount - 1].spawnCount >= SCHEDULE_CAPACITY)) ||
+			sscanf(line, "%*s %31s %d %d %d", name, &left, &top, &delay) < 3 ||
+			delay < 0 || delay > LEVELC_MAX_DELAY || (player && delay != 0) ||
+			(index = Find_Name(level->archetypeNames, level->archetypeCount, name)) < 0 ||
+			(player && level->archetypes[index].behavior != BEHAVIOR_NONE))
+			return false;
+		spawn->archetype = (uint16_t)index;
+		spawn->delay = (uint16_t)delay;
+		spawn->xCoordinate = left;
+		spawn->yCoordinate = top;
+
+		if(player)
+			level->playerSpawn = level->spawnCount;
+		else
+			level->waves[level->waveCount - 1].spawnCount++;
+		level->spawnCount++;
+	}
+	else if(strcmp(keyword, "sheet") == 0)
+	{
+		int start = 0, end;
+
+		//the rest of the line is the file name, spaces and all
+		if(level->sheetPath[0] != '\0' || sscanf(line, "%*s %d %n", &level->sheetTolerance, &start) < 1 ||
+			start == 0 || level->sheetTolerance < 0 || level->sheetTolerance > 255)
+			return false;
+		for(end = (int)strlen(line); end > start && (line[end - 1] == '\n' || line[end - 1] == '\r' ||
+			line[end - 1] == ' ' || line[end - 1] == '\t'); end--);
+		if(end == start)
+			return false;
+		memcpy(level->sheetPath, line + start, end - start);
+		level->sheetPath[end - start] = '\0';
+	}
+	else
+		return false;
+
+	return true;
+}
+
+bool Write_Level(const LEVELSOURCE* level, const char* path)
+{
+	/**************************************************************************
+	*  PreCondition: Read_Source has filled in the level
+	* PostCondition: The compiled level will be written to the file, returns
+	*                  false if it couldn't be
+	*   Description: Lays the tables out in the level file format
+	*     Algorithm: Work out each table's offset, they follow the header in
+	*                  order and every record is a multiple of 4 bytes, the
+	*                  mask words are padded out to a multiple of 8
+	*                Store the header then each table, field by field,
+	*                  little-endian
+	*                Write it out in one go
+	**************************************************************************/
+	unsigned long frameOffset = sizeof(LEVELHEADER);
+	unsigned long archetypeOffset = frameOffset + level->frameCount * sizeof(ATLASRECT);
+	unsigned long waveOffset = archetypeOffset + level->archetypeCount * sizeof(ARCHETYPE);
+	unsigned long spawnOffset = waveOffset + level->waveCount * sizeof(LEVELWAVE);
+	unsigned long maskOffset = spawnOffset + level->spawnCount * sizeof(LEVELSPAWN);
+	unsigned long maskWordOffset = (maskOffset + level->frameCount * sizeof(FRAMEMASK) + 7) & ~7UL;
+	unsigned long fileBytes = level->maskWords != NULL ?
+		maskWordOffset + level->maskWordCount * sizeof(uint64_t) : maskOffset;
+	unsigned char* bytes = (unsigned char*)calloc(fileBytes, 1); //(the padding is zero)
+	unsigned char* next = bytes;
+	bool written;
+	FILE* file;
+	int index;
+
+	if(bytes == NULL)
+		return false;
+
+	//header
+	memcpy(next, "AERL", 4);
+	next += 4;
+	next = Put_Value(next, LEVEL_VERSION, 4);
+	next = Put_Value(next, LEVEL_BYTE_ORDER, 4);
+	next = Put_Value(next, fileBytes, 4);
+	next = Put_Value(next, level->frameCount, 4);
+	next = Put_Value(next, frameOffset, 4);
+	next = Put_Value(next, level->archetypeCount, 4);
+	next = Put_Value(next, archetypeOffset, 4);
+	next = Put_Value(next, level->waveCount, 4);
+	next = Put_Value(next, waveOffset, 4);
+	next = Put_Value(next, level->spawnCount, 4);
+	next = Put_Value(next, spawnOffset, 4);
+	next = Put_Value(next, level->maskWords != NULL ? maskOffset : 0, 4);
+	next = Put_Value(next, level->maskWords != NULL ? level->maskWordCount : 0, 4);
+	next = Put_Value(next, level->maskWords != NULL ? maskWordOffset : 0, 4);
+	next = Put_Value(next, level->playerSpawn, 4);
+	for(index = 0; index < LEVEL_TYPE_SLOTS; index++)
+		next = Put_Value(next, level->typeFrames[index], 1);
+
+	//tables
+	for(index = 0; index < level->frameCount; index++)
+	{
+		next = Put_Value(next, (unsigned long)level->frames[index].left, 2);
+		next = Put_Value(next, (unsigned long)level->frames[index].top, 2);
+		next = Put_Value(next, (unsigned long)level->frames[index].right, 2);
+		next = Put_Value(next, (unsigned long)level->frames[index].bottom, 2);
+	}
+	for(index = 0; index < level->archetypeCount; index++)
+	{
+		next = Put_Value(next, level->archetypes[index].type, 1);
+		next = Put_Value(next, level->archetypes[index].faceRight, 1);
+		next = Put_Value(next, level->archetypes[index].behavior, 1);
+		next = Put_Value(next, 0, 1);
+		next = Put_Value(next, (unsigned long)level->archetypes[index].width, 4);
+		next = Put_Value(next, (unsigned long)level->archetypes[index].height, 4);
+		next = Put_Value(next, (unsigned long)level->archetypes[index].xSpeed, 4);
+		next = Put_Value(next, (unsigned long)level->archetypes[index].ySpeed, 4);
+		next = Put_Value(next, (unsigned long)level->archetypes[index].xAcceleration, 4);
+		next = Put_Value(next, (unsigned long)level->archetypes[index].yAcceleration, 4);
+	}
+	for(index = 0; index < level->waveCount; index++)
+	{
+		next = Put_Value(next, level->waves[index].firstSpawn, 4);
+		next = Put_Value(next, level->waves[index].spawnCount, 4);
+	}
+	for(index = 0; index < level->spawnCount; index++)
+	{
+		next = Put_Value(next, level->spawns[index].archetype, 2);
+		next = Put_Value(next, level->spawns[index].delay, 2);
+		next = Put_Value(next, (unsigned long)level->spawns[index].xCoordinate, 4);
+		next = Put_Value(next, (unsigned long)level->spawns[index].yCoordinate, 4);
+	}
+	if(level->maskWords != NULL)
+	{
+		for(index = 0; index < level->frameCount; index++)
+		{
+			next = Put_Value(next, level->masks[index].width, 2);
+			next = Put_Value(next, level->masks[index].height, 2);
+			next = Put_Value(next, level->masks[index].firstWord, 4);
+		}
+		next = bytes + maskWordOffset;
+
+		//(in halves, unsigned long may only be 32 bits)
+		for(index = 0; index < level->maskWordCount; index++)
+		{
+			next = Put_Value(next, (unsigned long)(level->maskWords[index] & 0xFFFFFFFFUL), 4);
+			next = Put_Value(next, (unsigned long)(level->maskWords[index] >> 32), 4);
+		}
+	}
+
+	//write it out
+	file = fopen(path, "wb");
+	written = file != NULL && fwrite(bytes, 1, fileBytes, file) == fileBytes;
+	if(file != NULL && fclose(file) != 0)
+		written = false;
+	free(bytes);
+
+	return written;
+}
+
+bool Load_Sheet(SHEETIMAGE* sheet, const char* path)
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: The sheet's pixels will be loaded (the caller frees
+	*                  them), returns false if the file isn't a bitmap this
+	*                  can read
+	*   Description: Reads the sprite sheet the masks are cut from. Only
+	*                  uncompressed bitmaps are read, so the masks see exactly
+	*                  the pixels the artist saved
+	*     Algorithm: Read the whole file
+	*                Check the file and info headers, 24 or 32 bits a pixel
+	*                  and no compression (or plain 32-bit bit fields)
+	*                Copy the rows out top first, whichever way up they are
+	*                  stored, each padded to 4 bytes
+	**************************************************************************/
+	FILE* file = fopen(path, "rb");
+	unsigned char* bytes;
+	unsigned long size, pixelOffset, compression, stride;
+	long width, height;
+	int bits, row, column;
+	bool bottomUp;
+
+	sheet->pixels = NULL;
+	if(file == NULL)
+		return false;
+	fseek(file, 0, SEEK_END);
+	size = (unsigned long)ftell(file);
+	fseek(file, 0, SEEK_SET);
+	bytes = (unsigned char*)malloc(size > 0 ? size : 1);
+	if(bytes == NULL || fread(bytes, 1, size, file) != size)
+	{
+		free(bytes);
+		fclose(file);
+		return false;
+	}
+	fclose(file);
+
+	//the headers
+	if(size < 54 || bytes[0] != 'B' || bytes[1] != 'M')
+	{
+		free(bytes);
+		return false;
+	}
+	pixelOffset = Get_Value(bytes + 10, 4);
+	width = (long)(int32_t)Get_Value(bytes + 18, 4);
+	height = (long)(int32_t)Get_Value(bytes + 22, 4);
+	bits = (int)Get_Value(bytes + 28, 2);
+	compression = Get_Value(bytes + 30, 4);
+	bottomUp = height > 0;
+	if(height < 0)
+		height = -height;
+	stride = ((unsigned long)width * (bits / 8) + 3) & ~3UL;
+	if(width <= 0 || width > LEVELC_MAX_SHEET || height == 0 || height > LEVELC_MAX_SHEET ||
+		(bits != 24 && bits != 32) || (compression != 0 && !(compression == 3 && bits == 32)) ||
+		pixelOffset > size || stride * height > size - pixelOffset)
+	{
+		free(bytes);
+		return false;
+	}
+
+	//the pixels
+	sheet->width = (int)width;
+	sheet->height = (int)height;
+	sheet->pixels = (unsigned char*)malloc(width * height * 3);
+	if(sheet->pixels == NULL)
+	{
+		free(bytes);
+		return false;
+	}
+	for(row = 0; row < height; row++)
+	{
+		const unsigned char* stored = bytes + pixelOffset +
+			stride * (bottomUp ? height - 1 - row : row);
+
+		for(column = 0; column < width; column++)
+			memcpy(sheet->pixels + (row * width + column) * 3, stored + column * (bits / 8), 3);
+	}
+	free(bytes);
+
+	return true;
+}
+
+bool Cut_Masks(LEVELSOURCE* level, const SHEETIMAGE* sheet)
+{
+	/**************************************************************************
+	*  PreCondition: Every frame has been read
+	* PostCondition: Each frame will have a mask of the pixels that aren't
+	*                  the colour key, facing right and mirrored, returns
+	*                  false if a frame doesn't lie on the sheet
+	*   Description: The offline half of per-pixel collision, so the game
+	*                  only ever ands bits together
+	*     Algorithm: Count the words every frame needs, twice over, and make
+	*                  room for them
+	*                For each frame with any size,
+	*                  For each pixel, if any channel is darker than the
+	*                    key by more than the tolerance, set its bit in the
+	*                    right-facing rows and its mirror in the left-facing
+	**************************************************************************/
+	int frame, row, column, words = 0;
+	int solidBelow = 255 - level->sheetTolerance;
+
+	//room for every mask
+	for(frame = 0; frame < level->frameCount; frame++)
+	{
+		const ATLASRECT* rect = &level->frames[frame];
+		int width = rect->right - rect->left, height = rect->bottom - rect->top;
+
+		if(width <= 0 || height <= 0)
+			continue;
+		if(rect->left < 0 || rect->top < 0 || rect->right > sheet->width || rect->bottom > sheet->height)
+			return false;
+		level->masks[frame].width = (uint16_t)width;
+		level->masks[frame].height = (uint16_t)height;
+		level->masks[frame].firstWord = (uint32_t)words;
+		words += 2 * ((width + 63) / 64) * height;
+	}
+	level->maskWords = (uint64_t*)calloc(words > 0 ? words : 1, sizeof(uint64_t));
+	level->maskWordCount = words;
+	if(level->maskWords == NULL)
+		return false;
+
+	//cut them
+	for(frame = 0; frame < level->frameCount; frame++)
+	{
+		const ATLASRECT* rect = &level->frames[frame];
+		const FRAMEMASK* mask = &level->masks[frame];
+		int rowWords = (mask->width + 63) / 64;
+		uint64_t* right = level->maskWords + mask->firstWord;
+		uint64_t* left = right + rowWords * mask->height;
+
+		for(row = 0; row < mask->height; row++)
+			for(column = 0; column < mask->width; column++)
+			{
+				const unsigned char* pixel = sheet->pixels +
+					((rect->top + row) * sheet->width + rect->left + column) * 3;
+				int mirrored = mask->width - 1 - column;
+
+				if(pixel[0] < solidBelow || pixel[1] < solidBelow || pixel[2] < solidBelow)
+				{
+					right[row * rowWords + column / 64] |= 1ULL << (column % 64);
+					left[row * rowWords + mirrored / 64] |= 1ULL << (mirrored % 64);
+				}
+			}
+	}
+
+	return true;
+}
+
+int Find_Name(char (*names)[LEVELC_NAME_LENGTH], int count, const char* name)
+{
+	/**************************************************************************
+	*  PreCondition: names holds count names
+	* PostCondition: The index of the name will be returned, or -1
+	*   Description: Looks up a frame or archetype by name
+	*     Algorithm: Compare it with each name in turn
+	**************************************************************************/
+	int index;
+
+	for(index = 0; index < count; index++)
+		if(strcmp(names[index], name) == 0)
+			return index;
+
+	return -1;
+}
+
+int Find_Type(const char* name)
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: The entity type with that name will be returned, or -1
+	*   Description: Looks up an entity type by name
+	*     Algorithm: Compare it with each type's name in turn
+	**************************************************************************/
+	int type;
+
+	for(type = 0; type < ENTITY_TYPE_COUNT; type++)
+		if(strcmp(typeNames[type], name) == 0)
+			return type;
+
+	return -1;
+}
+
+int Find_Behavior(const char* name)
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: The behavior with that name will be returned, or -1
+	*   Description: Looks up a movement pattern by name
+	*     Algorithm: Compare it with each behavior's name in turn
+	**************************************************************************/
+	int behavior;
+
+	for(behavior = 0; behavior < BEHAVIOR_COUNT; behavior++)
+		if(strcmp(behaviorNames[behavior], name) == 0)
+			return behavior;
+
+	return -1;
+}
+
+bool Parse_Fixed(const char* text, int32_t* value)
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: value will hold the decimal text as 16.16 fixed-point,
+	*                  rounded to the nearest 1/65536, returns false if it
+	*                  isn't a number or is out of range
+	*   Description: Reads a speed or an acceleration with integers alone, so
+	*                  every build of the compiler writes the same bits
+	*     Algorithm: Note and skip a minus sign
+	*                Read the whole part, then any fraction digits as a
+	*                  numerator over a power of ten
+	*                Scale the fraction to 65536ths, rounding half up
+	*                Combine them and apply the sign
+	**************************************************************************/
+	long long whole = 0, numerator = 0, denominator = 1;
+	bool negative = *text == '-';
+	int digits = 0;
+
+	if(negative)
+		text++;
+
+	//the whole pixels
+	if(*text < '0' || *text > '9')
+		return false;
+	while(*text >= '0' && *text <= '9')
+	{
+		whole = whole * 10 + (*text++ - '0');
+		if(whole > LEVELC_MAX_PIXELS)
+			return false;
+	}
+
+	//the fraction
+	if(*text == '.')
+		for(text++; *text >= '0' && *text <= '9'; text++)
+		{
+			if(++digits > LEVELC_MAX_DIGITS)
+				return false;
+			numerator = numerator * 10 + (*text - '0');
+			denominator *= 10;
+		}
+	if(*text != '\0')
+		return false;
+
+	whole = whole * FIXED_ONE + (numerator * FIXED_ONE + denominator / 2) / denominator;
+	*value = (int32_t)(negative ? -whole : whole);
+
+	return true;
+}
+
+unsigned long Get_Value(const unsigned char* bytes, int length)
+{
+	/**************************************************************************
+	*  PreCondition: bytes holds length bytes
+	* PostCondition: The little-endian value stored there will be returned
+	*   Description: Reads a field of a bitmap header
+	*     Algorithm: Gather the bytes, highest first
+	**************************************************************************/
+	unsigned long value = 0;
+
+	while(length-- > 0)
+		value = (value << 8) | bytes[length];
+
+	return value;
+}
+
+unsigned char* Put_Value(unsigned char* bytes, unsigned long value, int length)
+{
+	/**************************************************************************
+	*  PreCondition: bytes has room for length bytes
+	* PostCondition: The value will be stored little-endian, and the byte
+	*                  after it returned
+	*   Description: Writes a field of the level file
+	*     Algorithm: Store the value a byte at a time, lowest first
+	**************************************************************************/
+	int index;
+
+	for(index = 0; index < length; index++)
+		bytes[index] = (unsigned char)(value >> (8 * index));
+
+	return bytes + length;
+}
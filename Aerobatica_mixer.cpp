@@ -0,0 +1,744 @@
+/******************************************************************************
+*        Title: Aerobatica
+* Date Started: April 10th, 2009
+*    Developer: Liam Hagerty
+*       Module: Sound Mixer Code Module
+*  Description: This module contains the routines that make and load the
+*                 sound effects, queue them from the game thread, and mix
+*                 and output them on the mixer's thread
+*      Version: 1.0
+******************************************************************************/
+#pragma region Includes
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include "Aerobatica_mixer.h"    //Sound Mixer Definitions Header
+#include "Aerobatica_timer.h"    //Pacing and latency
+#include "Aerobatica_profiler.h" //Phase timings
+#ifdef _WIN32
+#include <windows.h>
+#include <mmsystem.h>
+#pragma comment(lib, "winmm.lib")
+#endif
+#pragma endregion
+
+#pragma region Constants
+#define WAVE_HEADER_BYTES 44
+#define MIXER_BLOCK_NS ((long long)MIXER_BLOCK_FRAMES * 1000000000LL / MIXER_RATE)
+#pragma endregion
+
+//Recipe for a synthesized effect, used until a recording is loaded over it
+typedef struct
+{
+	int milliseconds;
+	float startHertz, endHertz; //Pitch of the tone, swept across the effect
+	float noise;                //Share of rumble mixed in with the tone, 0 to 1
+	unsigned char priority;
+} SOUNDRECIPE;
+
+#ifdef _WIN32
+//Sound card state, blocks are written round the buffers in turn
+typedef struct
+{
+	HWAVEOUT handle;
+	WAVEHDR headers[MIXER_DEVICE_BUFFERS];
+	int16_t buffers[MIXER_DEVICE_BUFFERS][MIXER_BLOCK_FRAMES * MIXER_CHANNELS];
+	int next;
+} MIXERDEVICE;
+#endif
+
+#pragma region Global Variables
+static const SOUNDRECIPE soundRecipes[SOUND_COUNT] =
+{
+	//ms   start  end   noise priority
+	{ 60,   1400, 700,  0.1f, 1 }, //Player Shot
+	{ 90,   500,  300,  0.2f, 1 }, //Enemy Shot
+	{ 400,  150,  300,  0.7f, 2 }, //Missile
+	{ 600,  120,  40,   0.9f, 3 }, //Explosion
+	{ 1000, 300,  50,   0.6f, 4 }  //Player Hit
+};
+
+//Sound each event makes, and whether it comes from where the player is
+static const struct
+{
+	unsigned event;
+	SOUND_ID sound;
+	bool fromPlayer;
+} eventSounds[] =
+{
+	{ SIM_EVENT_PLAYER_SHOT, SOUND_PLAYER_SHOT, true },
+	{ SIM_EVENT_ENEMY_SHOT,  SOUND_ENEMY_SHOT,  false },
+	{ SIM_EVENT_MISSILE,     SOUND_MISSILE,     false },
+	{ SIM_EVENT_KILL,        SOUND_EXPLOSION,   false },
+	{ SIM_EVENT_PLAYER_HIT,  SOUND_PLAYER_HIT,  true }
+};
+#pragma endregion
+
+#pragma region Function Prototypes
+static bool Synthesize(SOUND*, const SOUNDRECIPE*, unsigned long);
+static void Start_Voice(MIXER*, const MIXERCOMMAND*);
+static void Run_Mixer(MIXER*);
+static void Write_Block(MIXER*);
+static void Write_Wave_Header(FILE*, unsigned long);
+static unsigned long Get_Value(const unsigned char*, int);
+static void Put_Value(unsigned char*, unsigned long, int);
+static bool Open_Device(MIXER*);
+static void Play_Device(MIXER*);
+static void Close_Device(MIXER*);
+#pragma endregion
+
+bool Mixer_Init(MIXER* mixer)
+{
+	/**************************************************************************
+	*  PreCondition: The mixer isn't running
+	* PostCondition: Every effect will be in memory and every voice free,
+	*                  returns false (with nothing left allocated) if there
+	*                  isn't the memory
+	*   Description: Sets up the mixer, ready to Start
+	*     Algorithm: Free every voice and clear the counts
+	*                Set up the command queue over the mixer's storage
+	*                Synthesize() each effect
+	**************************************************************************/
+	int voice, sound;
+
+	for(voice = 0; voice < MIXER_VOICES; voice++)
+		mixer->voices[voice].sound = SOUND_COUNT;
+	mixer->started = 0;
+	mixer->file = NULL;
+	mixer->device = NULL;
+	mixer->running.store(false);
+	mixer->dropped.store(0);
+	mixer->played = 0;
+	mixer->stolen = 0;
+	mixer->refused = 0;
+	mixer->totalLatency = 0;
+	mixer->worstLatency = 0;
+	mixer->blocks = 0;
+
+	Ring_Init(&mixer->commands, mixer->commandStorage, MIXER_COMMANDS, sizeof(MIXERCOMMAND));
+
+	memset(mixer->sounds, 0, sizeof(mixer->sounds));
+	for(sound = 0; sound < SOUND_COUNT; sound++)
+		if(!Synthesize(&mixer->sounds[sound], &soundRecipes[sound], sound + 1))
+		{
+			Mixer_Release(mixer);
+			return false;
+		}
+
+	return true;
+}
+
+bool Mixer_Load(MIXER* mixer, SOUND_ID sound, const char* path)
+{
+	/**************************************************************************
+	*  PreCondition: Mixer_Init has run and the mixer isn't running
+	* PostCondition: The effect will be replaced by the recording, returns
+	*                  false (keeping the effect it had) if the file is
+	*                  missing or isn't 16-bit mono PCM at MIXER_RATE
+	*   Description: Loads a recorded effect from a WAV file
+	*     Algorithm: Read the whole file
+	*                Check the RIFF header
+	*                Walk the chunks, checking the format and keeping the
+	*                  samples
+	*                Swap the samples in for the old ones
+	**************************************************************************/
+	FILE* file = fopen(path, "rb");
+	unsigned char* bytes = NULL;
+	int16_t* samples = NULL;
+	long size = 0, offset;
+	bool formatFits = false;
+	int frames = 0, frame;
+
+	//read it all in
+	if(file == NULL)
+		return false;
+	if(fseek(file, 0, SEEK_END) == 0 && (size = ftell(file)) > 0 && fseek(file, 0, SEEK_SET) == 0)
+	{
+		bytes = (unsigned char*)malloc(size);
+		if(bytes != NULL && fread(bytes, 1, size, file) != (size_t)size)
+		{
+			free(bytes);
+			bytes = NULL;
+		}
+	}
+	fclose(file);
+	if(bytes == NULL)
+		return false;
+
+	//walk the chunks after the header
+	if(size >= 12 && memcmp(bytes, "RIFF", 4) == 0 && memcmp(bytes + 8, "WAVE", 4) == 0)
+		for(offset = 12; offset + 8 <= size && samples == NULL; )
+		{
+			const unsigned char* chunk = bytes + offset;
+			long length = (long)Get_Value(chunk + 4, 4);
+
+			if(length > size - offset - 8)
+				break;
+
+			//PCM, one channel, the mixer's rate, 16 bits
+			if(memcmp(chunk, "fmt ", 4) == 0 && length >= 16)
+				formatFits = Get_Value(chunk + 8, 2) == 1 && Get_Value(chunk + 10, 2) == 1 &&
+					Get_Value(chunk + 12, 4) == MIXER_RATE && Get_Value(chunk + 22, 2) == 16;
+
+			//the samples, once the format is known to fit
+			if(memcmp(chunk, "data", 4) == 0 && formatFits && length >= 2)
+			{
+				frames = (int)(length / 2);
+				samples = (int16_t*)malloc(frames * sizeof(int16_t));
+				for(frame = 0; samples != NULL && frame < frames; frame++)
+					samples[frame] = (int16_t)Get_Value(chunk + 8 + frame * 2, 2);
+			}
+
+			//chunks are padded to an even length
+			offset += 8 + length + (length & 1);
+		}
+	free(bytes);
+	if(samples == NULL)
+		return false;
+
+	free(mixer->sounds[sound].samples);
+	mixer->sounds[sound].samples = samples;
+	mixer->sounds[sound].frames = frames;
+
+	return true;
+}
+
+bool Mixer_Start(MIXER* mixer, MIXER_OUTPUT output, const char* path)
+{
+	/**************************************************************************
+	*  PreCondition: Mixer_Init has run and the mixer isn't running, path
+	*                  names the WAV file for MIXER_OUTPUT_FILE
+	* PostCondition: The mixer thread will be mixing into the output, returns
+	*                  false if the output couldn't be opened
+	*   Description: Starts the sound
+	*     Algorithm: Open the output, a file starts with a header to be
+	*                  filled in when it is finished
+	*                Start the mixer thread
+	**************************************************************************/
+	mixer->output = output;
+	mixer->framesWritten = 0;
+
+	if(output == MIXER_OUTPUT_FILE)
+	{
+		mixer->file = fopen(path, "wb");
+		if(mixer->file == NULL)
+			return false;
+		Write_Wave_Header(mixer->file, 0);
+	}
+	else if(output == MIXER_OUTPUT_DEVICE && !Open_Device(mixer))
+		return false;
+
+	mixer->running.store(true);
+	mixer->thread = std::thread(Run_Mixer, mixer);
+
+	return true;
+}
+
+void Mixer_Stop(MIXER* mixer)
+{
+	/**************************************************************************
+	*  PreCondition: Mixer_Start has succeeded
+	* PostCondition: The mixer thread will have finished and the output been
+	*                  closed, a file with its header complete
+	*   Description: Stops the sound
+	*     Algorithm: Let the block being mixed finish, then stop the thread
+	*                Close the output
+	**************************************************************************/
+	mixer->running.store(false);
+	if(mixer->thread.joinable())
+		mixer->thread.join();
+
+	if(mixer->file != NULL)
+	{
+		fseek(mixer->file, 0, SEEK_SET);
+		Write_Wave_Header(mixer->file, mixer->framesWritten);
+		fclose(mixer->file);
+		mixer->file = NULL;
+	}
+	Close_Device(mixer);
+}
+
+void Mixer_Release(MIXER* mixer)
+{
+	/**************************************************************************
+	*  PreCondition: The mixer isn't running
+	* PostCondition: Every effect's samples will be freed
+	*   Description: Tears the mixer down
+	*     Algorithm: Free each effect's samples
+	**************************************************************************/
+	int sound;
+
+	for(sound = 0; sound < SOUND_COUNT; sound++)
+	{
+		free(mixer->sounds[sound].samples);
+		mixer->sounds[sound].samples = NULL;
+		mixer->sounds[sound].frames = 0;
+	}
+}
+
+bool Mixer_Play(MIXER* mixer, SOUND_ID sound, int volume, int pan)
+{
+	/**************************************************************************
+	*  PreCondition: Mixer_Init has run, only one thread ever calls this
+	* PostCondition: The effect will be queued to start in the next block,
+	*                  returns false if the queue was full and it was dropped
+	*   Description: Plays an effect without waiting, called from the game
+	*                  thread
+	*     Algorithm: Stamp the command with the clock
+	*                Push it onto the ring, counting it if there was no room
+	**************************************************************************/
+	MIXERCOMMAND command;
+
+	command.sound = (unsigned char)sound;
+	command.volume = (short)volume;
+	command.pan = (short)pan;
+	command.issued = Timer_Microseconds();
+
+	if(!Ring_Push(&mixer->commands, &command))
+	{
+		mixer->dropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	return true;
+}
+
+void Mixer_Play_Events(MIXER* mixer, const SIMULATION* world)
+{
+	/**************************************************************************
+	*  PreCondition: The world has just ticked, the caller is the mixer's
+	*                  only producer
+	* PostCondition: An effect will be queued for each kind of event the
+	*                  tick raised
+	*   Description: Sounds out a tick
+	*     Algorithm: Pan the player's own sounds to where the jet is across
+	*                  the playfield, the rest from the middle
+	*                Play() the effect of each event raised
+	**************************************************************************/
+	int playerX, playerY, playerPan;
+	unsigned event;
+
+	if(world->events == 0)
+		return;
+
+	Player_Middle(world, &playerX, &playerY);
+	playerPan = playerX * 2 * MIXER_UNITY / PLAYFIELD_WIDTH - MIXER_UNITY;
+	if(playerPan < -MIXER_UNITY)
+		playerPan = -MIXER_UNITY;
+	if(playerPan > MIXER_UNITY)
+		playerPan = MIXER_UNITY;
+
+	for(event = 0; event < sizeof(eventSounds) / sizeof(eventSounds[0]); event++)
+		if(world->events & eventSounds[event].event)
+			Mixer_Play(mixer, eventSounds[event].sound, MIXER_UNITY,
+				eventSounds[event].fromPlayer ? playerPan : 0);
+}
+
+void Mixer_Mix(MIXER* mixer)
+{
+	/**************************************************************************
+	*  PreCondition: Mixer_Init has run, only the mixer thread calls this once
+	*                  the mixer has started
+	* PostCondition: The next block will be mixed into mixer->block
+	*   Description: Mixes one block
+	*     Algorithm: Start_Voice() for each command waiting
+	*                Clear the wide mix
+	*                For each voice playing,
+	*                  Add as much of the rest of its sound as fits, scaled
+	*                    by its gain on each side
+	*                  Free it if its sound has finished
+	*                Scale the mix down and clip it into the block
+	**************************************************************************/
+	PROFILE_SCOPE("Mixer_Mix");
+	MIXERCOMMAND command;
+	int voice, frame, frames, sample;
+
+	//start what the game asked for
+	while(Ring_Pop(&mixer->commands, &command))
+		Start_Voice(mixer, &command);
+
+	memset(mixer->mix, 0, sizeof(mixer->mix));
+
+	for(voice = 0; voice < MIXER_VOICES; voice++)
+	{
+		MIXERVOICE* playing = &mixer->voices[voice];
+		const SOUND* sound;
+		const int16_t* samples;
+		int32_t* mix = mixer->mix;
+
+		if(playing->sound == SOUND_COUNT)
+			continue;
+
+		//add what is left of it, up to a block
+		sound = &mixer->sounds[playing->sound];
+		samples = sound->samples + playing->position;
+		frames = sound->frames - playing->position;
+		if(frames > MIXER_BLOCK_FRAMES)
+			frames = MIXER_BLOCK_FRAMES;
+		for(frame = 0; frame < frames; frame++, mix += MIXER_CHANNELS)
+		{
+			mix[0] += samples[frame] * playing->leftGain;
+			mix[1] += samples[frame] * playing->rightGain;
+		}
+
+		playing->position += frames;
+		if(playing->position >= sound->frames)
+			playing->sound = SOUND_COUNT;
+	}
+
+	//back to 16 bits, clipping anything too loud
+	for(sample = 0; sample < MIXER_BLOCK_FRAMES * MIXER_CHANNELS; sample++)
+	{
+		int32_t value = mixer->mix[sample] / MIXER_UNITY;
+
+		if(value > 32767)
+			value = 32767;
+		if(value < -32768)
+			value = -32768;
+		mixer->block[sample] = (int16_t)value;
+	}
+
+	mixer->blocks++;
+}
+
+static bool Synthesize(SOUND* sound, const SOUNDRECIPE* recipe, unsigned long seed)
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: The sound will hold the effect the recipe describes,
+	*                  returns false if there isn't the memory
+	*   Description: Makes a stand-in effect so the game has sound with no
+	*                  recordings shipped
+	*     Algorithm: Allocate the samples
+	*                For each frame,
+	*                  Sweep a square wave's pitch from start to end
+	*                  Smooth white noise from a generator into a rumble
+	*                  Blend the two and fade the result out linearly
+	**************************************************************************/
+	float phase = 0.0f, rumble = 0.0f, along, hertz, tone, white;
+	int frame;
+
+	sound->frames = recipe->milliseconds * MIXER_RATE / 1000;
+	sound->priority = recipe->priority;
+	sound->samples = (int16_t*)malloc(sound->frames * sizeof(int16_t));
+	if(sound->samples == NULL)
+		return false;
+
+	for(frame = 0; frame < sound->frames; frame++)
+	{
+		along = (float)frame / sound->frames;
+
+		//the tone
+		hertz = recipe->startHertz + (recipe->endHertz - recipe->startHertz) * along;
+		phase += hertz / MIXER_RATE;
+		phase -= (int)phase;
+		tone = phase < 0.5f ? 1.0f : -1.0f;
+
+		//the rumble
+		seed = (seed * 1103515245UL + 12345UL) & 0xFFFFFFFFUL;
+		white = (float)(seed >> 16) / 32768.0f - 1.0f;
+		rumble += (white - rumble) * 0.3f;
+
+		sound->samples[frame] = (int16_t)(((1.0f - recipe->noise) * tone + recipe->noise * rumble * 2.0f) *
+			(1.0f - along) * 12000.0f);
+	}
+
+	return true;
+}
+
+static void Start_Voice(MIXER* mixer, const MIXERCOMMAND* command)
+{
+	/**************************************************************************
+	*  PreCondition: Called by the mixer thread
+	* PostCondition: The command's effect will be playing from its start on
+	*                  a voice, unless every voice is busy with something
+	*                  more important
+	*   Description: Voice allocation with priority stealing
+	*     Algorithm: Note how long the command waited
+	*                Take a free voice if there is one
+	*                Otherwise pick the playing voice of lowest priority,
+	*                  the oldest of those, and take it over unless it
+	*                  outranks the new effect
+	*                Set its gain on each side from the volume and pan
+	**************************************************************************/
+	long long latency = Timer_Microseconds() - command->issued;
+	int voice, chosen = -1, pan = command->pan;
+	unsigned char priority;
+
+	if(command->sound >= SOUND_COUNT)
+		return;
+	priority = mixer->sounds[command->sound].priority;
+
+	mixer->totalLatency += latency;
+	if(latency > mixer->worstLatency)
+		mixer->worstLatency = latency;
+
+	//a free voice, or else the least important one
+	for(voice = 0; voice < MIXER_VOICES && chosen < 0; voice++)
+		if(mixer->voices[voice].sound == SOUND_COUNT)
+			chosen = voice;
+	if(chosen < 0)
+	{
+		for(voice = 0; voice < MIXER_VOICES; voice++)
+		{
+			const MIXERVOICE* playing = &mixer->voices[voice];
+			unsigned char playingPriority = mixer->sounds[playing->sound].priority;
+
+			if(chosen < 0 || playingPriority < mixer->sounds[mixer->voices[chosen].sound].priority ||
+				(playingPriority == mixer->sounds[mixer->voices[chosen].sound].priority &&
+				playing->started - mixer->voices[chosen].started > 0x80000000U))
+				chosen = voice;
+		}
+		if(mixer->sounds[mixer->voices[chosen].sound].priority > priority)
+		{
+			mixer->refused++;
+			return;
+		}
+		mixer->stolen++;
+	}
+
+	//start it, full volume on the side it is panned to
+	mixer->voices[chosen].sound = command->sound;
+	mixer->voices[chosen].position = 0;
+	mixer->voices[chosen].leftGain = command->volume * (pan > 0 ? MIXER_UNITY - pan : MIXER_UNITY) / MIXER_UNITY;
+	mixer->voices[chosen].rightGain = command->volume * (pan < 0 ? MIXER_UNITY + pan : MIXER_UNITY) / MIXER_UNITY;
+	mixer->voices[chosen].started = mixer->started++;
+	mixer->played++;
+}
+
+static void Run_Mixer(MIXER* mixer)
+{
+	/**************************************************************************
+	*  PreCondition: Started by Mixer_Start with the output open
+	* PostCondition: Blocks will have been mixed and output until Mixer_Stop
+	*   Description: Body of the mixer thread
+	*     Algorithm: Until told to stop,
+	*                  Mix() a block and Write_Block() it
+	*                  The sound card takes blocks at its own pace, for the
+	*                    other outputs sleep until the next block is due
+	**************************************************************************/
+	long long due = Timer_Nanoseconds(), now;
+
+	while(mixer->running.load())
+	{
+		Mixer_Mix(mixer);
+		Write_Block(mixer);
+
+		//keep to the rate a sound card would
+		if(mixer->output != MIXER_OUTPUT_DEVICE)
+		{
+			due += MIXER_BLOCK_NS;
+			now = Timer_Nanoseconds();
+			if(due > now)
+				std::this_thread::sleep_for(std::chrono::nanoseconds(due - now));
+			else
+				due = now;
+		}
+	}
+}
+
+static void Write_Block(MIXER* mixer)
+{
+	/**************************************************************************
+	*  PreCondition: Mixer_Mix has filled the block
+	* PostCondition: The block will have gone to the output
+	*   Description: Hands a block over
+	*     Algorithm: The sound card plays it, a file stores it lowest byte
+	*                  first, the null output drops it
+	*                Count the frames
+	**************************************************************************/
+	unsigned char bytes[MIXER_BLOCK_FRAMES * MIXER_CHANNELS * 2];
+	int sample;
+
+	if(mixer->output == MIXER_OUTPUT_DEVICE)
+		Play_Device(mixer);
+	else if(mixer->output == MIXER_OUTPUT_FILE)
+	{
+		for(sample = 0; sample < MIXER_BLOCK_FRAMES * MIXER_CHANNELS; sample++)
+			Put_Value(bytes + sample * 2, (unsigned long)(uint16_t)mixer->block[sample], 2);
+		fwrite(bytes, 1, sizeof(bytes), mixer->file);
+	}
+
+	mixer->framesWritten += MIXER_BLOCK_FRAMES;
+}
+
+static void Write_Wave_Header(FILE* file, unsigned long frames)
+{
+	/**************************************************************************
+	*  PreCondition: The file is positioned at its start
+	* PostCondition: A 16-bit PCM WAV header for the frames will be written
+	*   Description: Header of the file output
+	*     Algorithm: Fill in the RIFF, format and data chunk headers
+	**************************************************************************/
+	unsigned char header[WAVE_HEADER_BYTES];
+	unsigned long dataBytes = frames * MIXER_CHANNELS * 2;
+
+	memcpy(header, "RIFF", 4);
+	Put_Value(header + 4, 36 + dataBytes, 4);
+	memcpy(header + 8, "WAVEfmt ", 8);
+	Put_Value(header + 16, 16, 4);
+	Put_Value(header + 20, 1, 2);
+	Put_Value(header + 22, MIXER_CHANNELS, 2);
+	Put_Value(header + 24, MIXER_RATE, 4);
+	Put_Value(header + 28, MIXER_RATE * MIXER_CHANNELS * 2, 4);
+	Put_Value(header + 32, MIXER_CHANNELS * 2, 2);
+	Put_Value(header + 34, 16, 2);
+	memcpy(header + 36, "data", 4);
+	Put_Value(header + 40, dataBytes, 4);
+
+	fwrite(header, 1, sizeof(header), file);
+}
+
+static unsigned long Get_Value(const unsigned char* bytes, int count)
+{
+	/**************************************************************************
+	*  PreCondition: bytes points to count bytes, lowest first
+	* PostCondition: Their value will be returned
+	*   Description: Reads a WAV field the same way on any platform
+	*     Algorithm: Add in each byte from the highest down
+	**************************************************************************/
+	unsigned long value = 0;
+
+	while(count-- > 0)
+		value = (value << 8) | bytes[count];
+
+	return value;
+}
+
+static void Put_Value(unsigned char* bytes, unsigned long value, int count)
+{
+	/**************************************************************************
+	*  PreCondition: bytes has room for count bytes
+	* PostCondition: The value's low count bytes will be stored, lowest first
+	*   Description: Writes a WAV field the same way on any platform
+	*     Algorithm: Store the value a byte at a time, shifting it down
+	**************************************************************************/
+	int index;
+
+	for(index = 0; index < count; index++, value >>= 8)
+		bytes[index] = (unsigned char)value;
+}
+
+#ifdef _WIN32
+static bool Open_Device(MIXER* mixer)
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: The sound card will be open for 16-bit stereo at
+	*                  MIXER_RATE with its buffers ready, returns false if it
+	*                  couldn't be opened
+	*   Description: Opens the sound card through the wave output API
+	*     Algorithm: Allocate the device state
+	*                Open the default device
+	*                Prepare each buffer and mark it done, so the first
+	*                  blocks go straight in
+	**************************************************************************/
+	MIXERDEVICE* device = (MIXERDEVICE*)calloc(1, sizeof(MIXERDEVICE));
+	WAVEFORMATEX format;
+	int buffer;
+
+	if(device == NULL)
+		return false;
+
+	memset(&format, 0, sizeof(format));
+	format.wFormatTag = WAVE_FORMAT_PCM;
+	format.nChannels = MIXER_CHANNELS;
+	format.nSamplesPerSec = MIXER_RATE;
+	format.wBitsPerSample = 16;
+	format.nBlockAlign = MIXER_CHANNELS * 2;
+	format.nAvgBytesPerSec = MIXER_RATE * format.nBlockAlign;
+	if(waveOutOpen(&device->handle, WAVE_MAPPER, &format, 0, 0, CALLBACK_NULL) != MMSYSERR_NOERROR)
+	{
+		free(device);
+		return false;
+	}
+
+	for(buffer = 0; buffer < MIXER_DEVICE_BUFFERS; buffer++)
+	{
+		device->headers[buffer].lpData = (LPSTR)device->buffers[buffer];
+		device->headers[buffer].dwBufferLength = sizeof(device->buffers[buffer]);
+		waveOutPrepareHeader(device->handle, &device->headers[buffer], sizeof(WAVEHDR));
+		device->headers[buffer].dwFlags |= WHDR_DONE;
+	}
+
+	mixer->device = device;
+	return true;
+}
+
+static void Play_Device(MIXER* mixer)
+{
+	/**************************************************************************
+	*  PreCondition: Open_Device has succeeded
+	* PostCondition: The block will be queued on the sound card
+	*   Description: Paces the mixer to the sound card
+	*     Algorithm: Wait for the next buffer in turn to finish playing
+	*                Copy the block in and queue it
+	**************************************************************************/
+	MIXERDEVICE* device = (MIXERDEVICE*)mixer->device;
+	WAVEHDR* header = &device->headers[device->next];
+
+	while(!(header->dwFlags & WHDR_DONE))
+		Sleep(1);
+
+	memcpy(device->buffers[device->next], mixer->block, sizeof(mixer->block));
+	header->dwFlags &= ~WHDR_DONE;
+	waveOutWrite(device->handle, header, sizeof(WAVEHDR));
+	device->next = (device->next + 1) % MIXER_DEVICE_BUFFERS;
+}
+
+static void Close_Device(MIXER* mixer)
+{
+	/**************************************************************************
+	*  PreCondition: The mixer thread has stopped
+	* PostCondition: The sound card will be closed, if it was open
+	*   Description: Releases the sound card
+	*     Algorithm: Stop what is playing and hand back the buffers
+	*                Close the device and free its state
+	**************************************************************************/
+	MIXERDEVICE* device = (MIXERDEVICE*)mixer->device;
+	int buffer;
+
+	if(device == NULL)
+		return;
+
+	waveOutReset(device->handle);
+	for(buffer = 0; buffer < MIXER_DEVICE_BUFFERS; buffer++)
+		waveOutUnprepareHeader(device->handle, &device->headers[buffer], sizeof(WAVEHDR));
+	waveOutClose(device->handle);
+
+	free(device);
+	mixer->device = NULL;
+}
+#else
+static bool Open_Device(MIXER*)
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: Returns false, there is no sound card output here
+	*   Description: Stand-in for platforms without a device output, which
+	*                  use the null or file output instead
+	*     Algorithm: Report failure
+	**************************************************************************/
+	return false;
+}
+
+static void Play_Device(MIXER*)
+{
+	/**************************************************************************
+	*  PreCondition: Never called, Open_Device always fails here
+	* PostCondition: None
+	*   Description: Stand-in for platforms without a device output
+	*     Algorithm: Nothing
+	**************************************************************************/
+}
+
+static void Close_Device(MIXER*)
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: None
+	*   Description: Stand-in for platforms without a device output
+	*     Algorithm: Nothing
+	**************************************************************************/
+}
+#endif
@@ -0,0 +1,125 @@
+/******************************************************************************
+*        Title: Aerobatica
+* Date Started: April 10th, 2009
+*    Developer: Liam Hagerty
+*       Module: Sound Mixer Header
+*  Description: This module contains the sound effects mixer. Every effect
+*                 is held in memory as 16-bit mono samples before play
+*                 starts, and a thread of the mixer's own mixes the voices
+*                 playing into short stereo blocks and hands them to an
+*                 output: the sound card, a WAV file or nowhere at all.
+*
+*                 The game thread only ever pushes play commands onto a
+*                 lock-free ring, so a tick never waits on the sound. There
+*                 are a fixed number of voices, and when they are all busy
+*                 a new sound takes over the least important (then oldest)
+*                 one, or is dropped if everything playing matters more
+*      Version: 1.0
+******************************************************************************/
+#ifndef _MIXER_H
+#define _MIXER_H 1
+
+#pragma region Include Files
+#include <stdio.h>
+#include <stdint.h>
+#include <atomic>
+#include <thread>
+#include "Aerobatica_ringbuffer.h" //Command queue
+#include "Aerobatica_simulation.h" //Events that make sounds
+#pragma endregion
+
+#pragma region Constants
+#define MIXER_RATE 22050         //Frames per second
+#define MIXER_CHANNELS 2         //Mono sounds are panned into stereo
+#define MIXER_VOICES 16          //Most sounds playing at once
+#define MIXER_BLOCK_FRAMES 256   //Frames mixed at a time, about 12 ms
+#define MIXER_COMMANDS 256       //Commands the queue holds, a power of two
+#define MIXER_UNITY 256          //Full volume, and how far a pan goes either way
+#define MIXER_DEVICE_BUFFERS 3   //Blocks queued on the sound card
+#pragma endregion
+
+//Sound effects
+typedef enum
+{
+	SOUND_PLAYER_SHOT,
+	SOUND_ENEMY_SHOT,
+	SOUND_MISSILE,
+	SOUND_EXPLOSION,
+	SOUND_PLAYER_HIT,
+	SOUND_COUNT
+} SOUND_ID;
+
+//Where mixed blocks go
+typedef enum
+{
+	MIXER_OUTPUT_NULL,   //Thrown away, at the pace a sound card would take them
+	MIXER_OUTPUT_FILE,   //Written to a WAV file at the same pace
+	MIXER_OUTPUT_DEVICE  //Played on the sound card (Windows only)
+} MIXER_OUTPUT;
+
+//Sound Structure, one preloaded effect
+typedef struct
+{
+	int16_t* samples;        //Mono, at MIXER_RATE
+	int frames;
+	unsigned char priority;  //Higher steals voices from lower
+} SOUND;
+
+//Command from the game thread
+typedef struct
+{
+	unsigned char sound;  //SOUND_ID
+	short volume;         //0 to MIXER_UNITY
+	short pan;            //-MIXER_UNITY (left) to MIXER_UNITY (right)
+	long long issued;     //Clock reading (microseconds) it was pushed at
+} MIXERCOMMAND;
+
+//One sound being played
+typedef struct
+{
+	int sound;             //SOUND_ID, or SOUND_COUNT when the voice is free
+	int position;          //Next frame of the sound
+	int leftGain, rightGain;
+	unsigned started;      //Order voices were started in, for stealing the oldest
+} MIXERVOICE;
+
+//Sound Mixer Structure
+typedef struct
+{
+	SOUND sounds[SOUND_COUNT];
+	MIXERVOICE voices[MIXER_VOICES];
+	unsigned started;
+
+	//Game thread to mixer thread
+	RINGBUFFER commands;
+	MIXERCOMMAND commandStorage[MIXER_COMMANDS];
+
+	//Output, used by the mixer thread alone once it runs
+	MIXER_OUTPUT output;
+	FILE* file;
+	unsigned long framesWritten;
+	void* device;            //Sound card state, Windows only
+	int32_t mix[MIXER_BLOCK_FRAMES * MIXER_CHANNELS];
+	int16_t block[MIXER_BLOCK_FRAMES * MIXER_CHANNELS];
+
+	std::thread thread;
+	std::atomic<bool> running;
+
+	//How it has gone, the mixer thread's counts are read once it has stopped
+	std::atomic<unsigned long> dropped; //Commands lost to a full queue
+	unsigned long played, stolen, refused;
+	long long totalLatency, worstLatency; //Microseconds from push to mixing
+	unsigned long blocks;
+} MIXER;
+
+#pragma region Function Prototypes
+bool Mixer_Init(MIXER*);
+bool Mixer_Load(MIXER*, SOUND_ID, const char*);
+bool Mixer_Start(MIXER*, MIXER_OUTPUT, const char*);
+void Mixer_Stop(MIXER*);
+void Mixer_Release(MIXER*);
+bool Mixer_Play(MIXER*, SOUND_ID, int, int);
+void Mixer_Play_Events(MIXER*, const SIMULATION*);
+void Mixer_Mix(MIXER*);
+#pragma endregion
+#endif
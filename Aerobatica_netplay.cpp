@@ -0,0 +1,388 @@
+/******************************************************************************
+*        Title: Aerobatica
+* Date Started: April 10th, 2009
+*    Developer: Liam Hagerty
+*       Module: Netplay Code Module
+*  Description: This module contains the routines that play a session ahead
+*                 on guessed input, roll it back when a guess turns out
+*                 wrong, trade packets with the other player and simulate
+*                 the link between them
+*      Version: 1.0
+******************************************************************************/
+#pragma region Includes
+#include <string.h>
+#include "Aerobatica_netplay.h"  //Netplay Definitions Header
+#include "Aerobatica_profiler.h" //Phase timings
+#pragma endregion
+
+#pragma region Function Prototypes
+static void Play_Tick(NETSESSION*);
+static void Check_Hash(NETSESSION*);
+static SIM_INPUT Guess_Remote(const NETSESSION*);
+static unsigned long Link_Random(NETLINK*);
+#pragma endregion
+
+void Net_Start(NETSESSION* session, int localPlayer, unsigned long seed)
+{
+	/**************************************************************************
+	*  PreCondition: Both players start with the same seed and level, and
+	*                  different localPlayers
+	* PostCondition: The session will be ready to play its first tick
+	*   Description: Starts one player's side of a game
+	*     Algorithm: Start the world from the seed
+	*                Clear the inputs, counters and pending checks
+	**************************************************************************/
+	Sim_Init(&session->world, seed);
+	memset(session->inputs, 0, sizeof(session->inputs));
+	session->localPlayer = localPlayer;
+
+	session->tick = 0;
+	session->confirmed = 0;
+	session->acked = 0;
+	session->rollbackTick = NET_NO_TICK;
+	session->remoteHashTick = NET_NO_TICK;
+	session->remoteHash = 0;
+	session->desyncTick = NET_NO_TICK;
+
+	session->stalls = 0;
+	session->rollbacks = 0;
+	session->resimulated = 0;
+	session->deepest = 0;
+}
+
+bool Net_Advance(NETSESSION* session, SIM_INPUT input)
+{
+	/**************************************************************************
+	*  PreCondition: Net_Start has run on the session
+	* PostCondition: The world will be a tick further along with the local
+	*                  player's input and returns true, or, if the session
+	*                  is as far ahead as it may get, nothing happens and
+	*                  false is returned (the input should be offered again)
+	*   Description: Plays this player's next tick without waiting for the
+	*                  other player
+	*     Algorithm: Stall if the remote player's input is NET_MAX_ROLLBACK
+	*                  ticks behind, or ours hasn't been acknowledged for as
+	*                  many as one packet can repeat
+	*                Roll_Back() any wrong guesses first
+	*                Keep the local input, and guess the remote one unless
+	*                  it has already arrived
+	*                Play_Tick()
+	*                Check_Hash() that has been waiting
+	**************************************************************************/
+	PROFILE_SCOPE("Net_Advance");
+	SIM_INPUT* played;
+
+	//don't get further ahead than a rollback or a packet can cover
+	//(the remote player can be ahead, so no subtracting)
+	if(session->tick >= session->confirmed + NET_MAX_ROLLBACK ||
+		session->tick >= session->acked + NET_PACKET_INPUTS)
+	{
+		session->stalls++;
+		return false;
+	}
+
+	//put right what was guessed wrong
+	Net_Roll_Back(session);
+
+	//the tick's controls
+	played = session->inputs[session->tick & (NET_INPUTS - 1)];
+	played[session->localPlayer] = input;
+	if(session->tick >= session->confirmed)
+		played[1 - session->localPlayer] = Guess_Remote(session);
+
+	Play_Tick(session);
+	Check_Hash(session);
+
+	return true;
+}
+
+void Net_Roll_Back(NETSESSION* session)
+{
+	/**************************************************************************
+	*  PreCondition: Net_Start has run on the session
+	* PostCondition: Every tick played on a wrong guess will have been played
+	*                  over, the world ending up where it was in ticks
+	*   Description: The rollback itself. Net_Advance does this every tick,
+	*                  and a caller can do it without advancing to settle
+	*                  the world once every input is in
+	*     Algorithm: If no guess was wrong, there is nothing to do
+	*                Guess again for the ticks whose input still hasn't
+	*                  arrived
+	*                Restore the snapshot from before the first wrong tick
+	*                Play_Tick() back up to the present
+	*                Count it, and Check_Hash() that has been waiting
+	**************************************************************************/
+	PROFILE_SCOPE("Net_Roll_Back");
+	unsigned long present = session->tick, tick;
+	SIM_INPUT guess;
+
+	if(session->rollbackTick == NET_NO_TICK)
+		return;
+
+	//guess again with the latest input that arrived
+	guess = Guess_Remote(session);
+	for(tick = session->confirmed; tick < present; tick++)
+		session->inputs[tick & (NET_INPUTS - 1)][1 - session->localPlayer] = guess;
+
+	//go back and play forward again
+	Sim_Restore(&session->world, &session->states[session->rollbackTick & (NET_STATES - 1)]);
+	session->tick = session->rollbackTick;
+	while(session->tick < present)
+		Play_Tick(session);
+
+	session->rollbacks++;
+	session->resimulated += present - session->rollbackTick;
+	if(present - session->rollbackTick > session->deepest)
+		session->deepest = present - session->rollbackTick;
+	session->rollbackTick = NET_NO_TICK;
+
+	Check_Hash(session);
+}
+
+void Net_Make_Packet(const NETSESSION* session, NETPACKET* packet)
+{
+	/**************************************************************************
+	*  PreCondition: Net_Start has run on the session
+	* PostCondition: The packet will hold this frame's message to the remote
+	*                  player
+	*   Description: Builds the packet sent every frame, whether or not the
+	*                  session advanced
+	*     Algorithm: Carry every local input the remote player hasn't
+	*                  acknowledged
+	*                Acknowledge the remote inputs that have arrived
+	*                Add the hash from before the latest tick whose world
+	*                  can't change any more: one played on real input and
+	*                  not waiting to be rolled back
+	**************************************************************************/
+	unsigned long tick, hashTick;
+
+	memset(packet, 0, sizeof(NETPACKET));
+
+	//our inputs, from the first the other side is missing
+	packet->firstTick = (uint32_t)session->acked;
+	packet->count = (uint8_t)(session->tick - session->acked);
+	for(tick = session->acked; tick < session->tick; tick++)
+		packet->inputs[tick - session->acked] = session->inputs[tick & (NET_INPUTS - 1)][session->localPlayer];
+
+	//theirs that we have
+	packet->ackTick = (uint32_t)session->confirmed;
+
+	//a world both sides should agree on
+	packet->hashTick = (uint32_t)NET_NO_TICK;
+	if(session->tick > 0)
+	{
+		hashTick = session->confirmed < session->tick - 1 ? session->confirmed : session->tick - 1;
+		if(session->rollbackTick < hashTick)
+			hashTick = session->rollbackTick;
+		packet->hashTick = (uint32_t)hashTick;
+		packet->hash = (uint32_t)session->hashes[hashTick & (NET_STATES - 1)];
+	}
+}
+
+void Net_Take_Packet(NETSESSION* session, const NETPACKET* packet)
+{
+	/**************************************************************************
+	*  PreCondition: Net_Start has run on the session, the packet came from
+	*                  the remote player's Net_Make_Packet
+	* PostCondition: The inputs and acknowledgement will have been taken in,
+	*                  and the first tick played on a wrong guess noted
+	*   Description: Receives a packet. They can come late, twice or out of
+	*                  order, and anything already known is skipped
+	*     Algorithm: Take the acknowledgement if it is newer
+	*                For each input from the first one still missing,
+	*                  If its tick was played on a different guess, mark
+	*                    the rollback to start there if it is the earliest
+	*                  Keep it and count it as arrived
+	*                Keep the hash to check if it is newer
+	**************************************************************************/
+	int remote = 1 - session->localPlayer, input;
+
+	//what they have of ours
+	if(packet->ackTick > session->acked)
+		session->acked = packet->ackTick;
+
+	//what we lacked of theirs
+	for(input = 0; input < packet->count; input++)
+	{
+		unsigned long tick = packet->firstTick + (unsigned long)input;
+		SIM_INPUT* played = session->inputs[tick & (NET_INPUTS - 1)];
+
+		//already had it, or a gap (which a later packet will fill)
+		if(tick != session->confirmed)
+			continue;
+
+		if(tick < session->tick && played[remote] != packet->inputs[input] && tick < session->rollbackTick)
+			session->rollbackTick = tick;
+		played[remote] = packet->inputs[input];
+		session->confirmed++;
+	}
+
+	//their world, to compare with ours
+	if(packet->hashTick != (uint32_t)NET_NO_TICK &&
+		(session->remoteHashTick == NET_NO_TICK || packet->hashTick > session->remoteHashTick))
+	{
+		session->remoteHashTick = packet->hashTick;
+		session->remoteHash = packet->hash;
+	}
+}
+
+SIM_INPUT Net_Crew_Input(SIM_INPUT pilot, SIM_INPUT gunner)
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: The jet's controls for the tick will be returned
+	*   Description: Shares the one jet between the two players
+	*     Algorithm: Take the directions from the pilot and the trigger from
+	*                  the gunner
+	**************************************************************************/
+	return (SIM_INPUT)((pilot & (INPUT_LEFT | INPUT_RIGHT | INPUT_UP | INPUT_DOWN)) | (gunner & INPUT_FIRE));
+}
+
+void Net_Link_Init(NETLINK* link, int latency, int jitter, int lossPercent, unsigned long seed)
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: The link will be empty with the given conditions
+	*   Description: Sets up one direction of a simulated connection. The
+	*                  same seed always delays and drops the same packets
+	*     Algorithm: Keep the conditions and seed the link's generator
+	*                Clear the packets in flight and the counters
+	**************************************************************************/
+	link->latency = latency;
+	link->jitter = jitter;
+	link->lossPercent = lossPercent;
+	link->randomState = seed & 0xFFFFFFFFUL;
+
+	link->count = 0;
+	link->sent = 0;
+	link->lost = 0;
+}
+
+void Net_Link_Send(NETLINK* link, const NETPACKET* packet, unsigned long frame)
+{
+	/**************************************************************************
+	*  PreCondition: Net_Link_Init has run on the link
+	* PostCondition: The packet will be in flight, or lost
+	*   Description: Sends a packet on frame
+	*     Algorithm: Lose it at the link's loss rate, or if the link is full
+	*                Otherwise give it the latency plus up to jitter frames
+	*                  and put it in flight
+	**************************************************************************/
+	link->sent++;
+	if((int)(Link_Random(link) % 100) < link->lossPercent || link->count == NET_LINK_CAPACITY)
+	{
+		link->lost++;
+		return;
+	}
+
+	link->packets[link->count] = *packet;
+	link->arrives[link->count] = frame + link->latency;
+	if(link->jitter > 0)
+		link->arrives[link->count] += Link_Random(link) % (link->jitter + 1);
+	link->count++;
+}
+
+bool Net_Link_Receive(NETLINK* link, unsigned long frame, NETPACKET* packet)
+{
+	/**************************************************************************
+	*  PreCondition: Net_Link_Init has run on the link
+	* PostCondition: The packet that has been due the longest will be copied
+	*                  out and taken off the link, returns false if none is
+	*                  due yet on frame
+	*   Description: Receives a packet, call until it returns false
+	*     Algorithm: Find the earliest arrival no later than frame (the
+	*                  first sent of those due together)
+	*                Copy it out and close up the packets behind it
+	**************************************************************************/
+	int found = -1, index;
+
+	for(index = 0; index < link->count; index++)
+		if(link->arrives[index] <= frame && (found < 0 || link->arrives[index] < link->arrives[found]))
+			found = index;
+	if(found < 0)
+		return false;
+
+	*packet = link->packets[found];
+	link->count--;
+	memmove(&link->packets[found], &link->packets[found + 1], (link->count - found) * sizeof(NETPACKET));
+	memmove(&link->arrives[found], &link->arrives[found + 1], (link->count - found) * sizeof(unsigned long));
+
+	return true;
+}
+
+static void Play_Tick(NETSESSION* session)
+{
+	/**************************************************************************
+	*  PreCondition: Both players' inputs for the session's tick are set
+	* PostCondition: The world will be a tick further along, with a snapshot
+	*                  and hash of it from before
+	*   Description: Plays one tick, ready to come back to it
+	*     Algorithm: Save the world and hash it
+	*                Tick it with the crew's combined input
+	**************************************************************************/
+	const SIM_INPUT* played = session->inputs[session->tick & (NET_INPUTS - 1)];
+	int state = (int)(session->tick & (NET_STATES - 1));
+
+	Sim_Save(&session->world, &session->states[state]);
+	session->hashes[state] = Sim_Hash(&session->world);
+
+	Sim_Tick(&session->world, Net_Crew_Input(played[NET_PILOT], played[NET_GUNNER]));
+	session->tick++;
+}
+
+static void Check_Hash(NETSESSION* session)
+{
+	/**************************************************************************
+	*  PreCondition: Any rollback due has been done
+	* PostCondition: A waiting remote hash will have been compared and the
+	*                  first desync noted, or left waiting if our world from
+	*                  before that tick isn't final yet
+	*   Description: Catches the two worlds drifting apart, which rollback
+	*                  would otherwise hide until it showed on screen
+	*     Algorithm: Wait until the tick has been played on real input
+	*                Give up on it if its snapshot has been reused
+	*                Otherwise compare the hashes
+	**************************************************************************/
+	unsigned long tick = session->remoteHashTick;
+
+	if(tick == NET_NO_TICK || tick >= session->tick || tick > session->confirmed ||
+		session->rollbackTick <= tick)
+		return;
+
+	if(session->tick - tick <= NET_STATES && session->desyncTick == NET_NO_TICK &&
+		session->hashes[tick & (NET_STATES - 1)] != session->remoteHash)
+		session->desyncTick = tick;
+	session->remoteHashTick = NET_NO_TICK;
+}
+
+static SIM_INPUT Guess_Remote(const NETSESSION* session)
+{
+	/**************************************************************************
+	*  PreCondition: Net_Start has run on the session
+	* PostCondition: The guess for a remote input that hasn't arrived will
+	*                  be returned
+	*   Description: Players mostly hold their controls from one tick to
+	*                  the next, so the last input that arrived is usually
+	*                  right
+	*     Algorithm: Return the remote input from the last arrived tick, or
+	*                  nothing before any have
+	**************************************************************************/
+	if(session->confirmed == 0)
+		return 0;
+
+	return session->inputs[(session->confirmed - 1) & (NET_INPUTS - 1)][1 - session->localPlayer];
+}
+
+static unsigned long Link_Random(NETLINK* link)
+{
+	/**************************************************************************
+	*  PreCondition: Net_Link_Init has run on the link
+	* PostCondition: A pseudo-random number from 0 to 65535 will be returned
+	*   Description: The link's own generator, so its losses never disturb
+	*                  the worlds'
+	*     Algorithm: Advance a linear congruential generator
+	*                Return its upper bits
+	**************************************************************************/
+	link->randomState = (link->randomState * 1103515245UL + 12345UL) & 0xFFFFFFFFUL;
+	return link->randomState >> 16;
+}
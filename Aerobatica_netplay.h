@@ -0,0 +1,103 @@
+/******************************************************************************
+*        Title: Aerobatica
+* Date Started: April 10th, 2009
+*    Developer: Liam Hagerty
+*       Module: Netplay Header
+*  Description: This module contains two-player rollback netplay. Each
+*                 player runs their own copy of the world and never waits
+*                 for the other's controls: a tick whose remote input hasn't
+*                 arrived is played with a guess (the last input that did),
+*                 and when the real one turns up and differs the world is
+*                 restored from the snapshot taken before that tick and
+*                 re-simulated up to the present.
+*
+*                 The world has one jet, so the two players crew it: the
+*                 pilot steers and the gunner fires.
+*
+*                 Packets go over a NETLINK, a loopback stand-in for a UDP
+*                 socket that delays, reorders and drops them on purpose.
+*                 Every packet repeats the inputs the other side hasn't
+*                 acknowledged yet, so a lost one costs nothing but time
+*      Version: 1.0
+******************************************************************************/
+#ifndef _NETPLAY_H
+#define _NETPLAY_H 1
+
+#pragma region Include Files
+#include <stdint.h>
+#include "Aerobatica_simulation.h" //The world being played
+#pragma endregion
+
+#pragma region Constants
+#define NET_PLAYERS 2
+#define NET_PILOT 0  //Player whose controls steer the jet
+#define NET_GUNNER 1 //Player whose controls fire its guns
+
+#define NET_MAX_ROLLBACK 8  //Most ticks played ahead of the other player's input
+#define NET_STATES 16       //Snapshots kept, a power of two above NET_MAX_ROLLBACK
+#define NET_INPUTS 32       //Ticks of input kept, a power of two above 2 * NET_MAX_ROLLBACK
+#define NET_PACKET_INPUTS NET_MAX_ROLLBACK //Most inputs one packet carries
+
+#define NET_LINK_CAPACITY 256 //Packets a link can have in flight, more are dropped
+#define NET_NO_TICK 0xFFFFFFFFUL //No tick, for rollbacks and hash checks not pending
+#pragma endregion
+
+//Network Packet Structure, what one player sends the other each frame
+typedef struct
+{
+	uint32_t firstTick;  //Tick of the first input carried
+	uint32_t ackTick;    //Sender has the receiver's inputs for every tick before this
+	uint32_t hashTick;   //Tick the hash was taken before, NET_NO_TICK if none
+	uint32_t hash;       //Sender's Sim_Hash() of its world before hashTick
+	uint8_t count;       //Inputs carried
+	SIM_INPUT inputs[NET_PACKET_INPUTS];
+} NETPACKET;
+
+//Network Link Structure, one direction of a simulated connection
+typedef struct
+{
+	int count;                                  //Packets in flight
+	NETPACKET packets[NET_LINK_CAPACITY];
+	unsigned long arrives[NET_LINK_CAPACITY];   //Frame each one can be received on
+	int latency;        //Frames every packet takes
+	int jitter;         //Most extra frames one can take, so later ones can pass it
+	int lossPercent;    //Chance of a packet vanishing
+	unsigned long randomState; //Link's own generator, separate from the worlds'
+	unsigned long sent, lost;
+} NETLINK;
+
+//Netplay Session Structure, one player's side of a game
+typedef struct
+{
+	SIMULATION world;           //This player's copy, played ahead on guesses
+	SIMSNAPSHOT states[NET_STATES];        //World before each recent tick
+	unsigned long hashes[NET_STATES];      //Sim_Hash() of each snapshot
+	SIM_INPUT inputs[NET_INPUTS][NET_PLAYERS]; //Input played (or to play) each tick
+	int localPlayer;
+
+	unsigned long tick;         //Next tick to play
+	unsigned long confirmed;    //Remote inputs have arrived for every tick before this
+	unsigned long acked;        //Remote player has ours for every tick before this
+	unsigned long rollbackTick; //Earliest tick played on a wrong guess, or NET_NO_TICK
+	unsigned long remoteHashTick, remoteHash; //Remote hash waiting to be checked
+	unsigned long desyncTick;   //First tick the worlds were found to differ, or NET_NO_TICK
+
+	//How the session has gone
+	unsigned long stalls;       //Frames it couldn't play ahead any further
+	unsigned long rollbacks;
+	unsigned long resimulated;  //Ticks played over again
+	unsigned long deepest;      //Most ticks one rollback re-simulated
+} NETSESSION;
+
+#pragma region Function Prototypes
+void Net_Start(NETSESSION*, int, unsigned long);
+bool Net_Advance(NETSESSION*, SIM_INPUT);
+void Net_Roll_Back(NETSESSION*);
+void Net_Make_Packet(const NETSESSION*, NETPACKET*);
+void Net_Take_Packet(NETSESSION*, const NETPACKET*);
+SIM_INPUT Net_Crew_Input(SIM_INPUT, SIM_INPUT);
+void Net_Link_Init(NETLINK*, int, int, int, unsigned long);
+void Net_Link_Send(NETLINK*, const NETPACKET*, unsigned long);
+bool Net_Link_Receive(NETLINK*, unsigned long, NETPACKET*);
+#pragma endregion
+#endif
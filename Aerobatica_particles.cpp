@@ -0,0 +1,370 @@
+/******************************************************************************
+*        Title: Aerobatica
+* Date Started: April 10th, 2009
+*    Developer: Liam Hagerty
+*       Module: Particle System Code Module
+*  Description: This module contains the routines that start explosions and
+*                 exhaust, step every particle through the SIMD kernels and
+*                 hand the living ones over to be drawn
+*      Version: 1.0
+******************************************************************************/
+#pragma region Includes
+#include <math.h>
+#include <string.h>
+#include "Aerobatica_particles.h" //Particle System Definitions Header
+#include "Aerobatica_profiler.h"  //Phase timings
+#pragma endregion
+
+#pragma region Constants
+#define PARTICLE_RING_MASK (PARTICLE_CAPACITY - 1)
+#define PARTICLE_TWO_PI 6.2831853f
+#pragma endregion
+
+#pragma region Function Prototypes
+static void Blast(PARTICLESYSTEM*, float, float);
+static void Spawn(PARTICLESYSTEM*, float, float, float, float, float, PARTICLE_KIND);
+static int Spans(const PARTICLESYSTEM*, unsigned*, unsigned*);
+static float Random_Unit(PARTICLESYSTEM*);
+#pragma endregion
+
+void Particles_Init(PARTICLESYSTEM* system, unsigned long seed)
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: The ring will be empty, every slot dead, and the burst
+	*                  queue ready
+	*   Description: Sets up the particle system
+	*     Algorithm: Clear every column, so slots never used count as dead
+	*                Seed the system's own generator
+	*                Set up the burst queue over the system's storage
+	**************************************************************************/
+	system->start = 0;
+	system->count = 0;
+	memset(system->xCoordinate, 0, sizeof(system->xCoordinate));
+	memset(system->yCoordinate, 0, sizeof(system->yCoordinate));
+	memset(system->xSpeed, 0, sizeof(system->xSpeed));
+	memset(system->ySpeed, 0, sizeof(system->ySpeed));
+	memset(system->life, 0, sizeof(system->life));
+	memset(system->fade, 0, sizeof(system->fade));
+	memset(system->kind, 0, sizeof(system->kind));
+	memset(system->live, 0, sizeof(system->live));
+
+	system->randomState = seed & 0xFFFFFFFFUL;
+	system->exhaustOwed = 0.0f;
+	system->spawned = 0;
+	system->overwritten = 0;
+
+	Ring_Init(&system->bursts, system->burstStorage, PARTICLE_BURSTS, sizeof(PARTICLEBURST));
+	system->dropped.store(0);
+}
+
+bool Particles_Burst(PARTICLESYSTEM* system, int x, int y)
+{
+	/**************************************************************************
+	*  PreCondition: Particles_Init has run, only one thread ever calls this
+	* PostCondition: A blast at the point will be queued for the next update,
+	*                  returns false if the queue was full and it was dropped
+	*   Description: Starts an explosion without waiting, called from the
+	*                  simulation thread
+	*     Algorithm: Push the point onto the ring, counting it if there was no
+	*                  room
+	**************************************************************************/
+	PARTICLEBURST burst;
+
+	burst.xCoordinate = (short)x;
+	burst.yCoordinate = (short)y;
+
+	if(!Ring_Push(&system->bursts, &burst))
+	{
+		system->dropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	return true;
+}
+
+void Particles_Burst_Blasts(PARTICLESYSTEM* system, const SIMULATION* world)
+{
+	/**************************************************************************
+	*  PreCondition: The world has just ticked, the caller is the system's
+	*                  only producer
+	* PostCondition: An explosion will be queued for each plane that went
+	*                  down during the tick
+	*   Description: Blows up a tick's casualties
+	*     Algorithm: Burst() at each of the tick's blasts
+	**************************************************************************/
+	int blast;
+
+	for(blast = 0; blast < world->blasts; blast++)
+		Particles_Burst(system, world->blastX[blast], world->blastY[blast]);
+}
+
+void Particles_Exhaust(PARTICLESYSTEM* system, const SIMULATION* world, float seconds)
+{
+	/**************************************************************************
+	*  PreCondition: Called by the window's thread, the world is a published
+	*                  snapshot
+	* PostCondition: Each missile in flight will have left the puffs it was
+	*                  due over the seconds
+	*   Description: Contrails behind the missiles
+	*     Algorithm: Work out how many whole puffs every missile is due,
+	*                  carrying the fraction to the next frame
+	*                For each missile in flight,
+	*                  Find its tail from the way it is flying
+	*                  Leave that many puffs there, drifting back along its
+	*                    path
+	**************************************************************************/
+	const PROJECTILEPOOL* pool = &world->projectiles;
+	int slot, puffs, puff;
+
+	system->exhaustOwed += PARTICLE_EXHAUST_RATE * seconds;
+	puffs = (int)system->exhaustOwed;
+	system->exhaustOwed -= puffs;
+	if(puffs == 0)
+		return;
+
+	for(slot = 0; slot < pool->count; slot++)
+	{
+		float xDirection, yDirection, length, tailX, tailY;
+
+		if(pool->type[slot] != ENTITY_MISSILE && pool->type[slot] != ENTITY_HOMING_MISSILE)
+			continue;
+
+		//the way it is flying, or the way it faces if it is standing still
+		xDirection = (float)pool->xSpeed[slot];
+		yDirection = (float)pool->ySpeed[slot];
+		length = sqrtf(xDirection * xDirection + yDirection * yDirection);
+		if(length > 0.0f)
+		{
+			xDirection /= length;
+			yDirection /= length;
+		}
+		else
+		{
+			xDirection = pool->faceRight[slot] ? 1.0f : -1.0f;
+			yDirection = 0.0f;
+		}
+
+		//puff out of the tail
+		tailX = pool->xCoordinate[slot] + pool->width[slot] * 0.5f * (1.0f - xDirection);
+		tailY = pool->yCoordinate[slot] + pool->height[slot] * 0.5f - yDirection * pool->width[slot] * 0.5f;
+		for(puff = 0; puff < puffs; puff++)
+			Spawn(system, tailX, tailY,
+				-25.0f * xDirection + (Random_Unit(system) - 0.5f) * 20.0f,
+				-25.0f * yDirection + (Random_Unit(system) - 0.5f) * 20.0f - 15.0f,
+				0.3f + 0.4f * Random_Unit(system), PARTICLE_EXHAUST);
+	}
+}
+
+void Particles_Update(PARTICLESYSTEM* system, float seconds)
+{
+	/**************************************************************************
+	*  PreCondition: Called by the window's thread
+	* PostCondition: The queued explosions will have started, every particle
+	*                  moved and aged by the seconds, and the dead ones at
+	*                  the oldest end given back to the ring
+	*   Description: Steps the particles once a frame
+	*     Algorithm: Blast() at each queued burst
+	*                For each stretch of the ring in use, starting from a
+	*                  mask word boundary,
+	*                  Integrate the positions and speeds
+	*                  Age them, killing those out of life or off the
+	*                    playfield, and mark the living
+	*                Drop dead particles from the oldest end until a living
+	*                  one is reached
+	**************************************************************************/
+	PROFILE_SCOPE("Particles_Update");
+	static const float bounds[4] = { -PARTICLE_MARGIN, -PARTICLE_MARGIN,
+		PLAYFIELD_WIDTH + PARTICLE_MARGIN, PLAYFIELD_HEIGHT + PARTICLE_MARGIN };
+	PARTICLEBURST burst;
+	unsigned first[2], length[2];
+	float damping = powf(PARTICLE_DRAG, seconds);
+	int spans, span;
+
+	//start what the simulation reported
+	while(Ring_Pop(&system->bursts, &burst))
+		Blast(system, burst.xCoordinate, burst.yCoordinate);
+
+	//the kernels, a stretch at a time
+	spans = Spans(system, first, length);
+	for(span = 0; span < spans; span++)
+	{
+		unsigned at = first[span];
+
+		Particle_Integrate(system->xCoordinate + at, system->yCoordinate + at, system->xSpeed + at,
+			system->ySpeed + at, (int)length[span], seconds, PARTICLE_GRAVITY, damping);
+		Particle_Age(system->life + at, system->xCoordinate + at, system->yCoordinate + at,
+			(int)length[span], seconds, bounds, system->live + at / 64);
+	}
+
+	//give the dead at the oldest end back
+	while(system->count > 0 && !((system->live[system->start >> 6] >> (system->start & 63)) & 1))
+	{
+		system->start = (system->start + 1) & PARTICLE_RING_MASK;
+		system->count--;
+	}
+}
+
+void Particles_Emit(const PARTICLESYSTEM* system, PARTICLEBATCH* batch)
+{
+	/**************************************************************************
+	*  PreCondition: Particles_Update has run this frame
+	* PostCondition: The batch will hold a record for every living particle
+	*   Description: Hands the particles over to be drawn
+	*     Algorithm: For each stretch of the ring in use,
+	*                  Walk its live mask a word at a time, skipping empty
+	*                    words
+	*                  Record each living particle's position, kind and how
+	*                    far it has faded
+	**************************************************************************/
+	PROFILE_SCOPE("Particles_Emit");
+	unsigned first[2], length[2];
+	int spans, span;
+
+	batch->count = 0;
+
+	spans = Spans(system, first, length);
+	for(span = 0; span < spans; span++)
+	{
+		unsigned word, lastWord = (first[span] + length[span] + 63) / 64;
+
+		for(word = first[span] / 64; word < lastWord; word++)
+		{
+			uint64_t bits = system->live[word];
+			unsigned slot = word * 64;
+
+			for(; bits; bits >>= 1, slot++)
+			{
+				PARTICLERECORD* record;
+				float shade;
+
+				if(!(bits & 1))
+					continue;
+
+				record = &batch->records[batch->count++];
+				shade = system->life[slot] * system->fade[slot];
+				record->xCoordinate = (short)system->xCoordinate[slot];
+				record->yCoordinate = (short)system->yCoordinate[slot];
+				record->kind = system->kind[slot];
+				record->shade = (unsigned char)(shade >= 1.0f ? 255 : shade * 255.0f);
+			}
+		}
+	}
+}
+
+static void Blast(PARTICLESYSTEM* system, float x, float y)
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: An explosion's particles will be in the ring
+	*   Description: One plane going down
+	*     Algorithm: Throw flames out fast in every direction
+	*                Leave slower, longer-lived smoke drifting upwards
+	**************************************************************************/
+	int particle;
+
+	for(particle = 0; particle < PARTICLE_BLAST_FLAMES; particle++)
+	{
+		float angle = PARTICLE_TWO_PI * Random_Unit(system);
+		float speed = 40.0f + 140.0f * Random_Unit(system);
+
+		Spawn(system, x, y, cosf(angle) * speed, sinf(angle) * speed,
+			0.3f + 0.5f * Random_Unit(system), PARTICLE_FLAME);
+	}
+
+	for(particle = 0; particle < PARTICLE_BLAST_SMOKE; particle++)
+	{
+		float angle = PARTICLE_TWO_PI * Random_Unit(system);
+		float speed = 10.0f + 40.0f * Random_Unit(system);
+
+		Spawn(system, x, y, cosf(angle) * speed, sinf(angle) * speed - 40.0f,
+			0.8f + 0.8f * Random_Unit(system), PARTICLE_SMOKE);
+	}
+}
+
+static void Spawn(PARTICLESYSTEM* system, float x, float y, float xSpeed, float ySpeed, float life,
+				  PARTICLE_KIND kind)
+{
+	/**************************************************************************
+	*  PreCondition: life is above 0
+	* PostCondition: The particle will be the newest in the ring
+	*   Description: Adds one particle
+	*     Algorithm: If the ring is full, write over the oldest particle
+	*                Fill in the slot after the newest
+	**************************************************************************/
+	unsigned slot;
+
+	if(system->count == PARTICLE_CAPACITY)
+	{
+		system->start = (system->start + 1) & PARTICLE_RING_MASK;
+		system->count--;
+		system->overwritten++;
+	}
+
+	slot = (system->start + system->count) & PARTICLE_RING_MASK;
+	system->xCoordinate[slot] = x;
+	system->yCoordinate[slot] = y;
+	system->xSpeed[slot] = xSpeed;
+	system->ySpeed[slot] = ySpeed;
+	system->life[slot] = life;
+	system->fade[slot] = 1.0f / life;
+	system->kind[slot] = (unsigned char)kind;
+
+	system->count++;
+	system->spawned++;
+}
+
+static int Spans(const PARTICLESYSTEM* system, unsigned* first, unsigned* length)
+{
+	/**************************************************************************
+	*  PreCondition: first and length have room for two stretches
+	* PostCondition: The stretches of slots covering the ring in use will be
+	*                  returned, each starting on a mask word boundary, with
+	*                  how many there are
+	*   Description: Splits the ring where it wraps, so the kernels see plain
+	*                  columns. Slots before the oldest particle are dead, so
+	*                  starting a stretch early costs nothing but the work
+	*     Algorithm: Round the oldest slot down to its mask word
+	*                If the newest has wrapped round as far as that, cover
+	*                  the whole ring once
+	*                Otherwise one stretch to the newest, or two if it wraps
+	**************************************************************************/
+	unsigned aligned = system->start & ~63U;
+	unsigned end = system->start + system->count;
+
+	if(system->count == 0)
+		return 0;
+
+	if(end > PARTICLE_CAPACITY && end - PARTICLE_CAPACITY > aligned)
+	{
+		first[0] = 0;
+		length[0] = PARTICLE_CAPACITY;
+		return 1;
+	}
+
+	first[0] = aligned;
+	if(end <= PARTICLE_CAPACITY)
+	{
+		length[0] = end - aligned;
+		return 1;
+	}
+
+	length[0] = PARTICLE_CAPACITY - aligned;
+	first[1] = 0;
+	length[1] = end - PARTICLE_CAPACITY;
+	return 2;
+}
+
+static float Random_Unit(PARTICLESYSTEM* system)
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: A number from 0 up to but not including 1 is returned
+	*   Description: The system's own generator, so effects never disturb the
+	*                  world's random numbers
+	*     Algorithm: Step a linear congruential generator
+	*                Scale its upper bits into the range
+	**************************************************************************/
+	system->randomState = (system->randomState * 1103515245UL + 12345UL) & 0xFFFFFFFFUL;
+	return (float)(system->randomState >> 8) / 16777216.0f;
+}
@@ -0,0 +1,106 @@
+/******************************************************************************
+*        Title: Aerobatica
+* Date Started: April 10th, 2009
+*    Developer: Liam Hagerty
+*       Module: Particle System Header
+*  Description: This module contains the explosions and missile exhaust.
+*                 They are for show only and never touch the game world, so
+*                 they run on the window's thread at the frame rate.
+*
+*                 Particles are kept column by column in a ring, oldest
+*                 first, and are moved and aged a column at a time by the
+*                 SIMD kernels. A particle that dies part way along the
+*                 ring is left in place and skipped until the oldest end
+*                 catches up with it, and a full ring writes over its
+*                 oldest particles.
+*
+*                 The simulation thread reports where planes went down
+*                 through a lock-free ring of bursts, so no tick waits on
+*                 the effects and no blast is missed however many ticks run
+*                 between frames
+*      Version: 1.0
+******************************************************************************/
+#ifndef _PARTICLES_H
+#define _PARTICLES_H 1
+
+#pragma region Include Files
+#include <stdint.h>
+#include <atomic>
+#include "Aerobatica_simulation.h" //Blasts and missiles
+#include "Aerobatica_ringbuffer.h" //Burst queue
+#include "Aerobatica_simd.h"       //Particle kernels
+#pragma endregion
+
+#pragma region Constants
+#define PARTICLE_CAPACITY (1 << 17) //Particles the ring holds, a power of two
+#define PARTICLE_BURSTS 256         //Bursts the queue holds, a power of two
+#define PARTICLE_BLAST_FLAMES 48    //Flames thrown out by each blast
+#define PARTICLE_BLAST_SMOKE 24     //Smoke left by each blast
+#define PARTICLE_EXHAUST_RATE 60    //Puffs each missile leaves a second
+#define PARTICLE_GRAVITY 40.0f      //Pixels per second per second, downwards
+#define PARTICLE_DRAG 0.5f          //Share of its speed a particle keeps each second
+#define PARTICLE_MARGIN 16          //How far off the playfield a particle lives on
+#pragma endregion
+
+//What a particle looks like
+typedef enum
+{
+	PARTICLE_FLAME,
+	PARTICLE_SMOKE,
+	PARTICLE_EXHAUST,
+	PARTICLE_KIND_COUNT
+} PARTICLE_KIND;
+
+//Burst Structure, where a plane went down
+typedef struct
+{
+	short xCoordinate, yCoordinate;
+} PARTICLEBURST;
+
+//One particle to draw, centred on its position
+typedef struct
+{
+	short xCoordinate, yCoordinate;
+	unsigned char kind;  //PARTICLE_KIND
+	unsigned char shade; //255 when new, fading to 0 as it dies
+} PARTICLERECORD;
+
+//Particle System Structure
+typedef struct
+{
+	//The ring, running from start (oldest) for count slots
+	unsigned start, count;
+	float xCoordinate[PARTICLE_CAPACITY], yCoordinate[PARTICLE_CAPACITY];
+	float xSpeed[PARTICLE_CAPACITY], ySpeed[PARTICLE_CAPACITY]; //Pixels per second
+	float life[PARTICLE_CAPACITY]; //Seconds left, 0 once dead
+	float fade[PARTICLE_CAPACITY]; //One over the life it started with
+	unsigned char kind[PARTICLE_CAPACITY];
+	uint64_t live[HIT_WORDS(PARTICLE_CAPACITY)]; //Bit set for each particle alive after the last update
+
+	unsigned long randomState; //Its own generator, separate from the world's
+	float exhaustOwed;         //Part of a puff each missile is still due
+
+	//Simulation thread to window's thread
+	RINGBUFFER bursts;
+	PARTICLEBURST burstStorage[PARTICLE_BURSTS];
+	std::atomic<unsigned long> dropped; //Bursts lost to a full queue
+
+	unsigned long spawned, overwritten;
+} PARTICLESYSTEM;
+
+//Particle Batch Structure, what a frame draws
+typedef struct
+{
+	int count;
+	PARTICLERECORD records[PARTICLE_CAPACITY];
+} PARTICLEBATCH;
+
+#pragma region Function Prototypes
+void Particles_Init(PARTICLESYSTEM*, unsigned long);
+bool Particles_Burst(PARTICLESYSTEM*, int, int);
+void Particles_Burst_Blasts(PARTICLESYSTEM*, const SIMULATION*);
+void Particles_Exhaust(PARTICLESYSTEM*, const SIMULATION*, float);
+void Particles_Update(PARTICLESYSTEM*, float);
+void Particles_Emit(const PARTICLESYSTEM*, PARTICLEBATCH*);
+#pragma endregion
+#endif
@@ -0,0 +1,268 @@
+/******************************************************************************
+*        Title: Aerobatica
+* Date Started: April 10th, 2009
+*    Developer: Liam Hagerty
+*       Module: Profiler Code Module
+*  Description: This module contains the routines that record, gather and
+*                 report the scoped timings. Each recording thread pushes to
+*                 its own ring and only the thread calling Profile_Frame
+*                 reads them, so recording never takes a lock
+*      Version: 1.0
+******************************************************************************/
+#pragma region Includes
+#include "Aerobatica_profiler.h" //Profiler Definitions Header
+#ifdef AEROBATICA_PROFILE
+#include <stdlib.h>
+#include <string.h>
+#include "Aerobatica_ringbuffer.h" //Per-thread sample queues
+#include "Aerobatica_timer.h"      //High-resolution clock
+#endif
+#pragma endregion
+
+#ifdef AEROBATICA_PROFILE
+//Timings gathered for one named phase
+typedef struct
+{
+	const char* name;
+	unsigned long count;
+	long long maximum;
+	long long history[PROFILE_HISTORY]; //Latest durations, oldest overwritten
+} PROFILEPHASE;
+
+#pragma region Global Variables
+//Recording side, one ring per thread
+static RINGBUFFER rings[PROFILE_MAX_THREADS];
+static PROFILESAMPLE ringStorage[PROFILE_MAX_THREADS][PROFILE_RING_SAMPLES];
+static std::atomic<bool> ringReady[PROFILE_MAX_THREADS];
+static std::atomic<int> threadsClaimed(0);
+static std::atomic<unsigned long> samplesDropped(0);
+static thread_local int threadSlot = -1;
+
+//Gathering side, only touched by the thread calling Profile_Frame
+static PROFILEPHASE phases[PROFILE_MAX_PHASES];
+static int phaseCount = 0;
+static PROFILESAMPLE trace[PROFILE_TRACE_EVENTS];
+static unsigned long traceCount = 0; //Samples ever traced, the oldest are overwritten
+static long long lastFrame = 0;
+#pragma endregion
+
+#pragma region Function Prototypes
+static int Thread_Slot();
+static void Gather_Sample(const PROFILESAMPLE*);
+static int Compare_Durations(const void*, const void*);
+#pragma endregion
+
+PROFILESCOPE::PROFILESCOPE(const char* phase)
+{
+	/**************************************************************************
+	*  PreCondition: phase is a string literal
+	* PostCondition: The scope's start time will be noted
+	*   Description: Starts timing a scope
+	*     Algorithm: Read the clock
+	**************************************************************************/
+	name = phase;
+	start = Timer_Nanoseconds();
+}
+
+PROFILESCOPE::~PROFILESCOPE()
+{
+	/**************************************************************************
+	*  PreCondition: The scope is being left
+	* PostCondition: Its timing will be queued on this thread's ring, or
+	*                  counted as dropped if the ring is full
+	*   Description: Finishes timing a scope
+	*     Algorithm: Read the clock
+	*                Push the sample to the calling thread's ring
+	**************************************************************************/
+	PROFILESAMPLE sample;
+
+	sample.name = name;
+	sample.start = start;
+	sample.duration = Timer_Nanoseconds() - start;
+	sample.thread = Thread_Slot();
+
+	if(sample.thread == PROFILE_MAX_THREADS || !Ring_Push(&rings[sample.thread], &sample))
+		samplesDropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Profile_Frame()
+{
+	/**************************************************************************
+	*  PreCondition: Always called from the same thread
+	* PostCondition: The time since the last call will be recorded as the
+	*                  frame time, and every thread's queued samples gathered
+	*   Description: Frame boundary
+	*     Algorithm: Record the frame, unless this is the first
+	*                For each thread that has set up its ring,
+	*                  Gather everything waiting in it
+	**************************************************************************/
+	long long now = Timer_Nanoseconds();
+	int claimed = threadsClaimed.load(std::memory_order_acquire);
+	int slot;
+
+	//the frame itself
+	if(lastFrame != 0)
+	{
+		PROFILESAMPLE frame = { "Frame", lastFrame, now - lastFrame, Thread_Slot() };
+		Gather_Sample(&frame);
+	}
+	lastFrame = now;
+
+	//everything the threads have recorded
+	if(claimed > PROFILE_MAX_THREADS)
+		claimed = PROFILE_MAX_THREADS;
+	for(slot = 0; slot < claimed; slot++)
+	{
+		PROFILESAMPLE sample;
+
+		if(!ringReady[slot].load(std::memory_order_acquire))
+			continue;
+		while(Ring_Pop(&rings[slot], &sample))
+			Gather_Sample(&sample);
+	}
+}
+
+void Profile_Report(FILE* output)
+{
+	/**************************************************************************
+	*  PreCondition: Profile_Frame has gathered the samples to report
+	* PostCondition: Each phase's count and p50, p99 and max times will be
+	*                  printed
+	*   Description: Summary table
+	*     Algorithm: For each phase,
+	*                  Sort its latest durations
+	*                  Read the percentiles off the sorted list
+	*                Mention any samples the rings had to drop
+	**************************************************************************/
+	static long long sorted[PROFILE_HISTORY];
+	int phase;
+
+	fprintf(output, "%-20s %10s %10s %10s %10s\n", "phase", "count", "p50 us", "p99 us", "max us");
+	for(phase = 0; phase < phaseCount; phase++)
+	{
+		const PROFILEPHASE* timing = &phases[phase];
+		int kept = timing->count < PROFILE_HISTORY ? (int)timing->count : PROFILE_HISTORY;
+
+		memcpy(sorted, timing->history, kept * sizeof(long long));
+		qsort(sorted, kept, sizeof(long long), Compare_Durations);
+
+		fprintf(output, "%-20s %10lu %10.2f %10.2f %10.2f\n", timing->name, timing->count,
+			sorted[(kept - 1) * 50 / 100] / 1000.0, sorted[(kept - 1) * 99 / 100] / 1000.0,
+			timing->maximum / 1000.0);
+	}
+
+	if(samplesDropped.load() > 0)
+		fprintf(output, "%lu samples dropped, call PROFILE_FRAME more often\n", samplesDropped.load());
+}
+
+bool Profile_Write_Trace(const char* path)
+{
+	/**************************************************************************
+	*  PreCondition: Profile_Frame has gathered the samples to write
+	* PostCondition: The latest samples will be written as Chrome trace-event
+	*                  JSON, returns false if the file couldn't be written
+	*   Description: Trace export for chrome://tracing or Perfetto
+	*     Algorithm: Find the oldest sample still kept
+	*                Write each one, oldest first, as a complete ("X") event
+	*                  timed in microseconds from the first
+	**************************************************************************/
+	unsigned long kept = traceCount < PROFILE_TRACE_EVENTS ? traceCount : PROFILE_TRACE_EVENTS;
+	unsigned long first = traceCount - kept, event;
+	long long origin = kept > 0 ? trace[first % PROFILE_TRACE_EVENTS].start : 0;
+	FILE* output = fopen(path, "w");
+
+	if(output == NULL)
+		return false;
+
+	fprintf(output, "{\"traceEvents\":[\n");
+	for(event = first; event < traceCount; event++)
+	{
+		const PROFILESAMPLE* sample = &trace[event % PROFILE_TRACE_EVENTS];
+
+		fprintf(output, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}%s\n",
+			sample->name, sample->thread, (sample->start - origin) / 1000.0, sample->duration / 1000.0,
+			event + 1 < traceCount ? "," : "");
+	}
+	fprintf(output, "]}\n");
+
+	return fclose(output) == 0;
+}
+
+static int Thread_Slot()
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: The calling thread's ring number will be returned, or
+	*                  PROFILE_MAX_THREADS if every ring is taken
+	*   Description: Gives each recording thread a ring of its own
+	*     Algorithm: The first time a thread asks, claim the next ring, set it
+	*                  up and mark it ready for the gathering thread
+	**************************************************************************/
+	if(threadSlot < 0)
+	{
+		int slot = threadsClaimed.fetch_add(1);
+
+		if(slot >= PROFILE_MAX_THREADS)
+			slot = PROFILE_MAX_THREADS;
+		else
+		{
+			Ring_Init(&rings[slot], ringStorage[slot], PROFILE_RING_SAMPLES, sizeof(PROFILESAMPLE));
+			ringReady[slot].store(true, std::memory_order_release);
+		}
+		threadSlot = slot;
+	}
+
+	return threadSlot;
+}
+
+static void Gather_Sample(const PROFILESAMPLE* sample)
+{
+	/**************************************************************************
+	*  PreCondition: Called from the gathering thread
+	* PostCondition: The sample will be counted against its phase and kept
+	*                  for the trace
+	*   Description: Folds one sample into the statistics
+	*     Algorithm: Find the phase by name, adding it if it is new
+	*                Note the duration and the new maximum
+	*                Add the sample to the trace, over the oldest if full
+	**************************************************************************/
+	PROFILEPHASE* timing = NULL;
+	int phase;
+
+	//scopes use string literals, so the pointer usually matches
+	for(phase = 0; phase < phaseCount && timing == NULL; phase++)
+		if(phases[phase].name == sample->name || strcmp(phases[phase].name, sample->name) == 0)
+			timing = &phases[phase];
+	if(timing == NULL && phaseCount < PROFILE_MAX_PHASES)
+	{
+		timing = &phases[phaseCount++];
+		timing->name = sample->name;
+		timing->count = 0;
+		timing->maximum = 0;
+	}
+
+	if(timing != NULL)
+	{
+		timing->history[timing->count % PROFILE_HISTORY] = sample->duration;
+		timing->count++;
+		if(sample->duration > timing->maximum)
+			timing->maximum = sample->duration;
+	}
+
+	trace[traceCount % PROFILE_TRACE_EVENTS] = *sample;
+	traceCount++;
+}
+
+static int Compare_Durations(const void* first, const void* second)
+{
+	/**************************************************************************
+	*  PreCondition: Both point to durations
+	* PostCondition: Their order for qsort will be returned
+	*   Description: Ascending duration comparison
+	*     Algorithm: Compare without subtracting, so nothing can overflow
+	**************************************************************************/
+	long long a = *(const long long*)first, b = *(const long long*)second;
+
+	return (a > b) - (a < b);
+}
+#endif
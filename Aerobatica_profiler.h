@@ -0,0 +1,71 @@
+/******************************************************************************
+*        Title: Aerobatica
+* Date Started: April 10th, 2009
+*    Developer: Liam Hagerty
+*       Module: Profiler Header
+*  Description: This module contains the scoped timers that measure each
+*                 phase of a tick and a frame. A PROFILE_SCOPE records how
+*                 long the rest of its block took into a lock-free ring owned
+*                 by the calling thread, and PROFILE_FRAME gathers the rings
+*                 into per-phase p50/p99/max figures and a trace that loads
+*                 in chrome://tracing.
+*
+*                 Everything is compiled out unless AEROBATICA_PROFILE is
+*                 defined, the macros then expand to nothing
+*      Version: 1.0
+******************************************************************************/
+#ifndef _PROFILER_H
+#define _PROFILER_H 1
+
+#ifdef AEROBATICA_PROFILE
+#pragma region Include Files
+#include <stdio.h>
+#pragma endregion
+
+#pragma region Constants
+#define PROFILE_MAX_THREADS 32     //Threads that can record at once
+#define PROFILE_RING_SAMPLES 1024  //Samples a thread can hold between frames
+#define PROFILE_MAX_PHASES 64      //Differently named scopes
+#define PROFILE_HISTORY 4096       //Latest timings kept per phase for percentiles
+#define PROFILE_TRACE_EVENTS 65536 //Latest samples kept for the trace
+#pragma endregion
+
+//One timed scope
+typedef struct
+{
+	const char* name; //String literal naming the phase
+	long long start;  //Nanoseconds on the high-resolution clock
+	long long duration;
+	int thread;
+} PROFILESAMPLE;
+
+//Times the rest of the enclosing block
+class PROFILESCOPE
+{
+public:
+	PROFILESCOPE(const char*);
+	~PROFILESCOPE();
+private:
+	const char* name;
+	long long start;
+};
+
+#pragma region Function Prototypes
+void Profile_Frame();
+void Profile_Report(FILE*);
+bool Profile_Write_Trace(const char*);
+#pragma endregion
+
+#define PROFILE_JOIN(a, b) PROFILE_JOIN_LINE(a, b)
+#define PROFILE_JOIN_LINE(a, b) a##b
+#define PROFILE_SCOPE(name) PROFILESCOPE PROFILE_JOIN(profileScope, __LINE__)(name)
+#define PROFILE_FRAME() Profile_Frame()
+#define PROFILE_REPORT(file) Profile_Report(file)
+#define PROFILE_WRITE_TRACE(path) Profile_Write_Trace(path)
+#else
+#define PROFILE_SCOPE(name)
+#define PROFILE_FRAME()
+#define PROFILE_REPORT(file)
+#define PROFILE_WRITE_TRACE(path)
+#endif
+#endif
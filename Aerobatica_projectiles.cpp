@@ -0,0 +1,286 @@
+/******************************************************************************
+*        Title: Aerobatica
+* Date Started: April 10th, 2009
+*    Developer: Liam Hagerty
+*       Module: Projectile Pool Code Module
+*  Description: This module contains the routines that fire, steer, move
+*                 and retire the shots held in the projectile pool
+*      Version: 1.0
+******************************************************************************/
+#pragma region Includes
+#include <stdlib.h>
+#include "Aerobatica_collision.h"   //Swept box test
+#include "Aerobatica_projectiles.h" //Projectile Pool Definitions Header
+#pragma endregion
+
+#pragma region Global Variables
+//Each heading's direction, clockwise from facing right (y runs down the
+//screen) and HEADING_ONE long
+static const int headingX[PROJECTILE_HEADINGS] =
+{
+	256, 255, 251, 245, 237, 226, 213, 198, 181, 162, 142, 121, 98, 74, 50, 25,
+	0, -25, -50, -74, -98, -121, -142, -162, -181, -198, -213, -226, -237, -245, -251, -255,
+	-256, -255, -251, -245, -237, -226, -213, -198, -181, -162, -142, -121, -98, -74, -50, -25,
+	0, 25, 50, 74, 98, 121, 142, 162, 181, 198, 213, 226, 237, 245, 251, 255
+};
+
+static const int headingY[PROJECTILE_HEADINGS] =
+{
+	0, 25, 50, 74, 98, 121, 142, 162, 181, 198, 213, 226, 237, 245, 251, 255,
+	256, 255, 251, 245, 237, 226, 213, 198, 181, 162, 142, 121, 98, 74, 50, 25,
+	0, -25, -50, -74, -98, -121, -142, -162, -181, -198, -213, -226, -237, -245, -251, -255,
+	-256, -255, -251, -245, -237, -226, -213, -198, -181, -162, -142, -121, -98, -74, -50, -25
+};
+#pragma endregion
+
+void Pool_Clear(PROJECTILEPOOL* pool)
+{
+	/**************************************************************************
+	*  PreCondition: The pool has been allocated
+	* PostCondition: The pool will hold no shots and every handle will be free
+	*   Description: Empties the pool
+	*     Algorithm: Reset the count
+	*                Put every handle on the free list, lowest on top
+	**************************************************************************/
+	int handle;
+
+	pool->count = 0;
+	pool->freeCount = PROJECTILE_CAPACITY;
+	for(handle = 0; handle < PROJECTILE_CAPACITY; handle++)
+		pool->freeHandles[handle] = PROJECTILE_CAPACITY - 1 - handle;
+}
+
+int Pool_Spawn(PROJECTILEPOOL* pool, ENTITY_TYPE type, const SPRITE* properties)
+{
+	/**************************************************************************
+	*  PreCondition: Pool_Clear has run on the pool
+	* PostCondition: A new shot will be in flight, its handle returned, or
+	*                  NO_ENTITY if the pool is full
+	*   Description: Fires a shot
+	*     Algorithm: Take a handle off the free list
+	*                Append the shot to the end of the live slots
+	*                Head it the way it faces, and fuel it if it seeks
+	*                Link the handle and the slot both ways
+	**************************************************************************/
+	int handle, slot = pool->count;
+
+	//make sure there is room
+	if(pool->freeCount == 0)
+		return NO_ENTITY;
+	handle = pool->freeHandles[--pool->freeCount];
+	pool->count++;
+
+	//fill in the columns
+	pool->xCoordinate[slot] = properties->xCoordinate;
+	pool->yCoordinate[slot] = properties->yCoordinate;
+	pool->xSubpixel[slot] = 0;
+	pool->ySubpixel[slot] = 0;
+	pool->xSpeed[slot] = properties->xSpeed;
+	pool->ySpeed[slot] = properties->ySpeed;
+	pool->xAcceleration[slot] = properties->xAcceleration;
+	pool->yAcceleration[slot] = properties->yAcceleration;
+	pool->width[slot] = properties->width;
+	pool->height[slot] = properties->height;
+	pool->type[slot] = (unsigned char)type;
+	pool->faceRight[slot] = properties->faceRight;
+	pool->heading[slot] = properties->faceRight ? 0 : PROJECTILE_HEADINGS / 2;
+	pool->fuel[slot] = (entityTypeFlags[type] & TYPE_SEEKER) ? SEEKER_FUEL : 0;
+
+	//link the handle and slot
+	pool->handle[slot] = handle;
+	pool->slot[handle] = slot;
+
+	return handle;
+}
+
+void Pool_Despawn(PROJECTILEPOOL* pool, int handle)
+{
+	/**************************************************************************
+	*  PreCondition: The handle belongs to a shot in flight
+	* PostCondition: The shot will be retired
+	*   Description: Retires a shot by its handle
+	*     Algorithm: Look up its slot and retire that
+	**************************************************************************/
+	Pool_Despawn_Slot(pool, pool->slot[handle]);
+}
+
+void Pool_Despawn_Slot(PROJECTILEPOOL* pool, int slot)
+{
+	/**************************************************************************
+	*  PreCondition: The slot holds a shot in flight
+	* PostCondition: The shot will be retired and the live slots kept packed
+	*   Description: Retires a shot by its slot
+	*     Algorithm: Return its handle to the free list
+	*                Move the last live shot into the hole
+	*                Fix up the moved shot's handle
+	**************************************************************************/
+	int last = pool->count - 1;
+
+	//free the handle
+	pool->freeHandles[pool->freeCount++] = pool->handle[slot];
+
+	//fill the hole with the last shot
+	if(slot != last)
+	{
+		pool->xCoordinate[slot] = pool->xCoordinate[last];
+		pool->yCoordinate[slot] = pool->yCoordinate[last];
+		pool->xSubpixel[slot] = pool->xSubpixel[last];
+		pool->ySubpixel[slot] = pool->ySubpixel[last];
+		pool->xSpeed[slot] = pool->xSpeed[last];
+		pool->ySpeed[slot] = pool->ySpeed[last];
+		pool->xAcceleration[slot] = pool->xAcceleration[last];
+		pool->yAcceleration[slot] = pool->yAcceleration[last];
+		pool->width[slot] = pool->width[last];
+		pool->height[slot] = pool->height[last];
+		pool->type[slot] = pool->type[last];
+		pool->faceRight[slot] = pool->faceRight[last];
+		pool->heading[slot] = pool->heading[last];
+		pool->fuel[slot] = pool->fuel[last];
+		pool->handle[slot] = pool->handle[last];
+		pool->slot[pool->handle[slot]] = slot;
+	}
+
+	pool->count--;
+}
+
+void Pool_Move(PROJECTILEPOOL* pool, int begin, int end)
+{
+	/**************************************************************************
+	*  PreCondition: The pool has been cleared at least once, begin and end
+	*                  are within the live slots
+	* PostCondition: Every shot from begin to end - 1 will have sped up by
+	*                  its acceleration and moved by its speed
+	*   Description: Movement pass over the live slots
+	*     Algorithm: Fixed_Integrate() each axis
+	*                (every live slot moves, so the loops have no branches)
+	**************************************************************************/
+	Fixed_Integrate(pool->xCoordinate, pool->xSubpixel, pool->xSpeed, pool->xAcceleration, begin, end);
+	Fixed_Integrate(pool->yCoordinate, pool->ySubpixel, pool->ySpeed, pool->yAcceleration, begin, end);
+}
+
+void Pool_Steer(PROJECTILEPOOL* pool, int targetX, int targetY, int begin, int end)
+{
+	/**************************************************************************
+	*  PreCondition: The pool has been cleared at least once, begin and end
+	*                  are within the live slots
+	* PostCondition: Every seeker from begin to end - 1 with fuel left will
+	*                  have turned toward the target, at most SEEKER_TURN
+	*                  headings, and have its speed and facing to match
+	*   Description: Pursuit guidance for every seeker in one pass
+	*     Algorithm: For each shot,
+	*                  Build an all-ones mask if it has fuel left, otherwise
+	*                    all zeroes
+	*                  Cross its direction with the way to the target's
+	*                    middle to tell which way to turn, and dot them to
+	*                    tell whether it is already close enough to on course
+	*                  Turn unless it is on course, the shorter way round
+	*                    (either way if the target is dead behind)
+	*                  Masked, take the new heading's speed and facing and
+	*                    burn a tick of fuel
+	*                (no branches, so the loop vectorizes)
+	**************************************************************************/
+	int slot;
+
+	for(slot = begin; slot < end; slot++)
+	{
+		int seeking = pool->fuel[slot] > 0;
+		int mask = -seeking;
+		int heading = pool->heading[slot];
+		int toX = targetX - pool->xCoordinate[slot] - pool->width[slot] / 2;
+		int toY = targetY - pool->yCoordinate[slot] - pool->height[slot] / 2;
+		int cross = headingX[heading] * toY - headingY[heading] * toX;
+		int dot = headingX[heading] * toX + headingY[heading] * toY;
+		int aligned = (dot > 0) & (abs(cross) * SEEKER_ALIGNED < dot);
+		int turn = ((cross >= 0) * 2 - 1) * SEEKER_TURN & -(!aligned) & mask;
+		FIXED xSpeed, ySpeed;
+
+		//turn toward the target
+		heading = (heading + turn) & (PROJECTILE_HEADINGS - 1);
+		xSpeed = headingX[heading] * SEEKER_SPEED * (FIXED_ONE / HEADING_ONE);
+		ySpeed = headingY[heading] * SEEKER_SPEED * (FIXED_ONE / HEADING_ONE);
+
+		//fly the new heading
+		pool->heading[slot] = heading;
+		pool->xSpeed[slot] = (xSpeed & mask) | (pool->xSpeed[slot] & ~mask);
+		pool->ySpeed[slot] = (ySpeed & mask) | (pool->ySpeed[slot] & ~mask);
+		pool->faceRight[slot] = (unsigned char)(((headingX[heading] >= 0) & seeking) |
+			(pool->faceRight[slot] & !seeking));
+		pool->fuel[slot] -= seeking;
+	}
+}
+
+void Pool_Cull(PROJECTILEPOOL* pool, int fieldWidth, int fieldHeight)
+{
+	/**************************************************************************
+	*  PreCondition: The movement pass has run this tick
+	* PostCondition: Shots that have left the playfield will be retired
+	*   Description: Clean-up pass for the discharged firearms. A shot is only
+	*                  retired once its whole path this tick is off the
+	*                  playfield, so it can still hit something it passed on
+	*                  the way out
+	*     Algorithm: Walk the live slots from the back,
+	*                  If the box around a shot's path is entirely past any
+	*                    edge of the playfield, retire it (the shot moved
+	*                    into its slot has already been checked)
+	**************************************************************************/
+	int slot;
+
+	for(slot = pool->count - 1; slot >= 0; slot--)
+	{
+		int left, top, width = pool->width[slot], height = pool->height[slot];
+
+		AABB_Swept_Bounds(Fixed_Join(pool->xCoordinate[slot], pool->xSubpixel[slot]),
+			Fixed_Join(pool->yCoordinate[slot], pool->ySubpixel[slot]), pool->xSpeed[slot],
+			pool->ySpeed[slot], &left, &top, &width, &height);
+		if(left > fieldWidth || left + width < 0 || top > fieldHeight || top + height < 0)
+			Pool_Despawn_Slot(pool, slot);
+	}
+}
+
+int Pool_Find_Contact(const PROJECTILEPOOL* pool, const LEVEL* level, int x, int y,
+					  int width, int height, const COLLISIONMASK* mask, unsigned char typeFilter)
+{
+	/**************************************************************************
+	*  PreCondition: The pool has been cleared at least once, the shots' masks
+	*                  come from the level and mask is the box's (or NULL for
+	*                  a solid box)
+	* PostCondition: The slot holding the shot of a matching type that reached
+	*                  the box first this tick will be returned (the lowest
+	*                  slot on a tie), or NO_ENTITY
+	*   Description: Tests a box against the path of every shot, so a fast
+	*                  shot can't pass through it between ticks
+	*     Algorithm: For each live slot of a matching type,
+	*                  Skip it if the box around its path misses the box
+	*                  Sweep its mask against the box's, keeping the earliest
+	*                    impact
+	**************************************************************************/
+	COLLISIONMASK shot;
+	int slot, found = NO_ENTITY;
+	FIXED first = FIXED_ONE, impact;
+
+	for(slot = 0; slot < pool->count; slot++)
+	{
+		FIXED endX = Fixed_Join(pool->xCoordinate[slot], pool->xSubpixel[slot]);
+		FIXED endY = Fixed_Join(pool->yCoordinate[slot], pool->ySubpixel[slot]);
+		int left, top, pathWidth = pool->width[slot], pathHeight = pool->height[slot];
+
+		if(!(entityTypeFlags[pool->type[slot]] & typeFilter))
+			continue;
+
+		//cheap test on the whole path first
+		AABB_Swept_Bounds(endX, endY, pool->xSpeed[slot], pool->ySpeed[slot], &left, &top,
+			&pathWidth, &pathHeight);
+		if(!AABB_Overlap(left, top, pathWidth, pathHeight, x, y, width, height))
+			continue;
+
+		Level_Mask(level, pool->type[slot], pool->faceRight[slot] != 0, &shot);
+		if(Mask_Sweep(endX, endY, pool->width[slot], pool->height[slot], &shot, pool->xSpeed[slot],
+			pool->ySpeed[slot], x, y, width, height, mask, &impact) && (found == NO_ENTITY || impact < first))
+		{
+			found = slot;
+			first = impact;
+		}
+	}
+
+	return found;
+}
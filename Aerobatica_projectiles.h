@@ -0,0 +1,73 @@
+/******************************************************************************
+*        Title: Aerobatica
+* Date Started: April 10th, 2009
+*    Developer: Liam Hagerty
+*       Module: Projectile Pool Header
+*  Description: This module contains the fixed-capacity pool that holds every
+*                 bullet and missile in flight. Live projectiles are packed at
+*                 the front of each column so updates only visit shots that
+*                 exist, and a free list of handles makes firing and retiring
+*                 a shot constant time with no memory allocation.
+*
+*                 Seekers fly one of a table of headings and turn toward
+*                 their target a limited amount each tick until their fuel
+*                 runs out, steered by one branch-free pass over the pool
+*      Version: 1.0
+******************************************************************************/
+#ifndef _PROJECTILES_H
+#define _PROJECTILES_H 1
+
+#pragma region Include Files
+#include "Aerobatica_entities.h" //Entity types and the SPRITE structure
+#include "Aerobatica_level.h"    //Collision masks of each type
+#pragma endregion
+
+#pragma region Constants
+#define PROJECTILE_CAPACITY 1024 //Most shots in flight at once
+
+//Seeker guidance
+#define PROJECTILE_HEADINGS 64 //Directions in the heading table, a power of two
+#define HEADING_ONE 256        //Length of each direction in the table
+#define SEEKER_SPEED 7         //Whole pixels a seeker flies each tick
+#define SEEKER_TURN 1          //Headings a seeker can turn each tick
+#define SEEKER_FUEL 200        //Ticks a seeker steers for before flying straight
+#define SEEKER_ALIGNED 20      //Off by less than 1 in this, a seeker holds its heading
+#pragma endregion
+
+//Projectile Pool Structure
+typedef struct
+{
+	int count; //Shots in flight, always slots 0 to count - 1
+
+	//Kinematic columns, indexed by slot, whole pixels with the fraction
+	//alongside
+	int xCoordinate[PROJECTILE_CAPACITY], yCoordinate[PROJECTILE_CAPACITY];
+	uint16_t xSubpixel[PROJECTILE_CAPACITY], ySubpixel[PROJECTILE_CAPACITY];
+	FIXED xSpeed[PROJECTILE_CAPACITY], ySpeed[PROJECTILE_CAPACITY];
+	FIXED xAcceleration[PROJECTILE_CAPACITY], yAcceleration[PROJECTILE_CAPACITY];
+	int width[PROJECTILE_CAPACITY], height[PROJECTILE_CAPACITY];
+	unsigned char type[PROJECTILE_CAPACITY];
+	unsigned char faceRight[PROJECTILE_CAPACITY];
+	int heading[PROJECTILE_CAPACITY]; //Seekers' direction in the heading table
+	int fuel[PROJECTILE_CAPACITY];    //Ticks of steering left, 0 for other shots
+
+	//Handles stay the same while a shot is in flight, slots move when
+	//another shot is retired
+	int handle[PROJECTILE_CAPACITY]; //Handle of the shot in each slot
+	int slot[PROJECTILE_CAPACITY];   //Slot of the shot with each handle
+	int freeHandles[PROJECTILE_CAPACITY];
+	int freeCount;
+} PROJECTILEPOOL;
+
+#pragma region Function Prototypes
+void Pool_Clear(PROJECTILEPOOL*);
+int Pool_Spawn(PROJECTILEPOOL*, ENTITY_TYPE, const SPRITE*);
+void Pool_Despawn(PROJECTILEPOOL*, int);
+void Pool_Despawn_Slot(PROJECTILEPOOL*, int);
+void Pool_Move(PROJECTILEPOOL*, int, int);
+void Pool_Steer(PROJECTILEPOOL*, int, int, int, int);
+void Pool_Cull(PROJECTILEPOOL*, int, int);
+int Pool_Find_Contact(const PROJECTILEPOOL*, const LEVEL*, int, int, int, int,
+					  const COLLISIONMASK*, unsigned char);
+#pragma endregion
+#endif
@@ -0,0 +1,322 @@
+/******************************************************************************
+*        Title: Aerobatica
+* Date Started: April 10th, 2009
+*    Developer: Liam Hagerty
+*       Module: Render Queue Code Module
+*  Description: This module contains the routines that turn the game world
+*                 into a sorted stream of draw records
+*      Version: 1.0
+******************************************************************************/
+#pragma region Includes
+#include <string.h>
+#include "Aerobatica_render.h"   //Render Queue Definitions Header
+#include "Aerobatica_profiler.h" //Phase timings
+#pragma endregion
+
+//The world's share of the queue, handed to the chunk jobs
+typedef struct
+{
+	RENDERQUEUE* queue;
+	const SIMULATION* world;
+	const RENDERHISTORY* history; //NULL if it isn't from the tick before
+	float back;                   //How far to draw back toward the history
+	int firstRow;
+} RENDERWORLD;
+
+#pragma region Function Prototypes
+static void Emit_Rows(RENDERWORLD*, int, int);
+static void Emit_Rows_Job(void*, int, int);
+static int First_Past(const RENDERHISTORY*, uint64_t);
+#pragma endregion
+
+void Render_Clear(RENDERQUEUE* queue)
+{
+	/**************************************************************************
+	*  PreCondition: The queue has been allocated
+	* PostCondition: The queue will hold no draw records
+	*   Description: Starts a new frame's queue
+	*     Algorithm: Reset the counts
+	**************************************************************************/
+	queue->count = 0;
+	queue->sortedCount = 0;
+}
+
+void Render_Emit(RENDERQUEUE* queue, int frame, int x, int y, bool faceRight)
+{
+	/**************************************************************************
+	*  PreCondition: Render_Clear has run this frame
+	* PostCondition: A draw record will be appended if the frame has artwork
+	*                  and the queue has room
+	*   Description: Queues one sprite
+	*     Algorithm: Skip frames without artwork and a full queue
+	*                Place() it after the last record
+	**************************************************************************/
+	if(frame == FRAME_NONE || queue->count >= RENDER_CAPACITY)
+		return;
+
+	Render_Place(queue, queue->count++, frame, x, y, faceRight);
+}
+
+void Render_Place(RENDERQUEUE* queue, int row, int frame, int x, int y, bool faceRight)
+{
+	/**************************************************************************
+	*  PreCondition: The row has been reserved in the queue
+	* PostCondition: The row will hold the sprite, FRAME_NONE leaves a gap
+	*                  the sort skips
+	*   Description: Fills in one record, rows can be filled in any order and
+	*                  from any thread
+	*     Algorithm: Pack the frame, position and facing into the record
+	**************************************************************************/
+	DRAWRECORD* record = &queue->records[row];
+
+	record->xCoordinate = (short)x;
+	record->yCoordinate = (short)y;
+	record->frame = (unsigned char)frame;
+	record->flip = !faceRight;
+}
+
+void Render_Capture(RENDERHISTORY* history, const SIMULATION* world)
+{
+	/**************************************************************************
+	*  PreCondition: Sim_Init has run on the world
+	* PostCondition: The history will hold the planes' current positions
+	*   Description: Run just before each tick so the frame drawn after it
+	*                  knows where the planes came from
+	*     Algorithm: Note the tick
+	*                Copy the live part of the position columns
+	*                Note which plane is in each row
+	**************************************************************************/
+	const ENTITYSTORE* store = &world->entities;
+	int index;
+
+	history->tick = world->tick;
+	history->count = store->count;
+	memcpy(history->xCoordinate, store->xCoordinate, store->count * sizeof(int));
+	memcpy(history->yCoordinate, store->yCoordinate, store->count * sizeof(int));
+	for(index = 0; index < store->count; index++)
+		history->order[index] = Entity_Order(store, index);
+}
+
+void Render_Emit_World(RENDERQUEUE* queue, const SIMULATION* world,
+					   const RENDERHISTORY* history, float alpha, JOBSYSTEM* jobs)
+{
+	/**************************************************************************
+	*  PreCondition: Render_Clear has run this frame. jobs is running and
+	*                  owned by this thread, or NULL
+	* PostCondition: A draw record will be queued for everything visible
+	*   Description: The game world's part of the frame. With a history from
+	*                  just before the latest tick, everything is drawn alpha
+	*                  of the way from where it was to where it is now
+	*     Algorithm: Reserve a row per plane and per shot
+	*                If there is a job system and enough rows, fill them in
+	*                  with chunk jobs, otherwise fill them all in here (each
+	*                  row is fixed, so both give the same records)
+	**************************************************************************/
+	RENDERWORLD rows;
+	int count = world->entities.count + world->projectiles.count;
+
+	//make sure everything fits
+	if(queue->count + count > RENDER_CAPACITY)
+		count = RENDER_CAPACITY - queue->count;
+
+	rows.queue = queue;
+	rows.world = world;
+	rows.history = history != NULL && history->tick + 1 == world->tick ? history : NULL;
+	rows.back = rows.history != NULL ? 1.0f - alpha : 0.0f;
+	rows.firstRow = queue->count;
+	queue->count += count;
+
+	if(jobs != NULL && count >= RENDER_JOBS_MIN_ROWS)
+	{
+		JOB* job = Job_Create(jobs, Emit_Rows_Job, &rows, 0, count, RENDER_CHUNK);
+
+		Job_Submit(jobs, job);
+		Job_Wait(jobs, job);
+		Jobs_Reset(jobs);
+	}
+	else
+		Emit_Rows(&rows, 0, count);
+}
+
+void Render_Snapshot(WORLDSNAPSHOT* snapshot, const SIMULATION* world,
+					 const RENDERHISTORY* history, long long now)
+{
+	/**************************************************************************
+	*  PreCondition: The snapshot isn't being drawn
+	* PostCondition: The snapshot will hold the world, where its planes were
+	*                  before the latest tick and when the ticks were run
+	*   Description: Freezes the world for a frame drawn on another thread
+	*     Algorithm: Copy the world (it is plain data) and the history
+	*                Stamp it with the clock reading
+	**************************************************************************/
+	PROFILE_SCOPE("Render_Snapshot");
+
+	memcpy(&snapshot->world, world, sizeof(SIMULATION));
+	memcpy(&snapshot->history, history, sizeof(RENDERHISTORY));
+	snapshot->published = now;
+}
+
+float Render_Snapshot_Alpha(const WORLDSNAPSHOT* snapshot, long long now)
+{
+	/**************************************************************************
+	*  PreCondition: The snapshot has been published
+	* PostCondition: How far the clock is between the snapshot's last tick
+	*                  and the next will be returned, from 0 up to 1
+	*   Description: Sim_Alpha() for a frame drawn some time after the ticks
+	*                  were run
+	*     Algorithm: Add the time since the snapshot to the time it had banked
+	*                Divide by the tick length, stopping at the next tick
+	*                  (the world isn't guessed at past it)
+	**************************************************************************/
+	long long banked = snapshot->world.accumulator + (now - snapshot->published);
+
+	if(banked >= SIM_TICK_US)
+		return 1.0f;
+	if(banked < 0)
+		return 0.0f;
+	return (float)banked / SIM_TICK_US;
+}
+
+static void Emit_Rows(RENDERWORLD* rows, int begin, int end)
+{
+	/**************************************************************************
+	*  PreCondition: The rows were reserved by Render_Emit_World
+	* PostCondition: Rows begin to end - 1 will hold their sprites
+	*   Description: Fills in a run of the world's rows, planes first then
+	*                  shots
+	*     Algorithm: For each row,
+	*                  If it is a plane,
+	*                    Leave a gap if it has been shot down
+	*                    Blend its position with the history's, if it has
+	*                      one (both are in store order, so the history is
+	*                      walked alongside, starting where First_Past()
+	*                      finds the chunk's first plane)
+	*                  If it is a shot,
+	*                    Blend its position with one tick's travel back
+	*                      (shots only ever move by their speed)
+	*                  Place() its frame
+	**************************************************************************/
+	const ENTITYSTORE* store = &rows->world->entities;
+	const PROJECTILEPOOL* pool = &rows->world->projectiles;
+	const RENDERHISTORY* history = rows->history;
+	const uint8_t* typeFrames = rows->world->level->header->typeFrames;
+	float back = rows->back;
+	int row, past = 0;
+
+	if(history != NULL && begin < store->count)
+		past = First_Past(history, Entity_Order(store, begin));
+
+	for(row = begin; row < end; row++)
+	{
+		int index = row, frame, x, y;
+		bool faceRight;
+
+		if(index < store->count)
+		{
+			//a plane
+			x = store->xCoordinate[index];
+			y = store->yCoordinate[index];
+			frame = Entity_Flag(store->destroyed, index) ? (int)FRAME_NONE : (int)typeFrames[store->type[index]];
+			faceRight = Entity_Flag(store->faceRight, index);
+
+			//planes added during the tick have no history
+			if(history != NULL)
+			{
+				uint64_t order = Entity_Order(store, index);
+
+				while(past < history->count && history->order[past] < order)
+					past++;
+				if(past < history->count && history->order[past] == order)
+				{
+					x -= (int)((x - history->xCoordinate[past]) * back);
+					y -= (int)((y - history->yCoordinate[past]) * back);
+				}
+			}
+		}
+		else
+		{
+			//a shot
+			index -= store->count;
+			x = Fixed_Floor(Fixed_Join(pool->xCoordinate[index], pool->xSubpixel[index]) - (FIXED)(pool->xSpeed[index] * back));
+			y = Fixed_Floor(Fixed_Join(pool->yCoordinate[index], pool->ySubpixel[index]) - (FIXED)(pool->ySpeed[index] * back));
+			frame = typeFrames[pool->type[index]];
+			faceRight = pool->faceRight[index] != 0;
+		}
+
+		Render_Place(rows->queue, rows->firstRow + row, frame, x, y, faceRight);
+	}
+}
+
+static void Emit_Rows_Job(void* data, int begin, int end)
+{
+	/**************************************************************************
+	*  PreCondition: Queued by Render_Emit_World, data is its RENDERWORLD
+	* PostCondition: Rows begin to end - 1 will hold their sprites
+	*   Description: Job body for filling in the world's rows
+	*     Algorithm: Emit_Rows() on the chunk
+	**************************************************************************/
+	PROFILE_SCOPE("Emit_Rows");
+
+	Emit_Rows((RENDERWORLD*)data, begin, end);
+}
+
+static int First_Past(const RENDERHISTORY* history, uint64_t order)
+{
+	/**************************************************************************
+	*  PreCondition: The history's rows are in rising order
+	* PostCondition: The first history row whose order isn't below the one
+	*                  given will be returned, count if there is none
+	*   Description: Finds where a plane's position is kept in the history
+	*     Algorithm: Binary search the order column
+	**************************************************************************/
+	int low = 0, high = history->count, middle;
+
+	while(low < high)
+	{
+		middle = low + (high - low) / 2;
+		if(history->order[middle] < order)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+
+	return low;
+}
+
+void Render_Sort(RENDERQUEUE* queue)
+{
+	/**************************************************************************
+	*  PreCondition: The frame's records have been queued
+	* PostCondition: The sorted list will hold the unflipped records followed
+	*                  by the flipped ones, keeping their queued order within
+	*                  each group, with the gaps left out
+	*   Description: Counting sort on whether each record is mirrored, so the
+	*                  renderer only changes its transform at the flipped ones
+	*     Algorithm: Count the unflipped records
+	*                Copy each record that isn't a gap to its group's next slot
+	**************************************************************************/
+	int start[2] = { 0, 0 };
+	int record;
+
+	//count the unflipped records, the flipped ones start after them
+	for(record = 0; record < queue->count; record++)
+		start[1] += !queue->records[record].flip && queue->records[record].frame != FRAME_NONE;
+
+	//place each record
+	for(record = 0; record < queue->count; record++)
+		if(queue->records[record].frame != FRAME_NONE)
+			queue->sorted[start[queue->records[record].flip]++] = queue->records[record];
+	queue->sortedCount = start[1];
+}
+
+const ATLASRECT* Render_Source(const LEVEL* level, const DRAWRECORD* record)
+{
+	/**************************************************************************
+	*  PreCondition: The record came from Render_Emit, with a frame from the
+	*                  level's table
+	* PostCondition: The sprite sheet rectangle to draw will be returned
+	*   Description: Looks a record up in the level's frame table
+	*     Algorithm: Index the table by the record's frame
+	**************************************************************************/
+	return &level->frames[record->frame];
+}
@@ -0,0 +1,77 @@
+/******************************************************************************
+*        Title: Aerobatica
+* Date Started: April 10th, 2009
+*    Developer: Liam Hagerty
+*       Module: Render Queue Header
+*  Description: This module contains the draw records the game world emits
+*                 each frame, naming frames from the level's table. Every
+*                 frame comes from the one sprite sheet, with left-facing
+*                 sprites flipped as they are drawn. The queue is sorted so
+*                 the flipped sprites come last, and nothing in here touches
+*                 Direct3D so the command stream can be checked headlessly.
+*                 Sprites can be placed part way between the last two ticks
+*                 so motion stays smooth whatever the frame rate, and drawn
+*                 from a snapshot of the world while the next ticks run on
+*                 another thread
+*      Version: 1.0
+******************************************************************************/
+#ifndef _RENDER_H
+#define _RENDER_H 1
+
+#pragma region Include Files
+#include "Aerobatica_simulation.h" //Game world being drawn
+#pragma endregion
+
+#pragma region Constants
+#define RENDER_CAPACITY (ENTITY_CAPACITY + PROJECTILE_CAPACITY)
+#define RENDER_JOBS_MIN_ROWS 1024 //Sprites before queueing is worth splitting
+#define RENDER_CHUNK 256          //Sprites per queueing job
+#pragma endregion
+
+//One sprite to draw
+typedef struct
+{
+	short xCoordinate, yCoordinate; //Top-left corner on screen
+	unsigned char frame;            //Row of the level's frame table
+	unsigned char flip;             //Drawn mirrored, facing left
+} DRAWRECORD;
+
+//Render Queue Structure
+typedef struct
+{
+	int count;       //Rows in use, some may be gaps (FRAME_NONE)
+	int sortedCount; //Records in the sorted list
+	DRAWRECORD records[RENDER_CAPACITY]; //In the order they were queued
+	DRAWRECORD sorted[RENDER_CAPACITY];  //Unflipped first, then flipped
+} RENDERQUEUE;
+
+//Where the planes were before the latest tick
+typedef struct
+{
+	unsigned long tick; //Tick the positions were captured after
+	int count;
+	int xCoordinate[ENTITY_CAPACITY], yCoordinate[ENTITY_CAPACITY];
+	uint64_t order[ENTITY_CAPACITY]; //Which plane each position belongs to
+} RENDERHISTORY;
+
+//Everything a frame needs from the simulation thread, published after
+//each batch of ticks and never changed while it is being drawn
+typedef struct
+{
+	SIMULATION world;
+	RENDERHISTORY history; //Positions before the latest tick
+	long long published;   //Clock reading (microseconds) the ticks were run at
+} WORLDSNAPSHOT;
+
+#pragma region Function Prototypes
+void Render_Clear(RENDERQUEUE*);
+void Render_Emit(RENDERQUEUE*, int, int, int, bool);
+void Render_Place(RENDERQUEUE*, int, int, int, int, bool);
+void Render_Capture(RENDERHISTORY*, const SIMULATION*);
+void Render_Emit_World(RENDERQUEUE*, const SIMULATION*, const RENDERHISTORY*, float, JOBSYSTEM*);
+void Render_Snapshot(WORLDSNAPSHOT*, const SIMULATION*, const RENDERHISTORY*, long long);
+float Render_Snapshot_Alpha(const WORLDSNAPSHOT*, long long);
+void Render_Sort(RENDERQUEUE*);
+const ATLASRECT* Render_Source(const LEVEL*, const DRAWRECORD*);
+#pragma endregion
+#endif
@@ -0,0 +1,222 @@
+/******************************************************************************
+*        Title: Aerobatica
+* Date Started: April 10th, 2009
+*    Developer: Liam Hagerty
+*       Module: Input Log Code Module
+*  Description: This module contains the routines that record, read and
+*                 re-simulate input logs
+*      Version: 1.0
+******************************************************************************/
+#pragma region Includes
+#include "Aerobatica_replay.h" //Input Log Definitions Header
+#pragma endregion
+
+#pragma region Constants
+static const unsigned char replayMagic[4] = { 'A', 'E', 'R', 'O' };
+#pragma endregion
+
+#pragma region Function Prototypes
+static void Put_Value(unsigned char*, unsigned long, int);
+static unsigned long Get_Value(const unsigned char*, int);
+#pragma endregion
+
+bool Replay_Create(INPUTLOG* log, const char* path, unsigned long seed, unsigned short flags)
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: The log file will be created with its header, returns
+	*                  false if it couldn't be
+	*   Description: Starts recording a session
+	*     Algorithm: Create the file
+	*                Write the header with no ticks yet
+	**************************************************************************/
+	unsigned char header[REPLAY_HEADER_BYTES];
+
+	log->file = fopen(path, "wb");
+	if(log->file == NULL)
+		return false;
+	log->flags = flags;
+	log->seed = seed;
+	log->ticks = 0;
+
+	//the tick count is filled in when the log is finished
+	memcpy(header, replayMagic, sizeof(replayMagic));
+	Put_Value(header + 4, REPLAY_VERSION, 2);
+	Put_Value(header + 6, flags, 2);
+	Put_Value(header + 8, seed, 4);
+	Put_Value(header + 12, 0, 4);
+	fwrite(header, 1, sizeof(header), log->file);
+
+	return true;
+}
+
+void Replay_Write(INPUTLOG* log, SIM_INPUT input, unsigned long hash)
+{
+	/**************************************************************************
+	*  PreCondition: Replay_Create has succeeded
+	* PostCondition: One tick will be appended to the log
+	*   Description: Records the controls a tick was run with and the state
+	*                  the tick left the world in
+	*     Algorithm: Write the input bits, then the hash if the log keeps them
+	*                Every so often push the log to disk, so a crash still
+	*                  leaves a usable log behind
+	**************************************************************************/
+	unsigned char record[5];
+	int length = 1;
+
+	record[0] = input;
+	if(log->flags & REPLAY_HASHES)
+	{
+		Put_Value(record + 1, hash, 4);
+		length = 5;
+	}
+	fwrite(record, 1, length, log->file);
+
+	if(++log->ticks % REPLAY_FLUSH_TICKS == 0)
+		fflush(log->file);
+}
+
+void Replay_Finish(INPUTLOG* log)
+{
+	/**************************************************************************
+	*  PreCondition: Replay_Create has succeeded
+	* PostCondition: The log will be complete and closed
+	*   Description: Stops recording a session
+	*     Algorithm: Fill in the header's tick count
+	*                Close the file
+	**************************************************************************/
+	unsigned char count[4];
+
+	Put_Value(count, log->ticks, 4);
+	fseek(log->file, 12, SEEK_SET);
+	fwrite(count, 1, sizeof(count), log->file);
+	Replay_Close(log);
+}
+
+bool Replay_Open(INPUTLOG* log, const char* path)
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: The log will be ready to read from its first tick,
+	*                  returns false if it is missing or isn't an input log
+	*   Description: Starts reading a recorded session
+	*     Algorithm: Open the file
+	*                Check the header's magic and version
+	*                Keep the seed and flags
+	**************************************************************************/
+	unsigned char header[REPLAY_HEADER_BYTES];
+
+	log->file = fopen(path, "rb");
+	if(log->file == NULL)
+		return false;
+
+	//make sure this is a log we understand
+	if(fread(header, 1, sizeof(header), log->file) != sizeof(header) ||
+		memcmp(header, replayMagic, sizeof(replayMagic)) != 0 ||
+		Get_Value(header + 4, 2) != REPLAY_VERSION)
+	{
+		Replay_Close(log);
+		return false;
+	}
+
+	log->flags = (unsigned short)Get_Value(header + 6, 2);
+	log->seed = Get_Value(header + 8, 4);
+	log->ticks = 0;
+
+	return true;
+}
+
+bool Replay_Read(INPUTLOG* log, SIM_INPUT* input, unsigned long* hash)
+{
+	/**************************************************************************
+	*  PreCondition: Replay_Open has succeeded
+	* PostCondition: The next tick's input and hash will be filled in,
+	*                  returns false at the end of the log
+	*   Description: Reads one tick
+	*     Algorithm: Read the input bits, and the hash if the log keeps them
+	*                  (a tick cut short by a crash counts as the end)
+	**************************************************************************/
+	unsigned char record[5];
+	size_t length = (log->flags & REPLAY_HASHES) ? 5 : 1;
+
+	if(fread(record, 1, length, log->file) != length)
+		return false;
+
+	*input = record[0];
+	*hash = (length == 5) ? Get_Value(record + 1, 4) : 0;
+	log->ticks++;
+
+	return true;
+}
+
+void Replay_Close(INPUTLOG* log)
+{
+	/**************************************************************************
+	*  PreCondition: The log was created or opened
+	* PostCondition: The file will be closed
+	*   Description: Releases the log's file
+	*     Algorithm: Close it if it is open
+	**************************************************************************/
+	if(log->file != NULL)
+		fclose(log->file);
+	log->file = NULL;
+}
+
+long Replay_Run(INPUTLOG* log, SIMULATION* world)
+{
+	/**************************************************************************
+	*  PreCondition: Replay_Open has succeeded
+	* PostCondition: The world will hold the state at the end of the log, or
+	*                  at the first tick that differed. The differing tick's
+	*                  number is returned, or REPLAY_MATCH
+	*   Description: Re-simulates a recorded session as fast as possible
+	*     Algorithm: Start a round with the log's seed
+	*                For each tick in the log,
+	*                  Run it with the recorded input
+	*                  If the log keeps hashes and this one differs, stop
+	**************************************************************************/
+	SIM_INPUT input;
+	unsigned long hash;
+
+	Sim_Init(world, log->seed);
+
+	while(Replay_Read(log, &input, &hash))
+	{
+		Sim_Tick(world, input);
+		if((log->flags & REPLAY_HASHES) && Sim_Hash(world) != hash)
+			return (long)log->ticks;
+	}
+
+	return REPLAY_MATCH;
+}
+
+static void Put_Value(unsigned char* bytes, unsigned long value, int length)
+{
+	/**************************************************************************
+	*  PreCondition: bytes has room for length bytes
+	* PostCondition: The value will be stored little-endian
+	*   Description: Writes a field of the log
+	*     Algorithm: Store the value a byte at a time, lowest first
+	**************************************************************************/
+	int index;
+
+	for(index = 0; index < length; index++)
+		bytes[index] = (unsigned char)(value >> (8 * index));
+}
+
+static unsigned long Get_Value(const unsigned char* bytes, int length)
+{
+	/**************************************************************************
+	*  PreCondition: bytes holds length bytes
+	* PostCondition: The little-endian value will be returned
+	*   Description: Reads a field of the log
+	*     Algorithm: Gather the bytes, highest first
+	**************************************************************************/
+	unsigned long value = 0;
+	int index;
+
+	for(index = length - 1; index >= 0; index--)
+		value = (value << 8) | bytes[index];
+
+	return value;
+}
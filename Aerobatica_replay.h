@@ -0,0 +1,57 @@
+/******************************************************************************
+*        Title: Aerobatica
+* Date Started: April 10th, 2009
+*    Developer: Liam Hagerty
+*       Module: Input Log Header
+*  Description: This module contains the input log that records a session
+*                 as its seed plus the controls held each tick, and the
+*                 routine that re-simulates one. A log optionally carries the
+*                 world's state hash after every tick so a replay can point
+*                 at the first tick that played out differently.
+*
+*                 Log layout, every field little-endian:
+*                   4 bytes  "AERO"
+*                   2 bytes  format version
+*                   2 bytes  flags (REPLAY_HASHES)
+*                   4 bytes  seed
+*                   4 bytes  tick count (0 if the game never finished it)
+*                   per tick: 1 byte of input bits, then with REPLAY_HASHES
+*                             4 bytes of state hash
+*      Version: 1.0
+******************************************************************************/
+#ifndef _REPLAY_H
+#define _REPLAY_H 1
+
+#pragma region Include Files
+#include <stdio.h>
+#include <string.h>
+#include "Aerobatica_simulation.h" //Game world being replayed
+#pragma endregion
+
+#pragma region Constants
+#define REPLAY_VERSION 8
+#define REPLAY_HEADER_BYTES 16
+#define REPLAY_HASHES 0x0001 //Each tick carries the state hash
+#define REPLAY_FLUSH_TICKS 32 //Ticks between writes to disk while recording
+#define REPLAY_MATCH -1       //Replay_Run found no differing tick
+#pragma endregion
+
+//Input Log Structure
+typedef struct
+{
+	FILE* file;
+	unsigned short flags;
+	unsigned long seed;
+	unsigned long ticks; //Ticks written or read so far
+} INPUTLOG;
+
+#pragma region Function Prototypes
+bool Replay_Create(INPUTLOG*, const char*, unsigned long, unsigned short);
+void Replay_Write(INPUTLOG*, SIM_INPUT, unsigned long);
+void Replay_Finish(INPUTLOG*);
+bool Replay_Open(INPUTLOG*, const char*);
+bool Replay_Read(INPUTLOG*, SIM_INPUT*, unsigned long*);
+void Replay_Close(INPUTLOG*);
+long Replay_Run(INPUTLOG*, SIMULATION*);
+#pragma endregion
+#endif
@@ -0,0 +1,88 @@
+/******************************************************************************
+*        Title: Aerobatica
+* Date Started: April 10th, 2009
+*    Developer: Liam Hagerty
+*       Module: Ring Buffer Code Module
+*  Description: This module contains the single-producer, single-consumer
+*                 ring buffer routines
+*      Version: 1.0
+******************************************************************************/
+#pragma region Includes
+#include <string.h>
+#include "Aerobatica_ringbuffer.h" //Ring Buffer Definitions Header
+#pragma endregion
+
+void Ring_Init(RINGBUFFER* ring, void* storage, unsigned capacity, size_t recordSize)
+{
+	/**************************************************************************
+	*  PreCondition: capacity is a power of two and storage holds capacity
+	*                  records, neither thread is using the ring yet
+	* PostCondition: The ring will be empty and ready for use
+	*   Description: Sets up a ring over the caller's storage
+	*     Algorithm: Reset both ends
+	*                Keep the storage and the index mask
+	**************************************************************************/
+	ring->head.store(0, std::memory_order_relaxed);
+	ring->tail.store(0, std::memory_order_relaxed);
+	ring->mask = capacity - 1;
+	ring->recordSize = recordSize;
+	ring->storage = (unsigned char*)storage;
+}
+
+bool Ring_Push(RINGBUFFER* ring, const void* record)
+{
+	/**************************************************************************
+	*  PreCondition: Only the producer thread calls this
+	* PostCondition: The record will be queued, returns false if the ring was
+	*                  full and the record dropped
+	*   Description: Producer end
+	*     Algorithm: If the consumer hasn't made room, give up
+	*                Copy the record into the next slot
+	*                Publish it by moving the head on (release, so the copy
+	*                  is visible before the new head)
+	**************************************************************************/
+	unsigned head = ring->head.load(std::memory_order_relaxed);
+
+	if(head - ring->tail.load(std::memory_order_acquire) > ring->mask)
+		return false;
+
+	memcpy(ring->storage + (head & ring->mask) * ring->recordSize, record, ring->recordSize);
+	ring->head.store(head + 1, std::memory_order_release);
+
+	return true;
+}
+
+bool Ring_Pop(RINGBUFFER* ring, void* record)
+{
+	/**************************************************************************
+	*  PreCondition: Only the consumer thread calls this
+	* PostCondition: The oldest record will be copied out and removed,
+	*                  returns false if the ring was empty
+	*   Description: Consumer end
+	*     Algorithm: If the producer hasn't published anything new, give up
+	*                Copy the record out of the oldest slot
+	*                Free the slot by moving the tail on (release, so the
+	*                  copy is finished before the producer can reuse it)
+	**************************************************************************/
+	unsigned tail = ring->tail.load(std::memory_order_relaxed);
+
+	if(tail == ring->head.load(std::memory_order_acquire))
+		return false;
+
+	memcpy(record, ring->storage + (tail & ring->mask) * ring->recordSize, ring->recordSize);
+	ring->tail.store(tail + 1, std::memory_order_release);
+
+	return true;
+}
+
+unsigned Ring_Count(const RINGBUFFER* ring)
+{
+	/**************************************************************************
+	*  PreCondition: Ring_Init has run on the ring
+	* PostCondition: The number of records waiting will be returned (only a
+	*                  snapshot if the other thread is busy with the ring)
+	*   Description: Fill level of the ring
+	*     Algorithm: Subtract the tail from the head
+	**************************************************************************/
+	return ring->head.load(std::memory_order_acquire) - ring->tail.load(std::memory_order_acquire);
+}
@@ -0,0 +1,42 @@
+/******************************************************************************
+*        Title: Aerobatica
+* Date Started: April 10th, 2009
+*    Developer: Liam Hagerty
+*       Module: Ring Buffer Header
+*  Description: This module contains the lock-free ring buffer that passes
+*                 fixed-size records from one producer thread to one consumer
+*                 thread. The caller supplies the storage, so pushing and
+*                 popping never allocate, lock or wait
+*      Version: 1.0
+******************************************************************************/
+#ifndef _RINGBUFFER_H
+#define _RINGBUFFER_H 1
+
+#pragma region Include Files
+#include <stddef.h>
+#include <atomic>
+#pragma endregion
+
+#pragma region Constants
+#define RING_CACHE_LINE 64 //Keeps the two ends from sharing a cache line
+#pragma endregion
+
+//Ring Buffer Structure
+typedef struct
+{
+	std::atomic<unsigned> head; //Records pushed so far, only the producer writes it
+	char headPadding[RING_CACHE_LINE - sizeof(std::atomic<unsigned>)];
+	std::atomic<unsigned> tail; //Records popped so far, only the consumer writes it
+	char tailPadding[RING_CACHE_LINE - sizeof(std::atomic<unsigned>)];
+	unsigned mask;        //Capacity - 1, the capacity is a power of two
+	size_t recordSize;
+	unsigned char* storage;
+} RINGBUFFER;
+
+#pragma region Function Prototypes
+void Ring_Init(RINGBUFFER*, void*, unsigned, size_t);
+bool Ring_Push(RINGBUFFER*, const void*);
+bool Ring_Pop(RINGBUFFER*, void*);
+unsigned Ring_Count(const RINGBUFFER*);
+#pragma endregion
+#endif
@@ -0,0 +1,114 @@
+/******************************************************************************
+*        Title: Aerobatica
+* Date Started: April 10th, 2009
+*    Developer: Liam Hagerty
+*       Module: Spawn Schedule Code Module
+*  Description: This module contains the binary heap routines behind the
+*                 spawn timeline
+*      Version: 1.0
+******************************************************************************/
+#pragma region Includes
+#include "Aerobatica_schedule.h" //Spawn Schedule Definitions Header
+#pragma endregion
+
+#pragma region Function Prototypes
+static bool Event_Before(const SPAWNEVENT*, const SPAWNEVENT*);
+#pragma endregion
+
+void Schedule_Clear(SPAWNSCHEDULE* schedule)
+{
+	/**************************************************************************
+	*  PreCondition: The schedule has been allocated
+	* PostCondition: Nothing will be waiting
+	*   Description: Empties the timeline
+	*     Algorithm: Reset the count
+	**************************************************************************/
+	schedule->count = 0;
+}
+
+bool Schedule_Push(SPAWNSCHEDULE* schedule, unsigned long due, uint32_t spawn)
+{
+	/**************************************************************************
+	*  PreCondition: The schedule has been cleared at least once
+	* PostCondition: The spawn will wait for its tick, returns false if the
+	*                  schedule was full and the spawn dropped
+	*   Description: Adds a spawn to the timeline in O(log n)
+	*     Algorithm: Put the event in the first free leaf
+	*                Sift it up past every parent due after it
+	**************************************************************************/
+	SPAWNEVENT event;
+	int child, parent;
+
+	if(schedule->count >= SCHEDULE_CAPACITY)
+		return false;
+
+	event.due = due;
+	event.spawn = spawn;
+
+	//sift up
+	for(child = schedule->count++; child > 0; child = parent)
+	{
+		parent = (child - 1) / 2;
+		if(!Event_Before(&event, &schedule->events[parent]))
+			break;
+		schedule->events[child] = schedule->events[parent];
+	}
+	schedule->events[child] = event;
+
+	return true;
+}
+
+bool Schedule_Due(const SPAWNSCHEDULE* schedule, unsigned long tick)
+{
+	/**************************************************************************
+	*  PreCondition: The schedule has been cleared at least once
+	* PostCondition: Returns whether a spawn is due on or before the tick
+	*   Description: Checks the front of the timeline in O(1)
+	*     Algorithm: Compare the root's tick
+	**************************************************************************/
+	return schedule->count > 0 && schedule->events[0].due <= tick;
+}
+
+SPAWNEVENT Schedule_Pop(SPAWNSCHEDULE* schedule)
+{
+	/**************************************************************************
+	*  PreCondition: The schedule isn't empty
+	* PostCondition: The soonest spawn will be removed and returned
+	*   Description: Takes the front of the timeline in O(log n)
+	*     Algorithm: Keep the root
+	*                Take the last leaf and sift it down from the root past
+	*                  every child due before it
+	**************************************************************************/
+	SPAWNEVENT front = schedule->events[0];
+	SPAWNEVENT last = schedule->events[--schedule->count];
+	int parent = 0, child;
+
+	//sift down
+	while((child = parent * 2 + 1) < schedule->count)
+	{
+		if(child + 1 < schedule->count && Event_Before(&schedule->events[child + 1], &schedule->events[child]))
+			child++;
+		if(!Event_Before(&schedule->events[child], &last))
+			break;
+		schedule->events[parent] = schedule->events[child];
+		parent = child;
+	}
+	schedule->events[parent] = last;
+
+	return front;
+}
+
+static bool Event_Before(const SPAWNEVENT* first, const SPAWNEVENT* second)
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: Returns whether the first event comes out before the
+	*                  second
+	*   Description: Heap order
+	*     Algorithm: Sooner tick first, then lower spawn row
+	**************************************************************************/
+	if(first->due != second->due)
+		return first->due < second->due;
+
+	return first->spawn < second->spawn;
+}
@@ -0,0 +1,44 @@
+/******************************************************************************
+*        Title: Aerobatica
+* Date Started: April 10th, 2009
+*    Developer: Liam Hagerty
+*       Module: Spawn Schedule Header
+*  Description: This module contains the timeline of planes waiting to be
+*                 spawned. It is a binary min-heap keyed on the tick each
+*                 spawn is due and then its place in the level, so spawns
+*                 due on the same tick always come out in the same order
+*                 and the world stays plain data that replays exactly
+*      Version: 1.0
+******************************************************************************/
+#ifndef _SCHEDULE_H
+#define _SCHEDULE_H 1
+
+#pragma region Include Files
+#include <stdint.h>
+#pragma endregion
+
+#pragma region Constants
+#define SCHEDULE_CAPACITY 4096 //Spawns that can be waiting at once
+#pragma endregion
+
+//One spawn waiting for its tick
+typedef struct
+{
+	unsigned long due; //Tick to spawn on
+	uint32_t spawn;    //Row of the level's spawn table
+} SPAWNEVENT;
+
+//Spawn Schedule Structure
+typedef struct
+{
+	int count;
+	SPAWNEVENT events[SCHEDULE_CAPACITY]; //Heap order, soonest first
+} SPAWNSCHEDULE;
+
+#pragma region Function Prototypes
+void Schedule_Clear(SPAWNSCHEDULE*);
+bool Schedule_Push(SPAWNSCHEDULE*, unsigned long, uint32_t);
+bool Schedule_Due(const SPAWNSCHEDULE*, unsigned long);
+SPAWNEVENT Schedule_Pop(SPAWNSCHEDULE*);
+#pragma endregion
+#endif
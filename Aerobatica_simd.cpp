@@ -0,0 +1,520 @@
+/******************************************************************************
+*        Title: Aerobatica
+* Date Started: April 10th, 2009
+*    Developer: Liam Hagerty
+*       Module: SIMD Kernel Code Module
+*  Description: This module contains the batched box tests and particle
+*                 steps. One box is tested against a packed column of boxes
+*                 four (SSE2) or eight (AVX2) at a time and the results are
+*                 written as a bitmask, bit n set meaning box n overlaps.
+*                 Particles are moved and aged the same number at a time,
+*                 with the ones still alive written as the same kind of mask
+*      Version: 1.0
+******************************************************************************/
+#pragma region Includes
+#include <string.h>
+#include "Aerobatica_simd.h"      //SIMD Kernel Definitions Header
+#include "Aerobatica_collision.h" //Scalar box test
+#pragma endregion
+
+#pragma region Platform
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SIMD_X86 1
+#include <emmintrin.h> //SSE2
+#include <immintrin.h> //AVX2
+#ifdef _MSC_VER
+#include <intrin.h>
+#define TARGET_AVX2
+#else
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+#pragma endregion
+
+//Signature shared by every version of the one-versus-many kernel
+typedef void (*ONEVSMANYKERNEL)(int, int, int, int, const int*, const int*,
+								const int*, const int*, int, uint64_t*);
+
+//Signatures shared by every version of the particle kernels
+typedef void (*INTEGRATEKERNEL)(float*, float*, float*, float*, int, float, float, float);
+typedef void (*AGEKERNEL)(float*, const float*, const float*, int, float, const float*, uint64_t*);
+
+//One version of every kernel, all for the same instruction set
+typedef struct
+{
+	const char* name;
+	ONEVSMANYKERNEL oneVsMany;
+	INTEGRATEKERNEL integrate;
+	AGEKERNEL age;
+} KERNELSET;
+
+#pragma region Function Prototypes
+static void One_Vs_Many_Scalar(int, int, int, int, const int*, const int*,
+							   const int*, const int*, int, uint64_t*);
+static void Integrate_Scalar(float*, float*, float*, float*, int, float, float, float);
+static void Age_Scalar(float*, const float*, const float*, int, float, const float*, uint64_t*);
+#ifdef SIMD_X86
+static void One_Vs_Many_SSE2(int, int, int, int, const int*, const int*,
+							 const int*, const int*, int, uint64_t*);
+static void Integrate_SSE2(float*, float*, float*, float*, int, float, float, float);
+static void Age_SSE2(float*, const float*, const float*, int, float, const float*, uint64_t*);
+TARGET_AVX2 static void One_Vs_Many_AVX2(int, int, int, int, const int*, const int*,
+										 const int*, const int*, int, uint64_t*);
+TARGET_AVX2 static void Integrate_AVX2(float*, float*, float*, float*, int, float, float, float);
+TARGET_AVX2 static void Age_AVX2(float*, const float*, const float*, int, float, const float*,
+								 uint64_t*);
+static bool CPU_Has_SSE2();
+static bool CPU_Has_AVX2();
+#endif
+static KERNELSET Select_Kernels();
+static const KERNELSET* Kernels();
+#pragma endregion
+
+void Collision_One_Vs_Many(int x, int y, int width, int height,
+						   const int* xCoordinates, const int* yCoordinates,
+						   const int* widths, const int* heights, int count, uint64_t* hits)
+{
+	/**************************************************************************
+	*  PreCondition: hits holds HIT_WORDS(count) words
+	* PostCondition: Bit n of hits will be set if box n overlaps the given box
+	*   Description: Tests one box against a packed column of boxes
+	*     Algorithm: Clear the mask
+	*                Run the fastest kernel the processor supports
+	**************************************************************************/
+	memset(hits, 0, HIT_WORDS(count) * sizeof(uint64_t));
+	Kernels()->oneVsMany(x, y, width, height, xCoordinates, yCoordinates, widths, heights, count, hits);
+}
+
+const char* Collision_Kernel_Name()
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: The name of the kernel set in use will be returned
+	*   Description: Lets benchmarks report which kernels they measured
+	*     Algorithm: Ask the kernel selection for its name
+	**************************************************************************/
+	return Kernels()->name;
+}
+
+void Particle_Integrate(float* xCoordinates, float* yCoordinates, float* xSpeeds, float* ySpeeds,
+						int count, float seconds, float gravity, float damping)
+{
+	/**************************************************************************
+	*  PreCondition: Every column holds count particles, speeds are in pixels
+	*                  per second
+	* PostCondition: Each particle will have moved on by the seconds, its
+	*                  speed damped and gravity added
+	*   Description: Moves a packed column of particles
+	*     Algorithm: Run the fastest kernel the processor supports
+	**************************************************************************/
+	Kernels()->integrate(xCoordinates, yCoordinates, xSpeeds, ySpeeds, count, seconds, gravity, damping);
+}
+
+void Particle_Age(float* lives, const float* xCoordinates, const float* yCoordinates, int count,
+				  float seconds, const float* bounds, uint64_t* live)
+{
+	/**************************************************************************
+	*  PreCondition: live holds HIT_WORDS(count) words, bounds holds the left,
+	*                  top, right and bottom edges particles may be within
+	* PostCondition: Each particle will be the seconds older, those out of
+	*                  life or out of bounds left with none, and bit n of
+	*                  live set if particle n is still alive
+	*   Description: Ages a packed column of particles and finds the ones to
+	*                  keep
+	*     Algorithm: Clear the mask
+	*                Run the fastest kernel the processor supports
+	**************************************************************************/
+	memset(live, 0, HIT_WORDS(count) * sizeof(uint64_t));
+	Kernels()->age(lives, xCoordinates, yCoordinates, count, seconds, bounds, live);
+}
+
+static const KERNELSET* Kernels()
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: The kernels to use will be returned
+	*   Description: Chooses the kernels once, the first time one is needed
+	*     Algorithm: Select the kernels on first use and remember them
+	**************************************************************************/
+	static const KERNELSET selected = Select_Kernels();
+
+	return &selected;
+}
+
+static KERNELSET Select_Kernels()
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: The fastest supported kernels will be returned
+	*   Description: Runtime processor feature check
+	*     Algorithm: Use AVX2 if the processor and OS support it
+	*                Else use SSE2 if the processor supports it
+	*                Else use the plain versions
+	**************************************************************************/
+#ifdef SIMD_X86
+	if(CPU_Has_AVX2())
+	{
+		KERNELSET avx2 = { "avx2", One_Vs_Many_AVX2, Integrate_AVX2, Age_AVX2 };
+		return avx2;
+	}
+	if(CPU_Has_SSE2())
+	{
+		KERNELSET sse2 = { "sse2", One_Vs_Many_SSE2, Integrate_SSE2, Age_SSE2 };
+		return sse2;
+	}
+#endif
+	KERNELSET scalar = { "scalar", One_Vs_Many_Scalar, Integrate_Scalar, Age_Scalar };
+	return scalar;
+}
+
+static void One_Vs_Many_Scalar(int x, int y, int width, int height,
+							   const int* xCoordinates, const int* yCoordinates,
+							   const int* widths, const int* heights, int count, uint64_t* hits)
+{
+	/**************************************************************************
+	*  PreCondition: hits has been cleared
+	* PostCondition: The overlap bits will be set
+	*   Description: Plain C++ version for processors without SSE2
+	*     Algorithm: For each box, or its box test result into its bit
+	**************************************************************************/
+	int box;
+
+	for(box = 0; box < count; box++)
+		hits[box >> 6] |= (uint64_t)AABB_Overlap(x, y, width, height, xCoordinates[box],
+			yCoordinates[box], widths[box], heights[box]) << (box & 63);
+}
+
+static void Integrate_Scalar(float* xCoordinates, float* yCoordinates, float* xSpeeds,
+							 float* ySpeeds, int count, float seconds, float gravity, float damping)
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: The particles will have moved
+	*   Description: Plain C++ version for processors without SSE2
+	*     Algorithm: For each particle, move it by its speed, then damp the
+	*                  speed and let gravity pull on it
+	**************************************************************************/
+	float fall = gravity * seconds;
+	int particle;
+
+	for(particle = 0; particle < count; particle++)
+	{
+		xCoordinates[particle] += xSpeeds[particle] * seconds;
+		yCoordinates[particle] += ySpeeds[particle] * seconds;
+		xSpeeds[particle] *= damping;
+		ySpeeds[particle] = ySpeeds[particle] * damping + fall;
+	}
+}
+
+static void Age_Scalar(float* lives, const float* xCoordinates, const float* yCoordinates,
+					   int count, float seconds, const float* bounds, uint64_t* live)
+{
+	/**************************************************************************
+	*  PreCondition: live has been cleared
+	* PostCondition: The particles will have aged and the live bits be set
+	*   Description: Plain C++ version for processors without SSE2
+	*     Algorithm: For each particle,
+	*                  Take the seconds off its life
+	*                  Keep it if it has life left and is within bounds,
+	*                    otherwise leave it none
+	*                  Or whether it was kept into its bit
+	**************************************************************************/
+	int particle;
+
+	for(particle = 0; particle < count; particle++)
+	{
+		float life = lives[particle] - seconds;
+		bool alive = life > 0.0f &&
+			xCoordinates[particle] >= bounds[0] && yCoordinates[particle] >= bounds[1] &&
+			xCoordinates[particle] < bounds[2] && yCoordinates[particle] < bounds[3];
+
+		lives[particle] = alive ? life : 0.0f;
+		live[particle >> 6] |= (uint64_t)alive << (particle & 63);
+	}
+}
+
+#ifdef SIMD_X86
+static void One_Vs_Many_SSE2(int x, int y, int width, int height,
+							 const int* xCoordinates, const int* yCoordinates,
+							 const int* widths, const int* heights, int count, uint64_t* hits)
+{
+	/**************************************************************************
+	*  PreCondition: hits has been cleared
+	* PostCondition: The overlap bits will be set
+	*   Description: Four boxes per step
+	*     Algorithm: Broadcast the query box's edges
+	*                For each group of four boxes,
+	*                  Compare all four edges at once and and the results
+	*                  Pack the four lane results into four mask bits
+	*                Test any leftover boxes one at a time
+	**************************************************************************/
+	const __m128i left = _mm_set1_epi32(x), top = _mm_set1_epi32(y);
+	const __m128i right = _mm_set1_epi32(x + width), bottom = _mm_set1_epi32(y + height);
+	int box = 0;
+
+	for(; box + 4 <= count; box += 4)
+	{
+		__m128i boxLeft = _mm_loadu_si128((const __m128i*)(xCoordinates + box));
+		__m128i boxTop = _mm_loadu_si128((const __m128i*)(yCoordinates + box));
+		__m128i boxRight = _mm_add_epi32(boxLeft, _mm_loadu_si128((const __m128i*)(widths + box)));
+		__m128i boxBottom = _mm_add_epi32(boxTop, _mm_loadu_si128((const __m128i*)(heights + box)));
+		__m128i hit = _mm_and_si128(
+			_mm_and_si128(_mm_cmplt_epi32(left, boxRight), _mm_cmplt_epi32(boxLeft, right)),
+			_mm_and_si128(_mm_cmplt_epi32(top, boxBottom), _mm_cmplt_epi32(boxTop, bottom)));
+
+		//groups never straddle a mask word since 64 is a multiple of 4
+		hits[box >> 6] |= (uint64_t)_mm_movemask_ps(_mm_castsi128_ps(hit)) << (box & 63);
+	}
+
+	//finish the tail
+	for(; box < count; box++)
+		hits[box >> 6] |= (uint64_t)AABB_Overlap(x, y, width, height, xCoordinates[box],
+			yCoordinates[box], widths[box], heights[box]) << (box & 63);
+}
+
+static void Integrate_SSE2(float* xCoordinates, float* yCoordinates, float* xSpeeds,
+						   float* ySpeeds, int count, float seconds, float gravity, float damping)
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: The particles will have moved
+	*   Description: Four particles per step
+	*     Algorithm: Broadcast the step's time, damping and fall
+	*                For each group of four particles, move them and update
+	*                  their speeds at once
+	*                Move any leftover particles one at a time
+	**************************************************************************/
+	const __m128 time = _mm_set1_ps(seconds), damp = _mm_set1_ps(damping);
+	const __m128 fall = _mm_set1_ps(gravity * seconds);
+	int particle = 0;
+
+	for(; particle + 4 <= count; particle += 4)
+	{
+		__m128 xSpeed = _mm_loadu_ps(xSpeeds + particle);
+		__m128 ySpeed = _mm_loadu_ps(ySpeeds + particle);
+
+		_mm_storeu_ps(xCoordinates + particle,
+			_mm_add_ps(_mm_loadu_ps(xCoordinates + particle), _mm_mul_ps(xSpeed, time)));
+		_mm_storeu_ps(yCoordinates + particle,
+			_mm_add_ps(_mm_loadu_ps(yCoordinates + particle), _mm_mul_ps(ySpeed, time)));
+		_mm_storeu_ps(xSpeeds + particle, _mm_mul_ps(xSpeed, damp));
+		_mm_storeu_ps(ySpeeds + particle, _mm_add_ps(_mm_mul_ps(ySpeed, damp), fall));
+	}
+
+	//finish the tail
+	Integrate_Scalar(xCoordinates + particle, yCoordinates + particle, xSpeeds + particle,
+		ySpeeds + particle, count - particle, seconds, gravity, damping);
+}
+
+static void Age_SSE2(float* lives, const float* xCoordinates, const float* yCoordinates,
+					 int count, float seconds, const float* bounds, uint64_t* live)
+{
+	/**************************************************************************
+	*  PreCondition: live has been cleared
+	* PostCondition: The particles will have aged and the live bits be set
+	*   Description: Four particles per step
+	*     Algorithm: Broadcast the step's time and the bounds
+	*                For each group of four particles,
+	*                  Age them, compare their lives and all four edges at
+	*                    once and and the results
+	*                  Zero the lives of the ones not kept
+	*                  Pack the four lane results into four mask bits
+	*                Age any leftover particles one at a time
+	**************************************************************************/
+	const __m128 time = _mm_set1_ps(seconds), zero = _mm_setzero_ps();
+	const __m128 left = _mm_set1_ps(bounds[0]), top = _mm_set1_ps(bounds[1]);
+	const __m128 right = _mm_set1_ps(bounds[2]), bottom = _mm_set1_ps(bounds[3]);
+	int particle = 0;
+
+	for(; particle + 4 <= count; particle += 4)
+	{
+		__m128 life = _mm_sub_ps(_mm_loadu_ps(lives + particle), time);
+		__m128 x = _mm_loadu_ps(xCoordinates + particle);
+		__m128 y = _mm_loadu_ps(yCoordinates + particle);
+		__m128 alive = _mm_and_ps(
+			_mm_and_ps(_mm_cmpgt_ps(life, zero), _mm_and_ps(_mm_cmpge_ps(x, left), _mm_cmpge_ps(y, top))),
+			_mm_and_ps(_mm_cmplt_ps(x, right), _mm_cmplt_ps(y, bottom)));
+
+		_mm_storeu_ps(lives + particle, _mm_and_ps(life, alive));
+
+		//groups never straddle a mask word since 64 is a multiple of 4
+		live[particle >> 6] |= (uint64_t)_mm_movemask_ps(alive) << (particle & 63);
+	}
+
+	//finish the tail, its bits start part way into a mask word
+	for(; particle < count; particle++)
+	{
+		uint64_t word = 0;
+
+		Age_Scalar(lives + particle, xCoordinates + particle, yCoordinates + particle, 1, seconds,
+			bounds, &word);
+		live[particle >> 6] |= word << (particle & 63);
+	}
+}
+
+TARGET_AVX2 static void One_Vs_Many_AVX2(int x, int y, int width, int height,
+										 const int* xCoordinates, const int* yCoordinates,
+										 const int* widths, const int* heights, int count,
+										 uint64_t* hits)
+{
+	/**************************************************************************
+	*  PreCondition: hits has been cleared and the processor supports AVX2
+	* PostCondition: The overlap bits will be set
+	*   Description: Eight boxes per step
+	*     Algorithm: Broadcast the query box's edges
+	*                For each group of eight boxes,
+	*                  Compare all four edges at once and and the results
+	*                  Pack the eight lane results into eight mask bits
+	*                Test any leftover boxes one at a time
+	**************************************************************************/
+	const __m256i left = _mm256_set1_epi32(x), top = _mm256_set1_epi32(y);
+	const __m256i right = _mm256_set1_epi32(x + width), bottom = _mm256_set1_epi32(y + height);
+	int box = 0;
+
+	for(; box + 8 <= count; box += 8)
+	{
+		__m256i boxLeft = _mm256_loadu_si256((const __m256i*)(xCoordinates + box));
+		__m256i boxTop = _mm256_loadu_si256((const __m256i*)(yCoordinates + box));
+		__m256i boxRight = _mm256_add_epi32(boxLeft, _mm256_loadu_si256((const __m256i*)(widths + box)));
+		__m256i boxBottom = _mm256_add_epi32(boxTop, _mm256_loadu_si256((const __m256i*)(heights + box)));
+
+		//AVX2 only has greater-than, so a < b is written b > a
+		__m256i hit = _mm256_and_si256(
+			_mm256_and_si256(_mm256_cmpgt_epi32(boxRight, left), _mm256_cmpgt_epi32(right, boxLeft)),
+			_mm256_and_si256(_mm256_cmpgt_epi32(boxBottom, top), _mm256_cmpgt_epi32(bottom, boxTop)));
+
+		//groups never straddle a mask word since 64 is a multiple of 8
+		hits[box >> 6] |= (uint64_t)(unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(hit)) << (box & 63);
+	}
+
+	//finish the tail
+	for(; box < count; box++)
+		hits[box >> 6] |= (uint64_t)AABB_Overlap(x, y, width, height, xCoordinates[box],
+			yCoordinates[box], widths[box], heights[box]) << (box & 63);
+}
+
+TARGET_AVX2 static void Integrate_AVX2(float* xCoordinates, float* yCoordinates, float* xSpeeds,
+									   float* ySpeeds, int count, float seconds, float gravity,
+									   float damping)
+{
+	/**************************************************************************
+	*  PreCondition: The processor supports AVX2
+	* PostCondition: The particles will have moved
+	*   Description: Eight particles per step
+	*     Algorithm: Broadcast the step's time, damping and fall
+	*                For each group of eight particles, move them and update
+	*                  their speeds at once
+	*                Move any leftover particles one at a time
+	**************************************************************************/
+	const __m256 time = _mm256_set1_ps(seconds), damp = _mm256_set1_ps(damping);
+	const __m256 fall = _mm256_set1_ps(gravity * seconds);
+	int particle = 0;
+
+	for(; particle + 8 <= count; particle += 8)
+	{
+		__m256 xSpeed = _mm256_loadu_ps(xSpeeds + particle);
+		__m256 ySpeed = _mm256_loadu_ps(ySpeeds + particle);
+
+		_mm256_storeu_ps(xCoordinates + particle,
+			_mm256_add_ps(_mm256_loadu_ps(xCoordinates + particle), _mm256_mul_ps(xSpeed, time)));
+		_mm256_storeu_ps(yCoordinates + particle,
+			_mm256_add_ps(_mm256_loadu_ps(yCoordinates + particle), _mm256_mul_ps(ySpeed, time)));
+		_mm256_storeu_ps(xSpeeds + particle, _mm256_mul_ps(xSpeed, damp));
+		_mm256_storeu_ps(ySpeeds + particle, _mm256_add_ps(_mm256_mul_ps(ySpeed, damp), fall));
+	}
+
+	//finish the tail
+	Integrate_Scalar(xCoordinates + particle, yCoordinates + particle, xSpeeds + particle,
+		ySpeeds + particle, count - particle, seconds, gravity, damping);
+}
+
+TARGET_AVX2 static void Age_AVX2(float* lives, const float* xCoordinates, const float* yCoordinates,
+								 int count, float seconds, const float* bounds, uint64_t* live)
+{
+	/**************************************************************************
+	*  PreCondition: live has been cleared and the processor supports AVX2
+	* PostCondition: The particles will have aged and the live bits be set
+	*   Description: Eight particles per step
+	*     Algorithm: Broadcast the step's time and the bounds
+	*                For each group of eight particles,
+	*                  Age them, compare their lives and all four edges at
+	*                    once and and the results
+	*                  Zero the lives of the ones not kept
+	*                  Pack the eight lane results into eight mask bits
+	*                Age any leftover particles one at a time
+	**************************************************************************/
+	const __m256 time = _mm256_set1_ps(seconds), zero = _mm256_setzero_ps();
+	const __m256 left = _mm256_set1_ps(bounds[0]), top = _mm256_set1_ps(bounds[1]);
+	const __m256 right = _mm256_set1_ps(bounds[2]), bottom = _mm256_set1_ps(bounds[3]);
+	int particle = 0;
+
+	for(; particle + 8 <= count; particle += 8)
+	{
+		__m256 life = _mm256_sub_ps(_mm256_loadu_ps(lives + particle), time);
+		__m256 x = _mm256_loadu_ps(xCoordinates + particle);
+		__m256 y = _mm256_loadu_ps(yCoordinates + particle);
+		__m256 alive = _mm256_and_ps(
+			_mm256_and_ps(_mm256_cmp_ps(life, zero, _CMP_GT_OQ),
+				_mm256_and_ps(_mm256_cmp_ps(x, left, _CMP_GE_OQ), _mm256_cmp_ps(y, top, _CMP_GE_OQ))),
+			_mm256_and_ps(_mm256_cmp_ps(x, right, _CMP_LT_OQ), _mm256_cmp_ps(y, bottom, _CMP_LT_OQ)));
+
+		_mm256_storeu_ps(lives + particle, _mm256_and_ps(life, alive));
+
+		//groups never straddle a mask word since 64 is a multiple of 8
+		live[particle >> 6] |= (uint64_t)(unsigned)_mm256_movemask_ps(alive) << (particle & 63);
+	}
+
+	//finish the tail, its bits start part way into a mask word
+	for(; particle < count; particle++)
+	{
+		uint64_t word = 0;
+
+		Age_Scalar(lives + particle, xCoordinates + particle, yCoordinates + particle, 1, seconds,
+			bounds, &word);
+		live[particle >> 6] |= word << (particle & 63);
+	}
+}
+
+static bool CPU_Has_SSE2()
+{
+	/**************************************************************************
+	*  PreCondition: Running on an x86 processor
+	* PostCondition: Whether SSE2 is available will be returned
+	*   Description: Processor feature check
+	*     Algorithm: 64-bit builds always have it, otherwise ask CPUID
+	**************************************************************************/
+#if defined(_M_X64) || defined(__x86_64__)
+	return true;
+#elif defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 1);
+	return (info[3] & (1 << 26)) != 0;
+#else
+	return __builtin_cpu_supports("sse2") != 0;
+#endif
+}
+
+static bool CPU_Has_AVX2()
+{
+	/**************************************************************************
+	*  PreCondition: Running on an x86 processor
+	* PostCondition: Whether AVX2 is available will be returned
+	*   Description: Processor and operating system feature check
+	*     Algorithm: Ask CPUID for AVX2, then make sure the OS saves the
+	*                  wide registers across context switches
+	**************************************************************************/
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 1);
+	if(!(info[2] & (1 << 27)) || !(info[2] & (1 << 28))) //OSXSAVE and AVX
+		return false;
+	if((_xgetbv(0) & 6) != 6) //XMM and YMM state enabled
+		return false;
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+#endif
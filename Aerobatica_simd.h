@@ -0,0 +1,30 @@
+/******************************************************************************
+*        Title: Aerobatica
+* Date Started: April 10th, 2009
+*    Developer: Liam Hagerty
+*       Module: SIMD Kernel Header
+*  Description: This module contains the vectorized box tests and particle
+*                 steps. Each kernel has SSE2 and AVX2 versions plus a plain
+*                 C++ fallback, and the fastest set the processor supports
+*                 is picked the first time one is called
+*      Version: 1.0
+******************************************************************************/
+#ifndef _SIMD_H
+#define _SIMD_H 1
+
+#pragma region Include Files
+#include <stdint.h>
+#pragma endregion
+
+#pragma region Constants
+#define HIT_WORDS(count) (((count) + 63) / 64) //Mask words needed for count boxes
+#pragma endregion
+
+#pragma region Function Prototypes
+void Collision_One_Vs_Many(int, int, int, int, const int*, const int*, const int*,
+						   const int*, int, uint64_t*);
+const char* Collision_Kernel_Name();
+void Particle_Integrate(float*, float*, float*, float*, int, float, float, float);
+void Particle_Age(float*, const float*, const float*, int, float, const float*, uint64_t*);
+#pragma endregion
+#endif
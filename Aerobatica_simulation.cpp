@@ -0,0 +1,1449 @@
+/******************************************************************************
+*        Title: Aerobatica
+* Date Started: April 10th, 2009
+*    Developer: Liam Hagerty
+*       Module: Simulation Code Module
+*  Description: This module contains the game logic that advances the world
+*                 one fixed tick at a time, independent of any renderer
+*      Version: 1.0
+******************************************************************************/
+#pragma region Includes
+#include <stddef.h>
+#include <string.h>
+#include "Aerobatica_simulation.h" //Simulation Definitions Header
+#include "Aerobatica_simd.h"       //Batched box tests
+#include "Aerobatica_profiler.h"   //Phase timings
+#pragma endregion
+
+//The world and the point it chases this tick, handed to the movement jobs
+//so none of them reads the player's jet while another is moving planes
+typedef struct
+{
+	SIMULATION* world;
+	int targetX, targetY;
+} SIMMOVE;
+
+#pragma region Global Variables
+const SPRITE projectileTemplates[ENTITY_TYPE_COUNT] =
+{
+	//x y  xSpd              ySpd             xAcc                yAcc  width height right destroyed onscreen behavior
+	{ 0, 0, 0,                0,               0,                  0,    0,    0,     true, false, false, BEHAVIOR_NONE }, //Player Jet
+	{ 0, 0, 0,                0,               0,                  0,    0,    0,     true, false, false, BEHAVIOR_NONE }, //Vulcan Jet
+	{ 0, 0, 0,                0,               0,                  0,    0,    0,     true, false, false, BEHAVIOR_NONE }, //Missile Jet
+	{ 0, 0, 0,                0,               0,                  0,    0,    0,     true, false, false, BEHAVIOR_NONE }, //Helicopter
+	{ 0, 0, 0,                0,               0,                  0,    0,    0,     true, false, false, BEHAVIOR_NONE }, //Bomber
+	{ 0, 0, FIXED_PIXELS(50), 0,               0,                  0,    317,  36,    true, false, true,  BEHAVIOR_NONE }, //Player Bullet
+	{ 0, 0, FIXED_PIXELS(5),  0,               0,                  0,    317,  36,    true, false, true,  BEHAVIOR_NONE }, //Enemy Bullet
+	{ 0, 0, FIXED_PIXELS(2),  0,               FIXED_PIXELS(0.25), 0,    509,  40,    true, false, true,  BEHAVIOR_NONE }, //Missile
+	{ 0, 0, FIXED_PIXELS(5),  FIXED_PIXELS(5), 0,                  0,    509,  40,    true, false, true,  BEHAVIOR_NONE }  //Homing Missile
+};
+
+const WEAPON enemyWeapons[ENTITY_TYPE_COUNT] =
+{
+	//projectile            reload
+	{ ENTITY_TYPE_COUNT,     0 },   //Player Jet, fires by the controls
+	{ ENTITY_ENEMY_BULLET,   40 },  //Vulcan Jet
+	{ ENTITY_MISSILE,        80 },  //Missile Jet
+	{ ENTITY_HOMING_MISSILE, 120 }, //Helicopter
+	{ ENTITY_ENEMY_BULLET,   60 },  //Bomber
+	{ ENTITY_TYPE_COUNT,     0 },   //Player Bullet
+	{ ENTITY_TYPE_COUNT,     0 },   //Enemy Bullet
+	{ ENTITY_TYPE_COUNT,     0 },   //Missile
+	{ ENTITY_TYPE_COUNT,     0 }    //Homing Missile
+};
+
+static JOBSYSTEM* simJobs = NULL; //Job system ticks are split across, if any
+static const LEVEL* simLevel = NULL; //Level new rounds start from, NULL for the built-in one
+#pragma endregion
+
+#pragma region Constants
+#define HASH_OFFSET 2166136261UL //32-bit FNV-1a starting value
+#define HASH_PRIME 16777619UL    //32-bit FNV-1a multiplier
+#pragma endregion
+
+#pragma region Function Prototypes
+static unsigned long Hash_Bytes(unsigned long, const void*, size_t);
+static unsigned long Hash_Value(unsigned long, unsigned long);
+static size_t Pack_World(SIMULATION*, unsigned char*, bool);
+static void Pack_Bytes(unsigned char**, void*, size_t, bool);
+static void Note_Blast(SIMULATION*, int);
+static void Move_And_Aim_Jobs(SIMULATION*, JOBSYSTEM*);
+static void Move_Planes_Job(void*, int, int);
+static void Move_Shots_Job(void*, int, int);
+static void Cull_Shots_Job(void*, int, int);
+static void Aim_Shots_Job(void*, int, int);
+#pragma endregion
+
+void Sim_Init(SIMULATION* world, unsigned long seed)
+{
+	/**************************************************************************
+	*  PreCondition: The world has been allocated
+	* PostCondition: The world will be ready for its first tick
+	*   Description: Initializes a fresh round. The same seed, level and
+	*                  input every tick always play out the same round
+	*     Algorithm: Use the chosen level, or the built-in one
+	*                Set the default Sprites' Properties() from it
+	*                Seed the world's random number generator
+	*                Clear the tick accumulator and counters
+	*                Mark the round as being played
+	**************************************************************************/
+	//Set the default data for the sprites
+	world->level = simLevel != NULL ? simLevel : Level_Builtin();
+	world->tick = 0;
+	world->kills = 0;
+	world->events = 0;
+	world->blasts = 0;
+	Set_Sprites_Properties(world);
+
+	//the world never touches rand(), so a seed replays exactly
+	world->seed = seed & 0xFFFFFFFFUL;
+	world->randomState = world->seed;
+
+	//nothing has been simulated yet
+	world->accumulator = 0;
+	world->status = SIM_PLAYING;
+}
+
+void Sim_Restart(SIMULATION* world, const SIMSNAPSHOT* start, unsigned long seed)
+{
+	/**************************************************************************
+	*  PreCondition: start was saved from a world straight after Sim_Init,
+	*                  with the level still loaded
+	* PostCondition: The world will be ready for its first tick, exactly as
+	*                  if Sim_Init had been called with the seed
+	*   Description: Starts the next round in place. The starting cast Set
+	*                  Sprites Properties builds is the same every round, so
+	*                  it is only built once and copied back from then on
+	*     Algorithm: Restore the starting world
+	*                Seed its random number generator
+	**************************************************************************/
+	Sim_Restore(world, start);
+
+	world->seed = seed & 0xFFFFFFFFUL;
+	world->randomState = world->seed;
+}
+
+int Sim_Bank(SIMULATION* world, int elapsedMicroseconds)
+{
+	/**************************************************************************
+	*  PreCondition: Sim_Init has run on the world
+	* PostCondition: The number of whole ticks now due will be returned and
+	*                  taken out of the accumulator, the remainder is kept
+	*   Description: Lets a caller that needs to see each tick (recording,
+	*                  for one) run them itself with Sim_Tick
+	*     Algorithm: Bank the elapsed time
+	*                Cap the bank at the catch-up limit, so a stall (a dragged
+	*                  window, a breakpoint) slows the game down for a moment
+	*                  instead of making every later frame run more ticks
+	*                Count and remove the whole ticks banked
+	**************************************************************************/
+	int ticksDue = 0;
+
+	//bank the time that has passed, up to the catch-up limit
+	world->accumulator += elapsedMicroseconds;
+	if(world->accumulator > SIM_MAX_CATCHUP_TICKS * SIM_TICK_US)
+		world->accumulator = SIM_MAX_CATCHUP_TICKS * SIM_TICK_US;
+
+	//spend it one fixed tick at a time
+	while(world->accumulator >= SIM_TICK_US)
+	{
+		world->accumulator -= SIM_TICK_US;
+		ticksDue++;
+	}
+
+	return ticksDue;
+}
+
+int Sim_Step(SIMULATION* world, SIM_INPUT input, int elapsedMicroseconds)
+{
+	/**************************************************************************
+	*  PreCondition: Sim_Init has run on the world
+	* PostCondition: The world will be advanced by every whole tick that fits
+	*                  in the elapsed time, the remainder is kept for later
+	*   Description: Fixed-timestep stepping routine
+	*     Algorithm: Bank() the elapsed time
+	*                Run one Tick() with the given input for each tick due
+	*                Return the number of ticks that were run
+	**************************************************************************/
+	int ticksDue = Sim_Bank(world, elapsedMicroseconds);
+	int ticksRun;
+
+	for(ticksRun = 0; ticksRun < ticksDue; ticksRun++)
+		Sim_Tick(world, input);
+
+	return ticksDue;
+}
+
+void Sim_Use_Jobs(JOBSYSTEM* jobs)
+{
+	/**************************************************************************
+	*  PreCondition: jobs is running, or NULL. Ticks are run from the thread
+	*                  that owns it
+	* PostCondition: Large ticks will be split across the job system, or run
+	*                  on the calling thread alone if jobs is NULL
+	*   Description: Chooses how ticks run. Either way a tick plays out
+	*                  exactly the same, so replays match
+	*     Algorithm: Keep the job system
+	**************************************************************************/
+	simJobs = jobs;
+}
+
+void Sim_Use_Level(const LEVEL* level)
+{
+	/**************************************************************************
+	*  PreCondition: level stays loaded while rounds started from it run, or
+	*                  is NULL
+	* PostCondition: Rounds started from now on will be played from the
+	*                  level, or the built-in one if level is NULL
+	*   Description: Chooses the level. A replay only matches if it is run
+	*                  with the level it was recorded with
+	*     Algorithm: Keep the level
+	**************************************************************************/
+	simLevel = level;
+}
+
+float Sim_Alpha(const SIMULATION* world)
+{
+	/**************************************************************************
+	*  PreCondition: Sim_Bank has run this frame
+	* PostCondition: How far the clock is between the last tick and the next
+	*                  will be returned, from 0 up to (not including) 1
+	*   Description: Blend factor for drawing between the previous and the
+	*                  current tick's state
+	*     Algorithm: Divide the banked time by the tick length
+	**************************************************************************/
+	return (float)world->accumulator / SIM_TICK_US;
+}
+
+void Sim_Tick(SIMULATION* world, SIM_INPUT input)
+{
+	/**************************************************************************
+	*  PreCondition: Sim_Init has run on the world
+	* PostCondition: The world will be one tick further along
+	*   Description: Advances the world by exactly one fixed tick, on the job
+	*                  system chosen with Sim_Use_Jobs
+	*     Algorithm: Sim_Tick_Jobs() with that job system
+	**************************************************************************/
+	Sim_Tick_Jobs(world, input, simJobs);
+}
+
+void Sim_Tick_Jobs(SIMULATION* world, SIM_INPUT input, JOBSYSTEM* jobs)
+{
+	/**************************************************************************
+	*  PreCondition: Sim_Init has run on the world, jobs is running and owned
+	*                  by the calling thread, or NULL
+	* PostCondition: The world will be one tick further along
+	*   Description: Advances the world by exactly one fixed tick. Worlds
+	*                  share nothing, so different threads can each tick
+	*                  their own with no job system
+	*     Algorithm: Clear the tick's events and blasts
+	*                If the round is already decided, do nothing
+	*                Apply the player's input
+	*                If there is a job system and enough to move,
+	*                  Move everything and find the bullets' targets as a
+	*                    graph of parallel jobs
+	*                  Shoot down the planes that were hit
+	*                Otherwise,
+	*                  Move the enemy planes, letting them fire first
+	*                  Steer the seekers and move all the discharged firearms
+	*                  Check for hit enemies
+	*                Check if the player has won
+	*                Check if the player has lost
+	*                Retire the planes that went down
+	**************************************************************************/
+	PROFILE_SCOPE("Sim_Tick");
+
+	//a finished round stays frozen
+	world->events = 0;
+	world->blasts = 0;
+	if(world->status != SIM_PLAYING)
+		return;
+
+	world->tick++;
+
+	//move the player
+	Apply_Input(world, input);
+
+	if(jobs != NULL && world->entities.count + world->projectiles.count >= SIM_JOBS_MIN_ROWS)
+	{
+		//move and aim across the job system, then score in order
+		Move_And_Aim_Jobs(world, jobs);
+		Score_Hits(world);
+	}
+	else
+	{
+		//Move the enemy planes
+		Move_Enemies(world);
+
+		//move the bullets and missiles
+		Move_Weaponry(world);
+
+		//Check for enemy planes being shot down
+		Check_Scoring(world);
+	}
+
+	//Check Victory Condition
+	if(Check_Victory(world))
+		world->status = SIM_VICTORY;
+	else
+		//Check Loss Conditions
+		if(Check_Loss(world))
+		{
+			world->status = SIM_DEFEAT;
+			world->events |= SIM_EVENT_PLAYER_HIT;
+			Note_Blast(world, world->playerJet);
+		}
+
+	//close up the rows of the planes that went down
+	Retire_Planes(world);
+}
+
+unsigned long Sim_Random(SIMULATION* world)
+{
+	/**************************************************************************
+	*  PreCondition: Sim_Init has run on the world
+	* PostCondition: A pseudo-random number from 0 to 65535 will be returned
+	*   Description: The only source of randomness game logic may use, so
+	*                  recorded sessions replay the same way
+	*     Algorithm: Advance a linear congruential generator
+	*                Return its upper bits
+	**************************************************************************/
+	world->randomState = (world->randomState * 1103515245UL + 12345UL) & 0xFFFFFFFFUL;
+	return world->randomState >> 16;
+}
+
+unsigned long Sim_Hash(const SIMULATION* world)
+{
+	/**************************************************************************
+	*  PreCondition: Sim_Init has run on the world
+	* PostCondition: A 32-bit fingerprint of the world's state will be returned
+	*   Description: Replays compare this every tick to catch the first tick
+	*                  a re-simulation goes differently
+	*     Algorithm: FNV-1a over the live part of each entity column and flag
+	*                  set (serials and behaviors too, enemy fire and
+	*                  movement follow them), the live projectile slots, and
+	*                  the world's own counters (unused slots are left out to
+	*                  keep it quick, and the counters are hashed as 32-bit
+	*                  values so the result is the same on every platform)
+	**************************************************************************/
+	const ENTITYSTORE* store = &world->entities;
+	const PROJECTILEPOOL* pool = &world->projectiles;
+	size_t planes = store->count, shots = pool->count;
+	size_t flagBytes = ((store->count + 63) / 64) * sizeof(uint64_t);
+	unsigned long hash = HASH_OFFSET;
+
+	//the planes
+	hash = Hash_Bytes(hash, store->xCoordinate, planes * sizeof(int));
+	hash = Hash_Bytes(hash, store->yCoordinate, planes * sizeof(int));
+	hash = Hash_Bytes(hash, store->xSubpixel, planes * sizeof(uint16_t));
+	hash = Hash_Bytes(hash, store->ySubpixel, planes * sizeof(uint16_t));
+	hash = Hash_Bytes(hash, store->xSpeed, planes * sizeof(FIXED));
+	hash = Hash_Bytes(hash, store->ySpeed, planes * sizeof(FIXED));
+	hash = Hash_Bytes(hash, store->xAcceleration, planes * sizeof(FIXED));
+	hash = Hash_Bytes(hash, store->yAcceleration, planes * sizeof(FIXED));
+	hash = Hash_Bytes(hash, store->type, planes);
+	hash = Hash_Bytes(hash, store->behavior, planes);
+	hash = Hash_Bytes(hash, store->serial, planes * sizeof(unsigned));
+	hash = Hash_Bytes(hash, store->faceRight, flagBytes);
+	hash = Hash_Bytes(hash, store->destroyed, flagBytes);
+	hash = Hash_Bytes(hash, store->onscreen, flagBytes);
+	hash = Hash_Bytes(hash, store->active, flagBytes);
+
+	//the shots
+	hash = Hash_Value(hash, pool->count);
+	hash = Hash_Bytes(hash, pool->xCoordinate, shots * sizeof(int));
+	hash = Hash_Bytes(hash, pool->yCoordinate, shots * sizeof(int));
+	hash = Hash_Bytes(hash, pool->xSubpixel, shots * sizeof(uint16_t));
+	hash = Hash_Bytes(hash, pool->ySubpixel, shots * sizeof(uint16_t));
+	hash = Hash_Bytes(hash, pool->xSpeed, shots * sizeof(FIXED));
+	hash = Hash_Bytes(hash, pool->ySpeed, shots * sizeof(FIXED));
+	hash = Hash_Bytes(hash, pool->xAcceleration, shots * sizeof(FIXED));
+	hash = Hash_Bytes(hash, pool->yAcceleration, shots * sizeof(FIXED));
+	hash = Hash_Bytes(hash, pool->type, shots);
+	hash = Hash_Bytes(hash, pool->heading, shots * sizeof(int));
+	hash = Hash_Bytes(hash, pool->fuel, shots * sizeof(int));
+
+	//the world
+	hash = Hash_Value(hash, world->fireCooldown);
+	hash = Hash_Value(hash, world->tick);
+	hash = Hash_Value(hash, world->randomState);
+	hash = Hash_Value(hash, world->status);
+	hash = Hash_Value(hash, world->wave);
+	hash = Hash_Value(hash, world->schedule.count);
+	hash = Hash_Value(hash, world->kills);
+
+	return hash;
+}
+
+static unsigned long Hash_Bytes(unsigned long hash, const void* data, size_t length)
+{
+	/**************************************************************************
+	*  PreCondition: data points to at least length bytes
+	* PostCondition: The hash will be extended by the bytes
+	*   Description: FNV-1a step
+	*     Algorithm: For each byte, mix it in and multiply by the FNV prime
+	**************************************************************************/
+	const unsigned char* bytes = (const unsigned char*)data;
+	size_t index;
+
+	for(index = 0; index < length; index++)
+		hash = ((hash ^ bytes[index]) * HASH_PRIME) & 0xFFFFFFFFUL;
+
+	return hash;
+}
+
+static unsigned long Hash_Value(unsigned long hash, unsigned long value)
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: The hash will be extended by the value's low 32 bits
+	*   Description: Hashes a counter the same way whatever size a long is
+	*     Algorithm: Hash_Bytes() its four bytes, lowest first
+	**************************************************************************/
+	unsigned char bytes[4];
+
+	bytes[0] = (unsigned char)value;
+	bytes[1] = (unsigned char)(value >> 8);
+	bytes[2] = (unsigned char)(value >> 16);
+	bytes[3] = (unsigned char)(value >> 24);
+
+	return Hash_Bytes(hash, bytes, sizeof(bytes));
+}
+
+void Sim_Save(const SIMULATION* world, SIMSNAPSHOT* snapshot)
+{
+	/**************************************************************************
+	*  PreCondition: Sim_Init has run on the world
+	* PostCondition: The snapshot will hold everything needed to put the
+	*                  world back as it is now
+	*   Description: Saves a world for rolling back to, at a cost that grows
+	*                  with what is in play rather than with the world's
+	*                  capacity
+	*     Algorithm: Pack_World() into the snapshot's data
+	**************************************************************************/
+	PROFILE_SCOPE("Sim_Save");
+
+	//(packing in only reads the world)
+	snapshot->size = Pack_World((SIMULATION*)world, snapshot->data, true);
+}
+
+void Sim_Restore(SIMULATION* world, const SIMSNAPSHOT* snapshot)
+{
+	/**************************************************************************
+	*  PreCondition: Sim_Save has filled the snapshot
+	* PostCondition: The world will play on exactly as the saved one would
+	*                  have, whatever it held before
+	*   Description: Rolls a world back to a snapshot
+	*     Algorithm: Unpack the world from the snapshot's data
+	*                Clear the flag words past the live rows, which new
+	*                  planes expect to find empty
+	*                Point each live shot's handle back at its slot
+	**************************************************************************/
+	PROFILE_SCOPE("Sim_Restore");
+	ENTITYSTORE* store = &world->entities;
+	PROJECTILEPOOL* pool = &world->projectiles;
+	int word, slot;
+
+	//(unpacking only reads the data)
+	Pack_World(world, (unsigned char*)snapshot->data, false);
+
+	//the rows past the live ones hold nothing
+	for(word = (store->count + 63) / 64; word < ENTITY_FLAG_WORDS; word++)
+	{
+		store->faceRight[word] = 0;
+		store->destroyed[word] = 0;
+		store->onscreen[word] = 0;
+		store->active[word] = 0;
+	}
+
+	//the handle table follows from the slots
+	for(slot = 0; slot < pool->count; slot++)
+		pool->slot[pool->handle[slot]] = slot;
+}
+
+static size_t Pack_World(SIMULATION* world, unsigned char* data, bool save)
+{
+	/**************************************************************************
+	*  PreCondition: data has room for sizeof(SIMULATION) bytes
+	* PostCondition: The live part of the world will have been copied into
+	*                  data if save is true, or out of it if not. The number
+	*                  of bytes copied is returned
+	*   Description: The one list of what a snapshot holds, walked the same
+	*                  way in both directions so saving and restoring can't
+	*                  drift apart
+	*     Algorithm: Copy the world's counters, the store's and the pool's
+	*                  (each count comes before what it measures, so it is
+	*                  in place by the time it is needed), and the tick's
+	*                  blasts
+	*                Copy the live part of each entity column and flag set
+	*                Copy the live part of each projectile column, the live
+	*                  handles and the free ones
+	*                Copy the spawns still to come
+	**************************************************************************/
+	ENTITYSTORE* store = &world->entities;
+	PROJECTILEPOOL* pool = &world->projectiles;
+	SPAWNSCHEDULE* schedule = &world->schedule;
+	unsigned char* cursor = data;
+	size_t planes, shots, flagBytes;
+
+	//the world
+	Pack_Bytes(&cursor, &world->playerJet, sizeof(world->playerJet), save);
+	Pack_Bytes(&cursor, &world->fireCooldown, sizeof(world->fireCooldown), save);
+	Pack_Bytes(&cursor, &world->accumulator, sizeof(world->accumulator), save);
+	Pack_Bytes(&cursor, &world->tick, sizeof(world->tick), save);
+	Pack_Bytes(&cursor, &world->seed, sizeof(world->seed), save);
+	Pack_Bytes(&cursor, &world->randomState, sizeof(world->randomState), save);
+	Pack_Bytes(&cursor, &world->status, sizeof(world->status), save);
+	Pack_Bytes(&cursor, &world->level, sizeof(world->level), save);
+	Pack_Bytes(&cursor, &world->wave, sizeof(world->wave), save);
+	Pack_Bytes(&cursor, &world->kills, sizeof(world->kills), save);
+	Pack_Bytes(&cursor, &world->events, sizeof(world->events), save);
+	Pack_Bytes(&cursor, &world->blasts, sizeof(world->blasts), save);
+	Pack_Bytes(&cursor, world->blastX, world->blasts * sizeof(world->blastX[0]), save);
+	Pack_Bytes(&cursor, world->blastY, world->blasts * sizeof(world->blastY[0]), save);
+	Pack_Bytes(&cursor, &store->count, sizeof(store->count), save);
+	Pack_Bytes(&cursor, &store->nextSerial, sizeof(store->nextSerial), save);
+	Pack_Bytes(&cursor, store->batchEnd, sizeof(store->batchEnd), save);
+	Pack_Bytes(&cursor, &pool->count, sizeof(pool->count), save);
+	Pack_Bytes(&cursor, &pool->freeCount, sizeof(pool->freeCount), save);
+	Pack_Bytes(&cursor, &schedule->count, sizeof(schedule->count), save);
+	planes = store->count;
+	shots = pool->count;
+	flagBytes = ((store->count + 63) / 64) * sizeof(uint64_t);
+
+	//the planes
+	Pack_Bytes(&cursor, store->xCoordinate, planes * sizeof(int), save);
+	Pack_Bytes(&cursor, store->yCoordinate, planes * sizeof(int), save);
+	Pack_Bytes(&cursor, store->xSubpixel, planes * sizeof(uint16_t), save);
+	Pack_Bytes(&cursor, store->ySubpixel, planes * sizeof(uint16_t), save);
+	Pack_Bytes(&cursor, store->xSpeed, planes * sizeof(FIXED), save);
+	Pack_Bytes(&cursor, store->ySpeed, planes * sizeof(FIXED), save);
+	Pack_Bytes(&cursor, store->xAcceleration, planes * sizeof(FIXED), save);
+	Pack_Bytes(&cursor, store->yAcceleration, planes * sizeof(FIXED), save);
+	Pack_Bytes(&cursor, store->width, planes * sizeof(int), save);
+	Pack_Bytes(&cursor, store->height, planes * sizeof(int), save);
+	Pack_Bytes(&cursor, store->type, planes, save);
+	Pack_Bytes(&cursor, store->behavior, planes, save);
+	Pack_Bytes(&cursor, store->serial, planes * sizeof(unsigned), save);
+	Pack_Bytes(&cursor, store->faceRight, flagBytes, save);
+	Pack_Bytes(&cursor, store->destroyed, flagBytes, save);
+	Pack_Bytes(&cursor, store->onscreen, flagBytes, save);
+	Pack_Bytes(&cursor, store->active, flagBytes, save);
+
+	//the shots
+	Pack_Bytes(&cursor, pool->xCoordinate, shots * sizeof(int), save);
+	Pack_Bytes(&cursor, pool->yCoordinate, shots * sizeof(int), save);
+	Pack_Bytes(&cursor, pool->xSubpixel, shots * sizeof(uint16_t), save);
+	Pack_Bytes(&cursor, pool->ySubpixel, shots * sizeof(uint16_t), save);
+	Pack_Bytes(&cursor, pool->xSpeed, shots * sizeof(FIXED), save);
+	Pack_Bytes(&cursor, pool->ySpeed, shots * sizeof(FIXED), save);
+	Pack_Bytes(&cursor, pool->xAcceleration, shots * sizeof(FIXED), save);
+	Pack_Bytes(&cursor, pool->yAcceleration, shots * sizeof(FIXED), save);
+	Pack_Bytes(&cursor, pool->width, shots * sizeof(int), save);
+	Pack_Bytes(&cursor, pool->height, shots * sizeof(int), save);
+	Pack_Bytes(&cursor, pool->type, shots, save);
+	Pack_Bytes(&cursor, pool->faceRight, shots, save);
+	Pack_Bytes(&cursor, pool->heading, shots * sizeof(int), save);
+	Pack_Bytes(&cursor, pool->fuel, shots * sizeof(int), save);
+	Pack_Bytes(&cursor, pool->handle, shots * sizeof(int), save);
+	Pack_Bytes(&cursor, pool->freeHandles, pool->freeCount * sizeof(int), save);
+
+	//the planes still to come
+	Pack_Bytes(&cursor, schedule->events, schedule->count * sizeof(SPAWNEVENT), save);
+
+	return cursor - data;
+}
+
+static void Pack_Bytes(unsigned char** cursor, void* field, size_t length, bool save)
+{
+	/**************************************************************************
+	*  PreCondition: field and *cursor each point to at least length bytes
+	* PostCondition: The bytes will have been copied from the field to the
+	*                  cursor if save is true, the other way if not, and the
+	*                  cursor moved past them
+	*   Description: One step of Pack_World()
+	*     Algorithm: memcpy() in the direction asked for
+	*                Advance the cursor
+	**************************************************************************/
+	if(save)
+		memcpy(*cursor, field, length);
+	else
+		memcpy(field, *cursor, length);
+	*cursor += length;
+}
+
+void Apply_Input(SIMULATION* world, SIM_INPUT input)
+{
+	/**************************************************************************
+	*  PreCondition: The game loop is running
+	* PostCondition: The player's jet will respond to the controls held
+	*   Description: This function handles all actions associated with the controls
+	*     Algorithm: If Left is held,
+	*                  face the jet left and move left, though not offscreen
+	*                Else If Right is held,
+	*                  face the jet right and move right, though not offscreen
+	*                If Up is held,
+	*                  move the jet up, though not offscreen
+	*                Else If Down is held,
+	*                  move the jet down, though not offscreen
+	*                If Fire is held and the gun has cooled down,
+	*                  Fire a bullet from the front of the jet
+	**************************************************************************/
+	PROFILE_SCOPE("Apply_Input");
+	ENTITYSTORE* store = &world->entities;
+	int player = world->playerJet;
+
+	//check for left
+	if(input & INPUT_LEFT)
+	{
+		//Check if the player is trying to go offscreen
+		if(store->xCoordinate[player] > 0)
+			Fixed_Advance(&store->xCoordinate[player], &store->xSubpixel[player], -store->xSpeed[player]); //Move left
+		//Face the player left
+		Entity_Set_Flag(store->faceRight, player, false);
+	}
+	//check for right
+	else
+		if(input & INPUT_RIGHT)
+		{
+			//Check if player is trying to go offscreen
+			if(store->xCoordinate[player] + store->width[player] < PLAYFIELD_WIDTH)
+				Fixed_Advance(&store->xCoordinate[player], &store->xSubpixel[player], store->xSpeed[player]); //Move right
+			//Face the player right
+			Entity_Set_Flag(store->faceRight, player, true);
+		}
+
+	//check for up
+	if(input & INPUT_UP)
+	{
+		//Check if the player is trying to go offscreen
+		if(store->yCoordinate[player] > 0)
+			Fixed_Advance(&store->yCoordinate[player], &store->ySubpixel[player], -store->ySpeed[player]); //Move up
+	}
+	//check for down
+	else
+	{
+		if(input & INPUT_DOWN)
+			//Check if the player is trying to go offscreen
+			if(store->yCoordinate[player] + store->height[player] < PLAYFIELD_HEIGHT)
+				Fixed_Advance(&store->yCoordinate[player], &store->ySubpixel[player], store->ySpeed[player]); //Move down
+	}
+
+	//the gun cools down between shots
+	if(world->fireCooldown > 0)
+		world->fireCooldown--;
+
+	//check for fire
+	if((input & INPUT_FIRE) && world->fireCooldown == 0)
+	{
+		//Fire the bullet from the jet front and center
+		int bulletY = store->yCoordinate[player] + store->height[player] / 2;
+
+		if(Entity_Flag(store->faceRight, player))
+			Fire_Projectile(world, ENTITY_PLAYER_BULLET,
+				store->xCoordinate[player] + store->width[player] + 5, bulletY, true);
+		else
+			Fire_Projectile(world, ENTITY_PLAYER_BULLET, store->xCoordinate[player] - 5, bulletY, false);
+
+		world->fireCooldown = PLAYER_FIRE_COOLDOWN;
+	}
+}
+
+int Fire_Projectile(SIMULATION* world, ENTITY_TYPE type, int x, int y, bool faceRight)
+{
+	/**************************************************************************
+	*  PreCondition: type is a kind of projectile
+	* PostCondition: A new shot will be in flight, its handle returned, or
+	*                  NO_ENTITY if too many shots are already flying
+	*   Description: Launches a shot from the given point
+	*     Algorithm: Start from the shot's template
+	*                Place it and face it
+	*                If it is facing left, send it and speed it up left
+	*                Raise the event for its kind of shot
+	*                Add it to the projectile pool
+	**************************************************************************/
+	SPRITE shot = projectileTemplates[type];
+
+	shot.xCoordinate = x;
+	shot.yCoordinate = y;
+	shot.faceRight = faceRight;
+	if(!faceRight)
+	{
+		shot.xSpeed = -shot.xSpeed;
+		shot.xAcceleration = -shot.xAcceleration;
+	}
+
+	if(type == ENTITY_PLAYER_BULLET)
+		world->events |= SIM_EVENT_PLAYER_SHOT;
+	else if(type == ENTITY_ENEMY_BULLET)
+		world->events |= SIM_EVENT_ENEMY_SHOT;
+	else
+		world->events |= SIM_EVENT_MISSILE;
+
+	return Pool_Spawn(&world->projectiles, type, &shot);
+}
+
+void Set_Sprites_Properties(SIMULATION* world)
+{
+	/**************************************************************************
+	*  PreCondition: The world's level has been chosen
+	* PostCondition: The default properties of the game sprites will be set
+	*   Description: This function fills the entity store with the starting
+	*                  cast from the level. Enemies are added in the order
+	*                  they attack
+	*     Algorithm: Empty the store, the projectile pool and the schedule
+	*                Spawn the Player's jet where the level starts it, first
+	*                  into the empty store and in the behavior none batch, so
+	*                  no plane added or retired later moves it off row 0
+	*                Start from the first wave (it is sent in on the first
+	*                  tick)
+	*                The player's jet is always active and ready to fire
+	**************************************************************************/
+	const LEVELHEADER* header = world->level->header;
+	ENTITYSTORE* store = &world->entities;
+
+	//start with an empty world
+	Entity_Clear(store);
+	Pool_Clear(&world->projectiles);
+	Schedule_Clear(&world->schedule);
+
+	//add the starting cast
+	world->playerJet = Spawn_Plane(world, &world->level->spawns[header->playerSpawn]);
+	world->wave = 0;
+
+	//the player is always in play
+	Entity_Set_Flag(store->active, world->playerJet, true);
+	world->fireCooldown = 0;
+}
+
+int Spawn_Plane(SIMULATION* world, const LEVELSPAWN* spawn)
+{
+	/**************************************************************************
+	*  PreCondition: spawn is from the world's level
+	* PostCondition: The plane will be added to the entity store, its index
+	*                  returned, or NO_ENTITY if the store is full or the
+	*                  spawn names an archetype or type that doesn't exist
+	*   Description: Creates a plane from its archetype, placed by the spawn
+	*     Algorithm: Check the spawn's archetype and its type
+	*                Build the plane from the archetype at the spawn's place,
+	*                  counting it onscreen only if it starts wholly inside
+	*                  the playfield (the player's jet never flies a behavior,
+	*                  whatever its archetype says)
+	*                Add it to the store
+	**************************************************************************/
+	const ARCHETYPE* archetype;
+	SPRITE plane;
+
+	//records are only checked as they are used
+	if(spawn->archetype >= world->level->header->archetypeCount)
+		return NO_ENTITY;
+	archetype = &world->level->archetypes[spawn->archetype];
+	if(archetype->type >= ENTITY_TYPE_COUNT || (entityTypeFlags[archetype->type] & TYPE_PROJECTILE))
+		return NO_ENTITY;
+
+	plane.xCoordinate = spawn->xCoordinate;
+	plane.yCoordinate = spawn->yCoordinate;
+	plane.xSpeed = archetype->xSpeed;
+	plane.ySpeed = archetype->ySpeed;
+	plane.xAcceleration = archetype->xAcceleration;
+	plane.yAcceleration = archetype->yAcceleration;
+	plane.width = archetype->width;
+	plane.height = archetype->height;
+	plane.faceRight = archetype->faceRight != 0;
+	plane.destroyed = false;
+	plane.behavior = spawn == &world->level->spawns[world->level->header->playerSpawn] ?
+		(unsigned char)BEHAVIOR_NONE : archetype->behavior;
+	plane.onscreen = plane.xCoordinate > 0 && plane.xCoordinate + plane.width < PLAYFIELD_WIDTH &&
+		plane.yCoordinate > 0 && plane.yCoordinate + plane.height < PLAYFIELD_HEIGHT;
+
+	return Entity_Create(&world->entities, (ENTITY_TYPE)archetype->type, &plane);
+}
+
+bool Send_In_Wave(SIMULATION* world)
+{
+	/**************************************************************************
+	*  PreCondition: Sim_Init has run on the world
+	* PostCondition: The next wave's planes will be on the schedule, returns
+	*                  false if the level has no more waves
+	*   Description: Starts the next wave. Each of its planes spawns its own
+	*                  delay after the wave starts
+	*     Algorithm: Stop if every wave has been sent in
+	*                Schedule each of the wave's spawns for the current tick
+	*                  plus its delay
+	**************************************************************************/
+	const LEVELHEADER* header = world->level->header;
+	const LEVELWAVE* wave;
+	uint32_t spawn;
+
+	if(world->wave < 0 || (uint32_t)world->wave >= header->waveCount)
+		return false;
+	wave = &world->level->waves[world->wave++];
+
+	//wave records are only checked as they are used
+	for(spawn = wave->firstSpawn; spawn < header->spawnCount && spawn - wave->firstSpawn < wave->spawnCount; spawn++)
+		Schedule_Push(&world->schedule, world->tick + world->level->spawns[spawn].delay, spawn);
+
+	return true;
+}
+
+void Run_Schedule(SIMULATION* world)
+{
+	/**************************************************************************
+	*  PreCondition: The tick has started
+	* PostCondition: Every plane due by this tick will be flying
+	*   Description: The wave scheduler. Any number of planes can be in the
+	*                  air at once, each flying its own behavior
+	*     Algorithm: If the last wave is over (nothing left to spawn and
+	*                  every enemy down), Send In the next Wave()
+	*                While a spawn is due,
+	*                  Take it off the schedule
+	*                  Spawn_Plane() it and send it in straight away
+	**************************************************************************/
+	PROFILE_SCOPE("Run_Schedule");
+	SPAWNEVENT event;
+	int plane;
+
+	//start the next wave once this one is over
+	if(world->schedule.count == 0 && !Enemies_Remain(world))
+		Send_In_Wave(world);
+
+	//bring on everything that is due
+	while(Schedule_Due(&world->schedule, world->tick))
+	{
+		event = Schedule_Pop(&world->schedule);
+		plane = Spawn_Plane(world, &world->level->spawns[event.spawn]);
+		if(plane != NO_ENTITY)
+			Entity_Set_Flag(world->entities.active, plane, true);
+	}
+}
+
+bool Enemies_Remain(const SIMULATION* world)
+{
+	/**************************************************************************
+	*  PreCondition: Sim_Init has run on the world
+	* PostCondition: Returns whether any enemy plane is still flying
+	*   Description: Checks whether the current wave has been cleared
+	*     Algorithm: For each plane,
+	*                  If it is an enemy and still flying, one remains
+	**************************************************************************/
+	const ENTITYSTORE* store = &world->entities;
+	int index;
+
+	for(index = 0; index < store->count; index++)
+		if((entityTypeFlags[store->type[index]] & TYPE_ENEMY) && !Entity_Flag(store->destroyed, index))
+			return true;
+
+	return false;
+}
+
+void Retire_Planes(SIMULATION* world)
+{
+	/**************************************************************************
+	*  PreCondition: The tick's passes have all run
+	* PostCondition: The planes shot down will be gone from the store
+	*   Description: Keeps every later pass linear in the planes still flying
+	*     Algorithm: Retire the destroyed planes after the player's jet (it
+	*                  keeps its row, and its loss ends the round anyway)
+	**************************************************************************/
+	PROFILE_SCOPE("Retire_Planes");
+
+	Entity_Retire(&world->entities, world->playerJet + 1);
+}
+
+int Check_Collision(const SIMULATION* world, int entity1, int entity2)
+{
+	/**************************************************************************
+	*  PreCondition: The entities have been initialized
+	* PostCondition: It will be determined if two entities are colliding
+	*   Description: This function determines if two entities are colliding
+	*     Algorithm: Run the branch-free box test on their columns
+	*                  (same result as IntersectRect)
+	*                If the boxes touch, check their masks share a pixel
+	**************************************************************************/
+	const ENTITYSTORE* store = &world->entities;
+	COLLISIONMASK mask1, mask2;
+
+	if(!AABB_Overlap(store->xCoordinate[entity1], store->yCoordinate[entity1],
+		store->width[entity1], store->height[entity1],
+		store->xCoordinate[entity2], store->yCoordinate[entity2],
+		store->width[entity2], store->height[entity2]))
+		return false;
+
+	Entity_Mask(world, entity1, &mask1);
+	Entity_Mask(world, entity2, &mask2);
+	return Mask_Overlap(store->xCoordinate[entity1], store->yCoordinate[entity1],
+		store->width[entity1], store->height[entity1], &mask1,
+		store->xCoordinate[entity2], store->yCoordinate[entity2],
+		store->width[entity2], store->height[entity2], &mask2);
+}
+
+void Entity_Mask(const SIMULATION* world, int entity, COLLISIONMASK* mask)
+{
+	/**************************************************************************
+	*  PreCondition: entity is a row of the store
+	* PostCondition: mask will hold the pixels the entity can be hit in
+	*   Description: Looks up an entity's collision mask
+	*     Algorithm: Level_Mask() for its type, turned the way it faces
+	**************************************************************************/
+	const ENTITYSTORE* store = &world->entities;
+
+	Level_Mask(world->level, store->type[entity], Entity_Flag(store->faceRight, entity), mask);
+}
+
+int Find_Contact(const SIMULATION* world, int entity, unsigned char typeFilter)
+{
+	/**************************************************************************
+	*  PreCondition: Everything has moved for this tick
+	* PostCondition: The lowest numbered plane still flying that touches the
+	*                  given entity and matches the type filter will be
+	*                  returned, or NO_ENTITY
+	*   Description: Looks up an entity's contacts in the entity store
+	*     Algorithm: Find_Box_Contact() with the entity's box and mask
+	**************************************************************************/
+	const ENTITYSTORE* store = &world->entities;
+	COLLISIONMASK mask;
+
+	Entity_Mask(world, entity, &mask);
+	return Find_Box_Contact(world, store->xCoordinate[entity], store->yCoordinate[entity],
+		store->width[entity], store->height[entity], &mask, typeFilter);
+}
+
+int Find_Box_Contact(const SIMULATION* world, int x, int y, int width, int height,
+					 const COLLISIONMASK* mask, unsigned char typeFilter)
+{
+	/**************************************************************************
+	*  PreCondition: Everything has moved for this tick, mask is the box's
+	*                  (or NULL for a solid box)
+	* PostCondition: The lowest numbered plane still flying that touches the
+	*                  box and matches the type filter will be returned, or
+	*                  NO_ENTITY
+	*   Description: Tests one box against the whole entity store in a single
+	*                  batched kernel call, then checks the pixels of only
+	*                  the boxes it touched
+	*     Algorithm: Box test the box against every entity's columns
+	*                And the hits with the matching entities in play
+	*                Return the first one left whose mask it touches
+	**************************************************************************/
+	const ENTITYSTORE* store = &world->entities;
+	uint64_t hits[ENTITY_FLAG_WORDS], candidates[ENTITY_FLAG_WORDS];
+	COLLISIONMASK other;
+	int word;
+
+	//Test against everything at once
+	Collision_One_Vs_Many(x, y, width, height, store->xCoordinate, store->yCoordinate,
+		store->width, store->height, store->count, hits);
+
+	//keep the matching ones in play
+	Entity_In_Play(store, typeFilter, candidates);
+
+	//then look closer
+	for(word = 0; word < HIT_WORDS(store->count); word++)
+	{
+		uint64_t bits = hits[word] & candidates[word];
+		int entity = word * 64;
+
+		for(; bits; bits >>= 1, entity++)
+			if(bits & 1)
+			{
+				Entity_Mask(world, entity, &other);
+				if(Mask_Overlap(x, y, width, height, mask, store->xCoordinate[entity],
+					store->yCoordinate[entity], store->width[entity], store->height[entity], &other))
+					return entity;
+			}
+	}
+
+	return NO_ENTITY;
+}
+
+int Find_Swept_Contact(const SIMULATION* world, FIXED x, FIXED y, int width, int height,
+					   const COLLISIONMASK* mask, FIXED xMove, FIXED yMove, unsigned char typeFilter)
+{
+	/**************************************************************************
+	*  PreCondition: Everything has moved for this tick, the box (cut to its
+	*                  mask, NULL for solid) ended it at x, y in fixed point
+	*                  after moving xMove, yMove
+	* PostCondition: The plane still flying and matching the type filter that
+	*                  the moving box reached first will be returned (the
+	*                  lowest numbered on a tie), or NO_ENTITY
+	*   Description: Find_Box_Contact() for a box too fast to test only where
+	*                  it stopped. The planes are taken to have stood where
+	*                  they ended the tick
+	*     Algorithm: Box test the box around the whole path against every
+	*                  entity's columns in one kernel call
+	*                And the hits with the matching entities in play
+	*                Sweep the masks against each one left, keeping the
+	*                  earliest impact, until one is hit at the very start
+	**************************************************************************/
+	const ENTITYSTORE* store = &world->entities;
+	uint64_t hits[ENTITY_FLAG_WORDS], candidates[ENTITY_FLAG_WORDS];
+	COLLISIONMASK other;
+	int pathX, pathY, pathWidth = width, pathHeight = height;
+	int word, found = NO_ENTITY;
+	FIXED first = FIXED_ONE, impact;
+
+	//Test the path against everything at once
+	AABB_Swept_Bounds(x, y, xMove, yMove, &pathX, &pathY, &pathWidth, &pathHeight);
+	Collision_One_Vs_Many(pathX, pathY, pathWidth, pathHeight, store->xCoordinate,
+		store->yCoordinate, store->width, store->height, store->count, hits);
+
+	//keep the matching ones in play
+	Entity_In_Play(store, typeFilter, candidates);
+
+	//then find which was reached first, nothing beats one touched at once
+	for(word = 0; word < HIT_WORDS(store->count) && first > 0; word++)
+	{
+		uint64_t bits = hits[word] & candidates[word];
+		int entity = word * 64;
+
+		for(; bits && first > 0; bits >>= 1, entity++)
+		{
+			if(!(bits & 1))
+				continue;
+			Entity_Mask(world, entity, &other);
+			if(Mask_Sweep(x, y, width, height, mask, xMove, yMove, store->xCoordinate[entity],
+				store->yCoordinate[entity], store->width[entity], store->height[entity], &other,
+				&impact) && (found == NO_ENTITY || impact < first))
+			{
+				found = entity;
+				first = impact;
+			}
+		}
+	}
+
+	return found;
+}
+
+bool Check_Victory(SIMULATION* world)
+{
+	/**************************************************************************
+	*  PreCondition: The game loop is running
+	* PostCondition: It will be determined if the skies have been cleared
+	*   Description: This function checks whether any enemy plane remains
+	*     Algorithm: If the level has waves or planes still to come, the
+	*                  player has not won yet
+	*                If any enemy plane Remains(), the player has not won yet
+	**************************************************************************/
+	PROFILE_SCOPE("Check_Victory");
+
+	if((uint32_t)world->wave < world->level->header->waveCount || world->schedule.count > 0)
+		return false;
+
+	//every enemy is down
+	return !Enemies_Remain(world);
+}
+
+bool Check_Loss(SIMULATION* world)
+{
+	/**************************************************************************
+	*  PreCondition: Everything has moved for this tick
+	* PostCondition: It will be determined if the player has been destroyed
+	*   Description: This function checks collision of the player against all
+	*                  possible enemy sprites
+	*     Algorithm: Find the first hazardous shot to reach the player
+	*                If there is one, retire it and destroy the player
+	*                Find the first hazardous plane touching the player
+	*                If there is one, destroy it along with the player
+	*                Otherwise, player has not lost
+	**************************************************************************/
+	PROFILE_SCOPE("Check_Loss");
+	ENTITYSTORE* store = &world->entities;
+	int player = world->playerJet;
+	COLLISIONMASK mask;
+	int threat;
+
+	//Check collision against enemy bullets and missiles
+	Entity_Mask(world, player, &mask);
+	threat = Pool_Find_Contact(&world->projectiles, world->level, store->xCoordinate[player],
+		store->yCoordinate[player], store->width[player], store->height[player], &mask,
+		TYPE_HAZARD);
+	if(threat != NO_ENTITY)
+	{
+		Entity_Set_Flag(store->destroyed, player, true);
+		Pool_Despawn_Slot(&world->projectiles, threat);
+		return true;
+	}
+
+	//check if the player rammed a plane
+	threat = Find_Contact(world, player, TYPE_HAZARD);
+	if(threat != NO_ENTITY)
+	{
+		Entity_Set_Flag(store->destroyed, player, true);
+		Destroy_Enemy(store, threat);
+		return true;
+	}
+
+	//Player is OK
+	return false;
+}
+
+void Destroy_Enemy(ENTITYSTORE* store, int index)
+{
+	/**************************************************************************
+	*  PreCondition: The index refers to an enemy plane
+	* PostCondition: The plane will be out of the fight
+	*   Description: Marks a plane as shot down and moves it off the playfield
+	*                  so it can't be hit again
+	*     Algorithm: Mark it destroyed and no longer active
+	*                Park it left of the playfield
+	**************************************************************************/
+	Entity_Set_Flag(store->destroyed, index, true);
+	Entity_Set_Flag(store->active, index, false);
+	store->xCoordinate[index] = -500;
+}
+
+void Move_Enemies(SIMULATION* world)
+{
+	/**************************************************************************
+	*  PreCondition: The enemy sprites have been allocated properly
+	* PostCondition: The enemy sprites will be moved
+	*   Description: This function keeps the enemy planes moving onscreen.
+	*                  Planes join the attack as the schedule brings them on
+	*     Algorithm: Run_Schedule() to send in the planes due
+	*                Fire_Enemy_Weapons() from where they are
+	*                Move_Planes() for the whole store, chasing the middle of
+	*                  the player's jet
+	**************************************************************************/
+	PROFILE_SCOPE("Move_Enemies");
+	int targetX, targetY;
+
+	//send in the planes that are due
+	Run_Schedule(world);
+
+	//let them shoot
+	Fire_Enemy_Weapons(world);
+
+	//move them all
+	Player_Middle(world, &targetX, &targetY);
+	Move_Planes(world, 0, world->entities.count, targetX, targetY);
+}
+
+void Move_Planes(SIMULATION* world, int begin, int end, int targetX, int targetY)
+{
+	/**************************************************************************
+	*  PreCondition: The schedule has been run this tick. Ranges moved at
+	*                  the same time start at multiples of 64
+	* PostCondition: Attacking planes from begin to end - 1 will have moved
+	*   Description: Movement for one run of the entity store
+	*     Algorithm: Aim homing planes at the target
+	*                Move every attacking plane the way its behavior flies,
+	*                  keeping the bouncing ones on the playfield
+	**************************************************************************/
+	ENTITYFIELD field;
+
+	//the playfield, and what homing planes chase
+	field.width = PLAYFIELD_WIDTH;
+	field.height = PLAYFIELD_HEIGHT;
+	field.targetX = targetX;
+	field.targetY = targetY;
+
+	//move the enemy planes
+	Entity_Move(&world->entities, &field, begin, end);
+}
+
+void Fire_Enemy_Weapons(SIMULATION* world)
+{
+	/**************************************************************************
+	*  PreCondition: The schedule has been run this tick
+	* PostCondition: Every enemy plane whose gun is due will have fired
+	*   Description: The enemies' side of the fight. Each kind of plane
+	*                  fires its own weapon on its own reload, and planes are
+	*                  staggered by their serials so a wave doesn't fire in
+	*                  one volley
+	*     Algorithm: For each plane,
+	*                  Skip it if it has no gun, isn't attacking, has been
+	*                    shot down or isn't entirely on the playfield
+	*                  Skip it if its reload isn't up this tick
+	*                  Fire from whichever side faces the player's jet, the
+	*                    shot leaving level with the plane's middle
+	**************************************************************************/
+	PROFILE_SCOPE("Fire_Enemy_Weapons");
+	const ENTITYSTORE* store = &world->entities;
+	int index, targetX, targetY;
+
+	Player_Middle(world, &targetX, &targetY);
+
+	for(index = 0; index < store->count; index++)
+	{
+		const WEAPON* weapon = &enemyWeapons[store->type[index]];
+		const SPRITE* shot;
+		int left = store->xCoordinate[index], top = store->yCoordinate[index];
+		int right = left + store->width[index], bottom = top + store->height[index];
+		bool towardRight;
+
+		//only planes in the fight, with a gun that is ready
+		if(weapon->reload == 0 || !Entity_Flag(store->active, index) || Entity_Flag(store->destroyed, index))
+			continue;
+		if(left < 0 || right > PLAYFIELD_WIDTH || top < 0 || bottom > PLAYFIELD_HEIGHT)
+			continue;
+		if((world->tick + store->serial[index] * 7) % weapon->reload != 0)
+			continue;
+
+		//fire at the player
+		shot = &projectileTemplates[weapon->projectile];
+		towardRight = targetX > left + store->width[index] / 2;
+		Fire_Projectile(world, (ENTITY_TYPE)weapon->projectile,
+			towardRight ? right + 5 : left - shot->width - 5,
+			top + store->height[index] / 2 - shot->height / 2, towardRight);
+	}
+}
+
+void Player_Middle(const SIMULATION* world, int* x, int* y)
+{
+	/**************************************************************************
+	*  PreCondition: Sim_Init has run on the world
+	* PostCondition: x and y will hold the middle of the player's jet
+	*   Description: The point enemies aim and steer at
+	*     Algorithm: Add half the jet's size to its corner
+	**************************************************************************/
+	const ENTITYSTORE* store = &world->entities;
+	int player = world->playerJet;
+
+	*x = store->xCoordinate[player] + store->width[player] / 2;
+	*y = store->yCoordinate[player] + store->height[player] / 2;
+}
+
+void Move_Weaponry(SIMULATION* world)
+{
+	/**************************************************************************
+	*  PreCondition: The sprites have been set up correctly
+	* PostCondition: The weaponry sprites will be updated
+	*   Description: This function moves and updates all the weapon sprites
+	*     Algorithm: Steer every seeker with fuel left at the player's jet
+	*                Move every projectile in flight by its speed
+	*                If a projectile goes off the screen, make note the shot
+	*                  is finished
+	**************************************************************************/
+	PROFILE_SCOPE("Move_Weaponry");
+	int targetX, targetY;
+
+	//home the seekers in on the player
+	Player_Middle(world, &targetX, &targetY);
+	Pool_Steer(&world->projectiles, targetX, targetY, 0, world->projectiles.count);
+
+	//move the bullets and missiles
+	Pool_Move(&world->projectiles, 0, world->projectiles.count);
+
+	//retire the ones that left the playfield
+	Pool_Cull(&world->projectiles, PLAYFIELD_WIDTH, PLAYFIELD_HEIGHT);
+}
+
+void Check_Scoring(SIMULATION* world)
+{
+	/**************************************************************************
+	*  PreCondition: Everything has moved for this tick
+	* PostCondition: Enemies hit by the player's bullets will be shot down
+	*   Description: This function checks if the player has hit an enemy with a
+	*                  bullet. Each bullet brings down at most one plane and is
+	*                  spent when it does
+	*     Algorithm: Aim_Shots() for every shot in flight
+	*                Score_Hits()
+	**************************************************************************/
+	PROFILE_SCOPE("Check_Scoring");
+
+	Aim_Shots(world, 0, world->projectiles.count);
+	Score_Hits(world);
+}
+
+void Aim_Shots(SIMULATION* world, int begin, int end)
+{
+	/**************************************************************************
+	*  PreCondition: Everything has moved and been culled for this tick
+	* PostCondition: Each of the player's bullets from begin to end - 1 (end
+	*                  is cut down to the shots in flight) will have the first
+	*                  plane still flying that it reached this tick noted
+	*   Description: The costly half of scoring. It only reads the world, so
+	*                  runs of shots can be aimed at the same time
+	*     Algorithm: For each shot,
+	*                  Note NO_ENTITY if it isn't the player's
+	*                  Otherwise note the first enemy plane on its path
+	**************************************************************************/
+	const PROJECTILEPOOL* pool = &world->projectiles;
+	COLLISIONMASK mask;
+	int slot;
+
+	if(end > pool->count)
+		end = pool->count;
+
+	for(slot = begin; slot < end; slot++)
+	{
+		world->shotTargets[slot] = NO_ENTITY;
+		if(pool->type[slot] != ENTITY_PLAYER_BULLET)
+			continue;
+
+		Level_Mask(world->level, pool->type[slot], pool->faceRight[slot] != 0, &mask);
+		world->shotTargets[slot] = Find_Swept_Contact(world,
+			Fixed_Join(pool->xCoordinate[slot], pool->xSubpixel[slot]),
+			Fixed_Join(pool->yCoordinate[slot], pool->ySubpixel[slot]), pool->width[slot],
+			pool->height[slot], &mask, pool->xSpeed[slot], pool->ySpeed[slot], TYPE_ENEMY);
+	}
+}
+
+void Score_Hits(SIMULATION* world)
+{
+	/**************************************************************************
+	*  PreCondition: Aim_Shots has run on every shot in flight
+	* PostCondition: Enemies hit by the player's bullets will be shot down
+	*   Description: The ordered half of scoring, which always plays out the
+	*                  same way however the aiming was split up
+	*     Algorithm: Walk the shots in flight from the back,
+	*                  Skip any that didn't touch a plane
+	*                  If a later bullet already brought its plane down,
+	*                    look again for another plane on its path
+	*                  Note where that plane is, then shoot it down and
+	*                    retire the bullet (the shot moved into its slot has
+	*                    already been scored)
+	**************************************************************************/
+	PROJECTILEPOOL* pool = &world->projectiles;
+	COLLISIONMASK mask;
+	int slot, target;
+
+	for(slot = pool->count - 1; slot >= 0; slot--)
+	{
+		target = world->shotTargets[slot];
+		if(target == NO_ENTITY)
+			continue;
+
+		//Check the plane is still there to hit
+		if(Entity_Flag(world->entities.destroyed, target))
+		{
+			Level_Mask(world->level, pool->type[slot], pool->faceRight[slot] != 0, &mask);
+			target = Find_Swept_Contact(world,
+				Fixed_Join(pool->xCoordinate[slot], pool->xSubpixel[slot]),
+				Fixed_Join(pool->yCoordinate[slot], pool->ySubpixel[slot]), pool->width[slot],
+				pool->height[slot], &mask, pool->xSpeed[slot], pool->ySpeed[slot], TYPE_ENEMY);
+		}
+		if(target != NO_ENTITY)
+		{
+			Note_Blast(world, target);
+			Destroy_Enemy(&world->entities, target);
+			Pool_Despawn_Slot(pool, slot);
+			world->kills++;
+			world->events |= SIM_EVENT_KILL;
+		}
+	}
+}
+
+static void Note_Blast(SIMULATION* world, int index)
+{
+	/**************************************************************************
+	*  PreCondition: The index refers to a plane still where it went down
+	* PostCondition: The middle of the plane will be reported as one of the
+	*                  tick's blasts, if there is room
+	*   Description: Lets effects such as explosions start where a plane went
+	*                  down, before Destroy_Enemy parks it off the playfield
+	*     Algorithm: Add half the plane's size to its corner and keep it
+	**************************************************************************/
+	const ENTITYSTORE* store = &world->entities;
+
+	if(world->blasts >= SIM_MAX_BLASTS)
+		return;
+
+	world->blastX[world->blasts] = (short)(store->xCoordinate[index] + store->width[index] / 2);
+	world->blastY[world->blasts] = (short)(store->yCoordinate[index] + store->height[index] / 2);
+	world->blasts++;
+}
+
+static void Move_And_Aim_Jobs(SIMULATION* world, JOBSYSTEM* jobs)
+{
+	/**************************************************************************
+	*  PreCondition: jobs is running and owned by the calling thread
+	* PostCondition: Everything will have moved and every shot been aimed,
+	*                  exactly as Move_Enemies, Move_Weaponry and Aim_Shots
+	*                  would have done
+	*   Description: Splits the heavy part of a tick across the job system
+	*     Algorithm: Run_Schedule() and Fire_Enemy_Weapons() first, they are
+	*                  order dependent
+	*                Find the middle of the player's jet once, for the jobs
+	*                  that chase it
+	*                Build the graph:
+	*                  planes move in chunks, shots steer and move in chunks,
+	*                  shots are culled once they have all moved,
+	*                  shots are aimed in chunks once planes have moved and
+	*                    shots have been culled (the aim job covers the whole
+	*                    pool, each chunk trims itself to the shots left)
+	*                Run it and wait for the aiming to finish
+	**************************************************************************/
+	PROFILE_SCOPE("Move_And_Aim_Jobs");
+	JOB *planes, *shots, *cull, *aim;
+	SIMMOVE move;
+
+	Run_Schedule(world);
+	Fire_Enemy_Weapons(world);
+
+	//the player's jet doesn't move again until the jobs are done
+	move.world = world;
+	Player_Middle(world, &move.targetX, &move.targetY);
+
+	planes = Job_Create(jobs, Move_Planes_Job, &move, 0, world->entities.count, SIM_PLANE_CHUNK);
+	shots = Job_Create(jobs, Move_Shots_Job, &move, 0, world->projectiles.count, SIM_SHOT_CHUNK);
+	cull = Job_Create(jobs, Cull_Shots_Job, world, 0, 0, 0);
+	aim = Job_Create(jobs, Aim_Shots_Job, world, 0, PROJECTILE_CAPACITY, SIM_AIM_CHUNK);
+
+	Job_Depends(cull, shots);
+	Job_Depends(aim, cull);
+	Job_Depends(aim, planes);
+
+	Job_Submit(jobs, aim);
+	Job_Submit(jobs, cull);
+	Job_Submit(jobs, planes);
+	Job_Submit(jobs, shots);
+	Job_Wait(jobs, aim);
+	Jobs_Reset(jobs);
+}
+
+static void Move_Planes_Job(void* data, int begin, int end)
+{
+	/**************************************************************************
+	*  PreCondition: Queued by Move_And_Aim_Jobs, data is its SIMMOVE
+	* PostCondition: Rows begin to end - 1 will be done
+	*   Description: Job body for moving planes
+	*     Algorithm: Move_Planes() on a chunk of the entity store
+	**************************************************************************/
+	PROFILE_SCOPE("Move_Planes");
+	const SIMMOVE* move = (const SIMMOVE*)data;
+
+	Move_Planes(move->world, begin, end, move->targetX, move->targetY);
+}
+
+static void Move_Shots_Job(void* data, int begin, int end)
+{
+	/**************************************************************************
+	*  PreCondition: Queued by Move_And_Aim_Jobs, data is its SIMMOVE
+	* PostCondition: Rows begin to end - 1 will be done
+	*   Description: Job body for moving shots
+	*     Algorithm: Pool_Steer() then Pool_Move() on a chunk of the live
+	*                  slots
+	**************************************************************************/
+	PROFILE_SCOPE("Move_Shots");
+	const SIMMOVE* move = (const SIMMOVE*)data;
+
+	Pool_Steer(&move->world->projectiles, move->targetX, move->targetY, begin, end);
+	Pool_Move(&move->world->projectiles, begin, end);
+}
+
+static void Cull_Shots_Job(void* data, int, int)
+{
+	/**************************************************************************
+	*  PreCondition: Queued by Move_And_Aim_Jobs, data is the world
+	* PostCondition: Shots that have left the playfield will be retired
+	*   Description: Job body for retiring shots
+	*     Algorithm: Pool_Cull() over the whole pool (it reorders slots, so it
+	*                  runs as one piece)
+	**************************************************************************/
+	PROFILE_SCOPE("Cull_Shots");
+
+	Pool_Cull(&((SIMULATION*)data)->projectiles, PLAYFIELD_WIDTH, PLAYFIELD_HEIGHT);
+}
+
+static void Aim_Shots_Job(void* data, int begin, int end)
+{
+	/**************************************************************************
+	*  PreCondition: Queued by Move_And_Aim_Jobs, data is the world
+	* PostCondition: Rows begin to end - 1 will be done
+	*   Description: Job body for aiming shots
+	*     Algorithm: Aim_Shots() on a chunk of the slots
+	**************************************************************************/
+	PROFILE_SCOPE("Aim_Shots");
+
+	Aim_Shots((SIMULATION*)data, begin, end);
+}
@@ -0,0 +1,149 @@
+/******************************************************************************
+*        Title: Aerobatica
+* Date Started: April 10th, 2009
+*    Developer: Liam Hagerty
+*       Module: Simulation Header
+*  Description: This module contains the renderer-free game world and the
+*                 fixed-timestep routines that advance it. Nothing in here
+*                 depends on Windows or Direct3D so the world can be stepped
+*                 headlessly
+*      Version: 1.0
+******************************************************************************/
+#ifndef _SIMULATION_H
+#define _SIMULATION_H 1
+
+#pragma region Include Files
+#include "Aerobatica_entities.h"    //Structure-of-arrays entity storage
+#include "Aerobatica_projectiles.h" //Pool of shots in flight
+#include "Aerobatica_collision.h"   //Box test
+#include "Aerobatica_jobs.h"        //Work-stealing job system
+#include "Aerobatica_level.h"       //Archetypes and waves
+#include "Aerobatica_schedule.h"    //Timeline of planes to spawn
+#pragma endregion
+
+#pragma region Constants
+#define PLAYFIELD_WIDTH 1000
+#define PLAYFIELD_HEIGHT 700
+#define SIM_TICK_MS 30 //Length of one simulation tick in milliseconds
+#define SIM_TICK_US (SIM_TICK_MS * 1000)
+#define SIM_MAX_CATCHUP_TICKS 5 //Most ticks run to make up for one slow frame
+
+//Input bits, one per control sampled for a tick
+#define INPUT_LEFT  0x01
+#define INPUT_RIGHT 0x02
+#define INPUT_UP    0x04
+#define INPUT_DOWN  0x08
+#define INPUT_FIRE  0x10
+
+#define PLAYER_FIRE_COOLDOWN 5 //Ticks between the player's shots
+
+//Event bits, what happened during a tick, for effects such as sound
+#define SIM_EVENT_PLAYER_SHOT 0x01
+#define SIM_EVENT_ENEMY_SHOT  0x02
+#define SIM_EVENT_MISSILE     0x04 //Either kind of missile launched
+#define SIM_EVENT_KILL        0x08
+#define SIM_EVENT_PLAYER_HIT  0x10
+#define SIM_MAX_BLASTS 32 //Planes a tick reports going down, any more go unreported
+
+//Splitting a tick across the job system
+#define SIM_JOBS_MIN_ROWS 512 //Planes plus shots before a tick is worth splitting
+#define SIM_PLANE_CHUNK 256   //Planes per movement chunk, a multiple of 64
+#define SIM_SHOT_CHUNK 256    //Shots per movement chunk
+#define SIM_AIM_CHUNK 32      //Shots per collision chunk
+#pragma endregion
+
+//Controls held during a tick
+typedef unsigned char SIM_INPUT;
+
+//Outcome of the round so far
+typedef enum
+{
+	SIM_PLAYING,
+	SIM_VICTORY,
+	SIM_DEFEAT
+} SIM_STATUS;
+
+//Game World Structure
+typedef struct
+{
+	ENTITYSTORE entities;       //Every plane in the world
+	PROJECTILEPOOL projectiles; //Every shot in flight
+	int playerJet;      //Entity the controls act on, always row 0
+	int fireCooldown;   //Ticks until the player can fire again
+	int accumulator;    //Microseconds banked toward the next tick
+	unsigned long tick; //Number of ticks simulated so far
+	unsigned long seed;        //Seed the round was started with
+	unsigned long randomState; //The world's own random number generator
+	SIM_STATUS status;
+	int shotTargets[PROJECTILE_CAPACITY]; //Plane each shot touches, found each tick
+	const LEVEL* level; //Level the round is played from
+	int wave;           //Next wave to send in
+	SPAWNSCHEDULE schedule; //Planes of the current wave still to come
+	unsigned long kills;    //Planes the player has shot down this round
+	unsigned events;        //SIM_EVENT bits raised during the latest tick
+	int blasts;             //Planes that went down during the latest tick
+	short blastX[SIM_MAX_BLASTS], blastY[SIM_MAX_BLASTS]; //Middle of each as it went down
+} SIMULATION;
+
+//World Snapshot Structure, the live part of a world packed end to end so
+//saving or restoring one costs a copy of what is in play, not of every slot
+typedef struct
+{
+	size_t size; //Bytes of data in use
+	unsigned char data[sizeof(SIMULATION)];
+} SIMSNAPSHOT;
+
+//Weapon Structure, what a kind of plane fires and how often
+typedef struct
+{
+	unsigned char projectile; //ENTITY_TYPE of its shots, ENTITY_TYPE_COUNT if it has no gun
+	unsigned char reload;     //Ticks between shots
+} WEAPON;
+
+//Size and speed of each kind of shot when it is fired facing right
+extern const SPRITE projectileTemplates[ENTITY_TYPE_COUNT];
+
+//The gun each kind of enemy plane carries
+extern const WEAPON enemyWeapons[ENTITY_TYPE_COUNT];
+
+#pragma region Function Prototypes
+void Sim_Init(SIMULATION*, unsigned long);
+void Sim_Restart(SIMULATION*, const SIMSNAPSHOT*, unsigned long);
+int Sim_Bank(SIMULATION*, int);
+int Sim_Step(SIMULATION*, SIM_INPUT, int);
+void Sim_Tick(SIMULATION*, SIM_INPUT);
+void Sim_Tick_Jobs(SIMULATION*, SIM_INPUT, JOBSYSTEM*);
+void Sim_Use_Jobs(JOBSYSTEM*);
+void Sim_Use_Level(const LEVEL*);
+unsigned long Sim_Random(SIMULATION*);
+unsigned long Sim_Hash(const SIMULATION*);
+void Sim_Save(const SIMULATION*, SIMSNAPSHOT*);
+void Sim_Restore(SIMULATION*, const SIMSNAPSHOT*);
+float Sim_Alpha(const SIMULATION*);
+void Set_Sprites_Properties(SIMULATION*);
+void Apply_Input(SIMULATION*, SIM_INPUT);
+int Fire_Projectile(SIMULATION*, ENTITY_TYPE, int, int, bool);
+int Check_Collision(const SIMULATION*, int, int);
+void Entity_Mask(const SIMULATION*, int, COLLISIONMASK*);
+int Find_Contact(const SIMULATION*, int, unsigned char);
+int Find_Box_Contact(const SIMULATION*, int, int, int, int, const COLLISIONMASK*, unsigned char);
+int Find_Swept_Contact(const SIMULATION*, FIXED, FIXED, int, int, const COLLISIONMASK*, FIXED, FIXED,
+					   unsigned char);
+bool Check_Victory(SIMULATION*);
+bool Check_Loss(SIMULATION*);
+void Destroy_Enemy(ENTITYSTORE*, int);
+void Move_Enemies(SIMULATION*);
+void Fire_Enemy_Weapons(SIMULATION*);
+void Player_Middle(const SIMULATION*, int*, int*);
+void Move_Weaponry(SIMULATION*);
+void Check_Scoring(SIMULATION*);
+void Run_Schedule(SIMULATION*);
+bool Send_In_Wave(SIMULATION*);
+bool Enemies_Remain(const SIMULATION*);
+void Retire_Planes(SIMULATION*);
+int Spawn_Plane(SIMULATION*, const LEVELSPAWN*);
+void Move_Planes(SIMULATION*, int, int, int, int);
+void Aim_Shots(SIMULATION*, int, int);
+void Score_Hits(SIMULATION*);
+#pragma endregion
+#endif
@@ -0,0 +1,60 @@
+/******************************************************************************
+*        Title: Aerobatica
+* Date Started: April 10th, 2009
+*    Developer: Liam Hagerty
+*       Module: Timer Code Module
+*  Description: This module contains the platform clock reads behind the
+*                 game loop's timer
+*      Version: 1.0
+******************************************************************************/
+#pragma region Includes
+#include "Aerobatica_timer.h" //Timer Definitions Header
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+#pragma endregion
+
+long long Timer_Microseconds()
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: The time on the monotonic clock will be returned in
+	*                  microseconds, from an arbitrary starting point
+	*   Description: Reads the high-resolution clock
+	*     Algorithm: Scale down the nanosecond reading
+	**************************************************************************/
+	return Timer_Nanoseconds() / 1000;
+}
+
+long long Timer_Nanoseconds()
+{
+	/**************************************************************************
+	*  PreCondition: None
+	* PostCondition: The time on the monotonic clock will be returned in
+	*                  nanoseconds, from an arbitrary starting point
+	*   Description: Reads the high-resolution clock at its finest
+	*     Algorithm: On Windows, scale the performance counter by its
+	*                  frequency (read once, it never changes)
+	*                Elsewhere, read the monotonic clock
+	**************************************************************************/
+#ifdef _WIN32
+	static LARGE_INTEGER frequency = { 0 };
+	LARGE_INTEGER counter;
+
+	if(frequency.QuadPart == 0)
+		QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&counter);
+
+	//split the division so the multiply can't overflow
+	return (counter.QuadPart / frequency.QuadPart) * 1000000000 +
+		(counter.QuadPart % frequency.QuadPart) * 1000000000 / frequency.QuadPart;
+#else
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (long long)now.tv_sec * 1000000000 + now.tv_nsec;
+#endif
+}
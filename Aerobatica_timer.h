@@ -0,0 +1,19 @@
+/******************************************************************************
+*        Title: Aerobatica
+* Date Started: April 10th, 2009
+*    Developer: Liam Hagerty
+*       Module: Timer Header
+*  Description: This module contains the high-resolution monotonic clock the
+*                 game loop is paced by. It uses the performance counter on
+*                 Windows and the monotonic POSIX clock elsewhere, so it never
+*                 jumps backwards and is far finer than GetTickCount's steps
+*      Version: 1.0
+******************************************************************************/
+#ifndef _TIMER_H
+#define _TIMER_H 1
+
+#pragma region Function Prototypes
+long long Timer_Microseconds();
+long long Timer_Nanoseconds();
+#pragma endregion
+#endif
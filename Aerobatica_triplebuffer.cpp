@@ -0,0 +1,95 @@
+/******************************************************************************
+*        Title: Aerobatica
+* Date Started: April 10th, 2009
+*    Developer: Liam Hagerty
+*       Module: Triple Buffer Code Module
+*  Description: This module contains the single-producer, single-consumer
+*                 triple buffer routines
+*      Version: 1.0
+******************************************************************************/
+#pragma region Includes
+#include "Aerobatica_triplebuffer.h" //Triple Buffer Definitions Header
+#pragma endregion
+
+void Triple_Init(TRIPLEBUFFER* buffer, void* storage, size_t slotSize)
+{
+	/**************************************************************************
+	*  PreCondition: storage holds three slots, neither thread is using the
+	*                  buffer yet
+	* PostCondition: Each thread will have a slot of its own and nothing will
+	*                  have been published
+	*   Description: Sets up a triple buffer over the caller's storage
+	*     Algorithm: Give slot 0 to the producer, 1 to the middle and 2 to
+	*                  the consumer
+	*                Keep the storage
+	**************************************************************************/
+	buffer->back = 0;
+	buffer->middle.store(1, std::memory_order_relaxed);
+	buffer->front = 2;
+	buffer->slotSize = slotSize;
+	buffer->storage = (unsigned char*)storage;
+}
+
+void* Triple_Back(TRIPLEBUFFER* buffer)
+{
+	/**************************************************************************
+	*  PreCondition: Only the producer thread calls this
+	* PostCondition: The slot to fill next will be returned, its contents are
+	*                  whatever was published a couple of times ago
+	*   Description: Producer's slot
+	*     Algorithm: Index the storage by the back slot
+	**************************************************************************/
+	return buffer->storage + buffer->back * buffer->slotSize;
+}
+
+void Triple_Publish(TRIPLEBUFFER* buffer)
+{
+	/**************************************************************************
+	*  PreCondition: Only the producer thread calls this, the back slot has
+	*                  been filled
+	* PostCondition: The back slot will be the latest copy, and the producer
+	*                  will have a different slot to fill next
+	*   Description: Producer end
+	*     Algorithm: Swap the back slot into the middle, marked fresh
+	*                  (release, so the filling is visible before the swap)
+	*                Take whatever was in the middle as the new back slot
+	**************************************************************************/
+	unsigned previous = buffer->middle.exchange(buffer->back | TRIPLE_FRESH, std::memory_order_acq_rel);
+
+	buffer->back = previous & ~TRIPLE_FRESH;
+}
+
+bool Triple_Update(TRIPLEBUFFER* buffer)
+{
+	/**************************************************************************
+	*  PreCondition: Only the consumer thread calls this
+	* PostCondition: The front slot will be the latest copy published,
+	*                  returns false if nothing new had been
+	*   Description: Consumer end
+	*     Algorithm: If the middle slot isn't fresh, keep the front slot
+	*                Otherwise swap the front slot into the middle (acquire,
+	*                  so the producer's filling is visible) and take the
+	*                  fresh one
+	**************************************************************************/
+	unsigned previous;
+
+	if(!(buffer->middle.load(std::memory_order_relaxed) & TRIPLE_FRESH))
+		return false;
+
+	previous = buffer->middle.exchange(buffer->front, std::memory_order_acq_rel);
+	buffer->front = previous & ~TRIPLE_FRESH;
+
+	return true;
+}
+
+const void* Triple_Front(const TRIPLEBUFFER* buffer)
+{
+	/**************************************************************************
+	*  PreCondition: Only the consumer thread calls this
+	* PostCondition: The slot being read will be returned, it stays
+	*                  unchanged until the next Triple_Update
+	*   Description: Consumer's slot
+	*     Algorithm: Index the storage by the front slot
+	**************************************************************************/
+	return buffer->storage + buffer->front * buffer->slotSize;
+}
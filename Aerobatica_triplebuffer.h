@@ -0,0 +1,48 @@
+/******************************************************************************
+*        Title: Aerobatica
+* Date Started: April 10th, 2009
+*    Developer: Liam Hagerty
+*       Module: Triple Buffer Header
+*  Description: This module contains the lock-free triple buffer that hands
+*                 the latest copy of something from one producer thread to
+*                 one consumer thread. The producer fills its back slot and
+*                 publishes it, the consumer picks up whatever was published
+*                 last. Neither side ever waits on the other or sees a slot
+*                 the other is still using, and copies the consumer was too
+*                 slow to see are simply replaced
+*      Version: 1.0
+******************************************************************************/
+#ifndef _TRIPLEBUFFER_H
+#define _TRIPLEBUFFER_H 1
+
+#pragma region Include Files
+#include <stddef.h>
+#include <atomic>
+#pragma endregion
+
+#pragma region Constants
+#define TRIPLE_CACHE_LINE 64 //Keeps each thread's slot from sharing a cache line
+#define TRIPLE_FRESH 4       //Set on the middle slot when it hasn't been picked up
+#pragma endregion
+
+//Triple Buffer Structure
+typedef struct
+{
+	std::atomic<unsigned> middle; //Slot between the threads, plus TRIPLE_FRESH
+	char middlePadding[TRIPLE_CACHE_LINE - sizeof(std::atomic<unsigned>)];
+	unsigned back;  //Slot being filled, only the producer uses it
+	char backPadding[TRIPLE_CACHE_LINE - sizeof(unsigned)];
+	unsigned front; //Slot being read, only the consumer uses it
+	char frontPadding[TRIPLE_CACHE_LINE - sizeof(unsigned)];
+	size_t slotSize;
+	unsigned char* storage;
+} TRIPLEBUFFER;
+
+#pragma region Function Prototypes
+void Triple_Init(TRIPLEBUFFER*, void*, size_t);
+void* Triple_Back(TRIPLEBUFFER*);
+void Triple_Publish(TRIPLEBUFFER*);
+bool Triple_Update(TRIPLEBUFFER*);
+const void* Triple_Front(const TRIPLEBUFFER*);
+#pragma endregion
+#endif